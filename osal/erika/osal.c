@@ -101,3 +101,28 @@ void osal_free(void *ptr)
    	free(ptr);
 }
 
+boolean osal_atomic_cas(volatile int32 *ptr, int32 expected, int32 desired)
+{
+   return __sync_bool_compare_and_swap(ptr, expected, desired) ? TRUE : FALSE;
+}
+
+/* No mutex available, callers fall back to their single thread mode */
+void *osal_mutex_create(void)
+{
+   return NULL;
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   (void)mutex;
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   (void)mutex;
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   (void)mutex;
+}
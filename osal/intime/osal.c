@@ -6,6 +6,9 @@
 #include <rt.h>
 #include <sys/time.h>
 #include <osal.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 static int64_t sysfrequency;
 static double qpc2usec;
@@ -86,3 +89,41 @@ osal_mutex_t * osal_mtx_create(void)
         /* return (void*)RtCreateMutex(NULL, FALSE, NULL); */
         return (void *)0;
 }
+
+boolean osal_atomic_cas(volatile int32 *ptr, int32 expected, int32 desired)
+{
+#ifdef _MSC_VER
+   return (_InterlockedCompareExchange((volatile long *)ptr, desired, expected) == expected) ? TRUE : FALSE;
+#else
+   return __sync_bool_compare_and_swap(ptr, expected, desired) ? TRUE : FALSE;
+#endif
+}
+
+/* Mutex is a binary semaphore with priority queuing, the handle is the
+ * mutex pointer, BAD_RTHANDLE is 0 */
+void *osal_mutex_create(void)
+{
+   RTHANDLE sem;
+
+   sem = CreateRtSemaphore(1, 1, PRIORITY_QUEUING);
+   if (sem == BAD_RTHANDLE)
+   {
+      return NULL;
+   }
+   return (void *)(size_t)sem;
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   DeleteRtSemaphore((RTHANDLE)(size_t)mutex);
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   WaitForRtSemaphore((RTHANDLE)(size_t)mutex, 1, WAIT_FOREVER);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   ReleaseRtSemaphore((RTHANDLE)(size_t)mutex, 1);
+}
@@ -142,3 +142,52 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
 
    return 1;
 }
+
+int osal_thread_join(void *thandle)
+{
+   pthread_t            *threadp;
+
+   threadp = thandle;
+   if(pthread_join(*threadp, NULL) != 0)
+   {
+      return 0;
+   }
+   return 1;
+}
+
+boolean osal_atomic_cas(volatile int32 *ptr, int32 expected, int32 desired)
+{
+   return __sync_bool_compare_and_swap(ptr, expected, desired) ? TRUE : FALSE;
+}
+
+void *osal_mutex_create(void)
+{
+   pthread_mutexattr_t mutexattr;
+   pthread_mutex_t *mutex;
+
+   mutex = malloc(sizeof(pthread_mutex_t));
+   if (mutex)
+   {
+      pthread_mutexattr_init(&mutexattr);
+      pthread_mutexattr_setprotocol(&mutexattr, PTHREAD_PRIO_INHERIT);
+      pthread_mutex_init(mutex, &mutexattr);
+      pthread_mutexattr_destroy(&mutexattr);
+   }
+   return mutex;
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   pthread_mutex_destroy(mutex);
+   free(mutex);
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   pthread_mutex_lock(mutex);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   pthread_mutex_unlock(mutex);
+}
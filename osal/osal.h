@@ -51,6 +51,15 @@ ec_timet osal_current_time(void);
 void osal_time_diff(ec_timet *start, ec_timet *end, ec_timet *diff);
 int osal_thread_create(void *thandle, int stacksize, void *func, void *param);
 int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param);
+/* wait until thread has ended, 0 if the port cannot join threads */
+int osal_thread_join(void *thandle);
+/* mutex with priority inheritance where available, NULL if it cannot be created */
+void *osal_mutex_create(void);
+void osal_mutex_destroy(void *mutex);
+void osal_mutex_lock(void *mutex);
+void osal_mutex_unlock(void *mutex);
+/* atomic compare and swap with full memory barrier, TRUE if *ptr was expected and is now desired */
+boolean osal_atomic_cas(volatile int32 *ptr, int32 expected, int32 desired);
 
 #ifdef __cplusplus
 }
@@ -143,3 +143,35 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
    }
    return 1;
 }
+
+int osal_thread_join(void *thandle)
+{
+   /* task handle is not kept by osal_thread_create */
+   (void)thandle;
+   return 0;
+}
+
+boolean osal_atomic_cas(volatile int32 *ptr, int32 expected, int32 desired)
+{
+   return __sync_bool_compare_and_swap(ptr, expected, desired) ? TRUE : FALSE;
+}
+
+void *osal_mutex_create(void)
+{
+   return (void *)mtx_create();
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   mtx_destroy((mtx_t *)mutex);
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   mtx_lock((mtx_t *)mutex);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   mtx_unlock((mtx_t *)mutex);
+}
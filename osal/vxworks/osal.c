@@ -12,6 +12,7 @@
 #include <osal.h>
 #include <vxWorks.h>
 #include <taskLib.h>
+#include <semLib.h>
 
 
 #define  timercmp(a, b, CMP)                                \
@@ -185,3 +186,39 @@ int osal_thread_create_rt(void *thandle, int stacksize, void *func, void *param)
    return 1;
 }
 
+int osal_thread_join(void *thandle)
+{
+   TASK_ID * tid = (TASK_ID *)thandle;
+
+   /* task ID becomes invalid when the task has exited */
+   while(taskIdVerify(*tid) == OK)
+   {
+      taskDelay(1);
+   }
+   return 1;
+}
+
+boolean osal_atomic_cas(volatile int32 *ptr, int32 expected, int32 desired)
+{
+   return __sync_bool_compare_and_swap(ptr, expected, desired) ? TRUE : FALSE;
+}
+
+void *osal_mutex_create(void)
+{
+   return (void *)semMCreate(SEM_Q_PRIORITY | SEM_INVERSION_SAFE);
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   semDelete((SEM_ID)mutex);
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   semTake((SEM_ID)mutex, WAIT_FOREVER);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   semGive((SEM_ID)mutex);
+}
@@ -150,3 +150,41 @@ int osal_thread_create_rt(void **thandle, int stacksize, void *func, void *param
    }
    return ret;
 }
+
+int osal_thread_join(void *thandle)
+{
+   HANDLE *threadp;
+
+   threadp = thandle;
+   if(WaitForSingleObject(*threadp, INFINITE) != WAIT_OBJECT_0)
+   {
+      return 0;
+   }
+   CloseHandle(*threadp);
+   return 1;
+}
+
+boolean osal_atomic_cas(volatile int32 *ptr, int32 expected, int32 desired)
+{
+   return (InterlockedCompareExchange((volatile LONG *)ptr, desired, expected) == expected) ? TRUE : FALSE;
+}
+
+void *osal_mutex_create(void)
+{
+   return (void *)CreateMutex(NULL, FALSE, NULL);
+}
+
+void osal_mutex_destroy(void *mutex)
+{
+   CloseHandle((HANDLE)mutex);
+}
+
+void osal_mutex_lock(void *mutex)
+{
+   WaitForSingleObject((HANDLE)mutex, INFINITE);
+}
+
+void osal_mutex_unlock(void *mutex)
+{
+   ReleaseMutex((HANDLE)mutex);
+}
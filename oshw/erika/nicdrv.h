@@ -83,6 +83,12 @@ typedef struct
 	int dev_id;
 
 	// TODO: add mutex support
+	/** frames sent by ecx_srconfirm, including resends */
+	uint32 txcnt;
+	/** frames resent by ecx_srconfirm after missing response */
+	uint32 retrycnt;
+	/** datagrams set up in frames */
+	uint32 dgramcnt;
 } ecx_portt;
 
 extern const uint16 priMAC[3];
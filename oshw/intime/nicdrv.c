@@ -689,6 +689,8 @@ int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
    osal_timer_start (&timer1, timeout);
    /* tx frame on primary and if in redundant mode a dummy on secondary */
    ecx_outframe_red(port, idx);
+   /* count frames for statistics */
+   port->txcnt++;
    wkc = ecx_waitinframe_red(port, idx, &timer1);
 
    return wkc;
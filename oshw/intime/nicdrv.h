@@ -86,6 +86,12 @@ typedef struct
    HPEHANDLE      handle;
    HPERXBUFFERSET *rx_buffers;
    HPETXBUFFERSET *tx_buffers[EC_MAXBUF];
+   /** frames sent by ecx_srconfirm, including resends */
+   uint32 txcnt;
+   /** frames resent by ecx_srconfirm after missing response */
+   uint32 retrycnt;
+   /** datagrams set up in frames */
+   uint32 dgramcnt;
 } ecx_portt;
 
 extern const uint16 priMAC[3];
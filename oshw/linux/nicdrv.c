@@ -573,6 +573,7 @@ int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc = EC_NOFRAME;
+   int retry = 0;
    osal_timert timer1, timer2;
 
    osal_timer_start (&timer1, timeout);
@@ -580,6 +581,12 @@ int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
    {
       /* tx frame on primary and if in redundant mode a dummy on secondary */
       ecx_outframe_red(port, idx);
+      /* count frames and resends for statistics */
+      port->txcnt++;
+      if (retry++)
+      {
+         port->retrycnt++;
+      }
       if (timeout < EC_TIMEOUTRET)
       {
          osal_timer_start (&timer2, timeout);
@@ -7,10 +7,15 @@
 #include <net/if.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <linux/if_tun.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "oshw.h"
+#include "ethercateoe.h"
 
 /**
  * Host to Network byte order (i.e. to big endian).
@@ -115,3 +120,98 @@ void oshw_free_adapters(ec_adaptert * adapter)
       }
    }
 }
+
+/** Open a TAP device, f.e. as host side of an EoE switch port.
+ * @param[in] ifname = name of TAP device, f.e. "tap0", created if it does
+ * not exist and the process has CAP_NET_ADMIN
+ * @return file descriptor of TAP device, non blocking, -1 on error
+ */
+int oshw_tap_open(const char *ifname)
+{
+   struct ifreq ifr;
+   int fd;
+
+   fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+   if (fd < 0)
+   {
+      return -1;
+   }
+   memset(&ifr, 0x00, sizeof(ifr));
+   /* raw Ethernet frames without packet info header */
+   ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+   strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+   if (ioctl(fd, TUNSETIFF, (void *)&ifr) < 0)
+   {
+      close(fd);
+      return -1;
+   }
+   return fd;
+}
+
+/** Read one Ethernet frame from a TAP device, does not block.
+ * @param[in] fd = file descriptor of TAP device
+ * @param[out] frame = frame buffer
+ * @param[in] size = size of frame buffer
+ * @return size of frame, 0 if no frame is waiting, -1 on error
+ */
+int oshw_tap_read(int fd, void *frame, int size)
+{
+   ssize_t n;
+
+   n = read(fd, frame, size);
+   if (n < 0)
+   {
+      return ((errno == EAGAIN) || (errno == EWOULDBLOCK)) ? 0 : -1;
+   }
+   return (int)n;
+}
+
+/** Write one Ethernet frame to a TAP device.
+ * @param[in] fd = file descriptor of TAP device
+ * @param[in] frame = frame buffer
+ * @param[in] size = size of frame
+ * @return size written, -1 on error
+ */
+int oshw_tap_write(int fd, const void *frame, int size)
+{
+   return (int)write(fd, frame, size);
+}
+
+/** Close a TAP device.
+ * @param[in] fd = file descriptor of TAP device
+ */
+void oshw_tap_close(int fd)
+{
+   close(fd);
+}
+
+/** EoE switch host read callback for ports bridged to a TAP device, the
+ * port hosthandle is the file descriptor from oshw_tap_open().
+ * Use with ecx_EOEswitch_init().
+ * @param[in] context = context struct
+ * @param[in] port = EoE switch port
+ * @param[out] frame = frame buffer
+ * @param[in] size = size of frame buffer
+ * @return size of frame, 0 if no frame is waiting or on error
+ */
+int oshw_tap_hostread(ecx_contextt *context, struct ec_EOEport *port, uint8 *frame, int size)
+{
+   int n;
+
+   (void)context;
+   n = oshw_tap_read(port->hosthandle, frame, size);
+   return (n > 0) ? n : 0;
+}
+
+/** EoE switch host write callback for ports bridged to a TAP device.
+ * Use with ecx_EOEswitch_init().
+ * @param[in] context = context struct
+ * @param[in] port = EoE switch port
+ * @param[in] frame = frame received from slave
+ * @param[in] size = size of frame
+ */
+void oshw_tap_hostwrite(ecx_contextt *context, struct ec_EOEport *port, const uint8 *frame, int size)
+{
+   (void)context;
+   (void)oshw_tap_write(port->hosthandle, frame, size);
+}
@@ -19,10 +19,19 @@ extern "C" {
 #include "nicdrv.h"
 #include "ethercatmain.h"
 
+/* EoE switch port, see ethercateoe.h */
+struct ec_EOEport;
+
 uint16 oshw_htons(uint16 hostshort);
 uint16 oshw_ntohs(uint16 networkshort);
 ec_adaptert * oshw_find_adapters(void);
 void oshw_free_adapters(ec_adaptert * adapter);
+int oshw_tap_open(const char *ifname);
+int oshw_tap_read(int fd, void *frame, int size);
+int oshw_tap_write(int fd, const void *frame, int size);
+void oshw_tap_close(int fd);
+int oshw_tap_hostread(ecx_contextt *context, struct ec_EOEport *port, uint8 *frame, int size);
+void oshw_tap_hostwrite(ecx_contextt *context, struct ec_EOEport *port, const uint8 *frame, int size);
 
 #ifdef __cplusplus
 }
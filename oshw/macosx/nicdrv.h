@@ -84,6 +84,12 @@ typedef struct
    pthread_mutex_t getindex_mutex;
    pthread_mutex_t tx_mutex;
    pthread_mutex_t rx_mutex;
+   /** frames sent by ecx_srconfirm, including resends */
+   uint32 txcnt;
+   /** frames resent by ecx_srconfirm after missing response */
+   uint32 retrycnt;
+   /** datagrams set up in frames */
+   uint32 dgramcnt;
 } ecx_portt;
 
 extern const uint16 priMAC[3];
@@ -560,6 +560,7 @@ int ecx_waitinframe(ecx_portt *port, uint8 idx, int timeout)
 int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
 {
    int wkc = EC_NOFRAME;
+   int retry = 0;
    osal_timert timer;
 
    osal_timer_start(&timer, timeout);
@@ -569,6 +570,12 @@ int ecx_srconfirm(ecx_portt *port, uint8 idx, int timeout)
 
       /* tx frame on primary and if in redundant mode a dummy on secondary */
       ecx_outframe_red(port, idx);
+      /* count frames and resends for statistics */
+      port->txcnt++;
+      if (retry++)
+      {
+         port->retrycnt++;
+      }
       osal_timer_start(&read_timer, MIN(timeout, EC_TIMEOUTRET));
       /* get frame from primary or if in redundant mode possibly from secondary */
       wkc = ecx_waitinframe_red(port, idx, read_timer);
@@ -77,6 +77,12 @@ typedef struct
    mtx_t * getindex_mutex;
    mtx_t * tx_mutex;
    mtx_t * rx_mutex;
+   /** frames sent by ecx_srconfirm, including resends */
+   uint32 txcnt;
+   /** frames resent by ecx_srconfirm after missing response */
+   uint32 retrycnt;
+   /** datagrams set up in frames */
+   uint32 dgramcnt;
 } ecx_portt;
 
 extern const uint16 priMAC[3];
@@ -94,6 +94,12 @@ typedef struct ecx_port
    SEM_ID  sem_get_index;
    /** MSG Q for receive callbacks to post into */
    MSG_Q_ID  msgQId[EC_MAXBUF];
+   /** frames sent by ecx_srconfirm, including resends */
+   uint32 txcnt;
+   /** frames resent by ecx_srconfirm after missing response */
+   uint32 retrycnt;
+   /** datagrams set up in frames */
+   uint32 dgramcnt;
 } ecx_portt;
 
 extern const uint16 priMAC[3];
@@ -87,6 +87,12 @@ typedef struct
    CRITICAL_SECTION getindex_mutex;
    CRITICAL_SECTION tx_mutex;
    CRITICAL_SECTION rx_mutex;
+   /** frames sent by ecx_srconfirm, including resends */
+   uint32 txcnt;
+   /** frames resent by ecx_srconfirm after missing response */
+   uint32 retrycnt;
+   /** datagrams set up in frames */
+   uint32 dgramcnt;
 } ecx_portt;
 
 extern const uint16 priMAC[3];
@@ -15,12 +15,15 @@
 #include "nicdrv.h"
 #include "ethercatbase.h"
 #include "ethercatmain.h"
+#include "ethercatmbx.h"
 #include "ethercatdc.h"
 #include "ethercatcoe.h"
 #include "ethercatfoe.h"
 #include "ethercatsoe.h"
+#include "ethercataoe.h"
 #include "ethercateoe.h"
 #include "ethercatconfig.h"
+#include "ethercatprofile.h"
 #include "ethercatprint.h"
 
 #endif /* _EC_ETHERCAT_H */
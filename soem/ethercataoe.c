@@ -0,0 +1,628 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * ADS over EtherCAT (AoE) Module.
+ *
+ * ADS read, write and read write services. Requests are matched to their
+ * responses by invoke ID, so ecx_AoEbatch() can keep several requests per
+ * slave outstanding.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatmbx.h"
+#include "ethercataoe.h"
+
+/** AoE (ADS over EtherCAT) mailbox structure, AMS header */
+PACKED_BEGIN
+typedef struct PACKED
+{
+   ec_mbxheadert MbxHeader;
+   uint8         targetnetid[6];
+   uint16        targetport;
+   uint8         sourcenetid[6];
+   uint16        sourceport;
+   uint16        commandid;
+   uint16        stateflags;
+   uint32        length;
+   uint32        errorcode;
+   uint32        invokeid;
+} ec_AoEt;
+PACKED_END
+
+/* Next AoE invoke ID of slave, 0 is not used. Requests of several
+ * threads to the same slave get unique IDs.
+ */
+static uint32 ecx_AoEnextid(ecx_contextt *context, uint16 slave)
+{
+   volatile int32 *last;
+   int32 id, next;
+
+   last = &(context->slavelist[slave].AoEinvokeid);
+   do
+   {
+      id = *last;
+      next = (int32)((uint32)id + 1);
+      if (next == 0)
+      {
+         next = 1;
+      }
+   } while (!osal_atomic_cas(last, id, next));
+
+   return (uint32)next;
+}
+
+/** Report AoE error.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  Slave      = Slave number
+ * @param[in]  indexgroup = ADS index group of request
+ * @param[in]  Error      = AMS error code or ADS result
+ */
+void ecx_AoEerror(ecx_contextt *context, uint16 Slave, uint32 indexgroup, uint32 Error)
+{
+   ec_errort Ec;
+
+   memset(&Ec, 0, sizeof(Ec));
+   Ec.Time = osal_current_time();
+   Ec.Slave = Slave;
+   Ec.Index = (uint16)indexgroup;
+   Ec.SubIdx = 0;
+   *(context->ecaterror) = TRUE;
+   Ec.Etype = EC_ERR_TYPE_AOE_ERROR;
+   Ec.AbortCode = (int32)Error;
+   ecx_pusherror(context, &Ec);
+}
+
+/* Build request of req in req->txmbx with a new invoke ID.
+ * Returns FALSE if the request does not fit in the mailbox.
+ */
+static boolean ecx_AoEframe(ecx_contextt *context, ec_AoErequestt *req)
+{
+   ec_AoEt *AoEp;
+   uint8 *ads;
+   int adslen, wsize, maxdata, pos;
+   uint8 cnt;
+
+   wsize = (req->command == EC_AOE_CMD_READ) ? 0 : req->wsize;
+   switch (req->command)
+   {
+      case EC_AOE_CMD_READ:
+         adslen = 12;
+         break;
+      case EC_AOE_CMD_WRITE:
+         adslen = 12 + wsize;
+         break;
+      case EC_AOE_CMD_READWRITE:
+         adslen = 16 + wsize;
+         break;
+      default:
+         return FALSE;
+   }
+   maxdata = context->slavelist[req->slave].mbx_l - (int)sizeof(ec_AoEt);
+   if ((wsize < 0) || (adslen > maxdata))
+   {
+      return FALSE;
+   }
+   ec_clearmbx(&(req->txmbx));
+   AoEp = (ec_AoEt *)&(req->txmbx);
+   ads = (uint8 *)&(req->txmbx) + sizeof(ec_AoEt);
+   AoEp->MbxHeader.length = htoes((uint16)(sizeof(ec_AoEt) - sizeof(ec_mbxheadert) + adslen));
+   AoEp->MbxHeader.address = htoes(0x0000);
+   AoEp->MbxHeader.priority = 0x00;
+   /* get new mailbox count value, used as session handle */
+   cnt = ec_nextmbxcnt(context->slavelist[req->slave].mbx_cnt);
+   context->slavelist[req->slave].mbx_cnt = cnt;
+   AoEp->MbxHeader.mbxtype = ECT_MBXT_AOE + MBX_HDR_SET_CNT(cnt); /* AoE */
+   memcpy(AoEp->targetnetid, req->target.netid, sizeof(AoEp->targetnetid));
+   AoEp->targetport = htoes(req->target.port);
+   memcpy(AoEp->sourcenetid, req->source.netid, sizeof(AoEp->sourcenetid));
+   AoEp->sourceport = htoes(req->source.port);
+   AoEp->commandid = htoes(req->command);
+   AoEp->stateflags = htoes(EC_AOE_STATE_REQ);
+   AoEp->length = htoel((uint32)adslen);
+   AoEp->errorcode = htoel(0);
+   req->invokeid = ecx_AoEnextid(context, req->slave);
+   AoEp->invokeid = htoel(req->invokeid);
+   pos = 0;
+   ec_image_put(ads, adslen, &pos, 4, req->indexgroup);
+   ec_image_put(ads, adslen, &pos, 4, req->indexoffset);
+   if (req->command == EC_AOE_CMD_WRITE)
+   {
+      ec_image_put(ads, adslen, &pos, 4, (uint32)wsize);
+   }
+   else
+   {
+      ec_image_put(ads, adslen, &pos, 4, (uint32)req->rsize);
+      if (req->command == EC_AOE_CMD_READWRITE)
+      {
+         ec_image_put(ads, adslen, &pos, 4, (uint32)wsize);
+      }
+   }
+   if (wsize > 0)
+   {
+      memcpy(&ads[pos], req->wdata, wsize);
+   }
+
+   return TRUE;
+}
+
+/* Invoke ID of AoE response in mailbox, 0 if mailbox is not an AoE response */
+static uint32 ecx_AoEresponseid(ec_mbxbuft *mbx)
+{
+   ec_AoEt *aAoEp;
+
+   aAoEp = (ec_AoEt *)mbx;
+   if (((aAoEp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_AOE) ||
+       !(etohs(aAoEp->stateflags) & EC_AOE_STATE_RES))
+   {
+      return 0;
+   }
+   return etohl(aAoEp->invokeid);
+}
+
+/* Evaluate response of req in mbx, returns wkc of request */
+static int ecx_AoEresponse(ecx_contextt *context, ec_AoErequestt *req, ec_mbxbuft *mbx, int wkc)
+{
+   ec_AoEt *aAoEp;
+   uint8 *ads;
+   int adslen, rlen, pos;
+   uint32 val;
+
+   aAoEp = (ec_AoEt *)mbx;
+   ads = (uint8 *)mbx + sizeof(ec_AoEt);
+   adslen = etohs(aAoEp->MbxHeader.length) - (int)(sizeof(ec_AoEt) - sizeof(ec_mbxheadert));
+   if (etohs(aAoEp->commandid) != req->command)
+   {
+      ecx_packeterror(context, req->slave, (uint16)req->indexgroup, 0, 1); /* Unexpected frame returned */
+      return 0;
+   }
+   req->result = etohl(aAoEp->errorcode);
+   if (!req->result)
+   {
+      /* every ADS response starts with the ADS result */
+      pos = 0;
+      req->result = ec_image_get(ads, adslen, &pos, 4, &val) ? val : 0xffffffff;
+   }
+   if (req->result)
+   {
+      ecx_AoEerror(context, req->slave, req->indexgroup, req->result);
+      return 0;
+   }
+   if (req->command == EC_AOE_CMD_WRITE)
+   {
+      return wkc;
+   }
+   pos = 4;
+   rlen = ec_image_get(ads, adslen, &pos, 4, &val) ? (int)val : -1;
+   if ((rlen < 0) || (rlen > (adslen - 8)))
+   {
+      ecx_packeterror(context, req->slave, (uint16)req->indexgroup, 0, 1); /* Unexpected frame returned */
+      return 0;
+   }
+   if (rlen > req->rsize)
+   {
+      ecx_packeterror(context, req->slave, (uint16)req->indexgroup, 0, 3); /* data container too small for type */
+      return 0;
+   }
+   memcpy(req->rdata, &ads[8], rlen);
+   req->rsize = rlen;
+
+   return wkc;
+}
+
+/** AoE request, blocking.
+ *
+ * Sends one ADS request to the slave and waits for the response with the
+ * same invoke ID. AoE responses with another invoke ID are discarded.
+ *
+ * @param[in]     context  = context struct
+ * @param[in,out] req      = request, slave, addresses, command, index group,
+ *                           index offset and data must be set. rsize and
+ *                           result are returned.
+ * @param[in]     timeout  = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response, 0 on ADS error or unexpected response
+ */
+int ecx_AoErequest(ecx_contextt *context, ec_AoErequestt *req, int timeout)
+{
+   int wkc;
+
+   req->result = 0;
+   if (!ecx_AoEframe(context, req))
+   {
+      req->wkc = EC_ERROR;
+      return EC_ERROR;
+   }
+   ec_clearmbx(&(req->rxmbx));
+   /* Empty slave out mailbox if something is in. Timeout set to 0 */
+   wkc = ecx_mbxreceive(context, req->slave, &(req->rxmbx), 0);
+   /* send AoE request to slave */
+   wkc = ecx_mbxsend(context, req->slave, &(req->txmbx), EC_TIMEOUTTXM);
+   if (wkc > 0) /* succeeded to place mailbox in slave ? */
+   {
+      do
+      {
+         /* clean mailboxbuffer */
+         ec_clearmbx(&(req->rxmbx));
+         /* read slave response */
+         wkc = ecx_mbxreceive(context, req->slave, &(req->rxmbx), timeout);
+      } while ((wkc > 0) && (ecx_AoEresponseid(&(req->rxmbx)) != req->invokeid));
+      if (wkc > 0) /* succeeded to read slave response ? */
+      {
+         wkc = ecx_AoEresponse(context, req, &(req->rxmbx), wkc);
+      }
+      else
+      {
+         ecx_packeterror(context, req->slave, (uint16)req->indexgroup, 0, 4); /* no response */
+      }
+   }
+   req->wkc = wkc;
+
+   return wkc;
+}
+
+/** AoE read, blocking.
+ *
+ * @param[in]  context     = context struct
+ * @param[in]  slave       = Slave number
+ * @param[in]  target      = AMS address of target in slave
+ * @param[in]  source      = AMS address of master
+ * @param[in]  indexgroup  = ADS index group
+ * @param[in]  indexoffset = ADS index offset
+ * @param[in,out] psize    = Size in bytes of buffer, returns bytes read
+ * @param[out] p           = Pointer to buffer
+ * @param[in]  timeout     = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ */
+int ecx_AoEread(ecx_contextt *context, uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                uint32 indexgroup, uint32 indexoffset, int *psize, void *p, int timeout)
+{
+   return ecx_AoEreadwrite(context, slave, target, source, indexgroup, indexoffset,
+                           -1, NULL, psize, p, timeout);
+}
+
+/** AoE write, blocking.
+ *
+ * @param[in]  context     = context struct
+ * @param[in]  slave       = Slave number
+ * @param[in]  target      = AMS address of target in slave
+ * @param[in]  source      = AMS address of master
+ * @param[in]  indexgroup  = ADS index group
+ * @param[in]  indexoffset = ADS index offset
+ * @param[in]  psize       = Size in bytes of data
+ * @param[in]  p           = Pointer to data
+ * @param[in]  timeout     = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ */
+int ecx_AoEwrite(ecx_contextt *context, uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                 uint32 indexgroup, uint32 indexoffset, int psize, const void *p, int timeout)
+{
+   return ecx_AoEreadwrite(context, slave, target, source, indexgroup, indexoffset,
+                           psize, p, NULL, NULL, timeout);
+}
+
+/** AoE read write, blocking. Without read buffer an ADS write is done,
+ * with wsize < 0 an ADS read.
+ *
+ * @param[in]  context     = context struct
+ * @param[in]  slave       = Slave number
+ * @param[in]  target      = AMS address of target in slave
+ * @param[in]  source      = AMS address of master
+ * @param[in]  indexgroup  = ADS index group
+ * @param[in]  indexoffset = ADS index offset
+ * @param[in]  wsize       = Size in bytes of data to write
+ * @param[in]  wdata       = Pointer to data to write
+ * @param[in,out] rsize    = Size in bytes of read buffer, returns bytes read
+ * @param[out] rdata       = Pointer to read buffer
+ * @param[in]  timeout     = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ */
+int ecx_AoEreadwrite(ecx_contextt *context, uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                     uint32 indexgroup, uint32 indexoffset, int wsize, const void *wdata,
+                     int *rsize, void *rdata, int timeout)
+{
+   ec_AoErequestt req;
+   int wkc;
+
+   memset(&req, 0x00, sizeof(req));
+   req.slave = slave;
+   req.target = *target;
+   req.source = *source;
+   req.indexgroup = indexgroup;
+   req.indexoffset = indexoffset;
+   req.wsize = wsize;
+   req.wdata = wdata;
+   if (!rsize)
+   {
+      req.command = EC_AOE_CMD_WRITE;
+   }
+   else
+   {
+      req.command = (wsize < 0) ? EC_AOE_CMD_READ : EC_AOE_CMD_READWRITE;
+      req.rsize = *rsize;
+      req.rdata = rdata;
+   }
+   wkc = ecx_AoErequest(context, &req, timeout);
+   if ((wkc > 0) && rsize)
+   {
+      *rsize = req.rsize;
+   }
+
+   return wkc;
+}
+
+static void ecx_AoEbatch_complete(ecx_contextt *context, ec_mbxtranst *trans);
+static void ecx_AoEbatch_rxcomplete(ecx_contextt *context, ec_mbxtranst *trans);
+
+/* Finish request of a batch */
+static void ecx_AoEbatch_finish(ec_AoErequestt *req, int wkc)
+{
+   if (req->sent)
+   {
+      req->head->pending--;
+   }
+   req->wkc = wkc;
+   req->sent = FALSE;
+   req->busy = FALSE;
+}
+
+/* Write requests of a slave up to the pipeline depth and read responses */
+static void ecx_AoEbatch_fill(ecx_contextt *context, ec_AoErequestt *head)
+{
+   ec_AoErequestt *req;
+
+   while (head->sendnext && (head->pending < head->depth))
+   {
+      req = head->sendnext;
+      head->sendnext = req->next;
+      if (!ecx_AoEframe(context, req))
+      {
+         ecx_AoEbatch_finish(req, EC_ERROR);
+         continue;
+      }
+      req->trans.slave = req->slave;
+      req->trans.txmbx = &(req->txmbx);
+      req->trans.rxmbx = NULL;
+      req->trans.timeout = req->timeout;
+      req->trans.complete = ecx_AoEbatch_complete;
+      req->trans.userdata = req;
+      if (!ecx_mbxsubmit(context, &(req->trans)))
+      {
+         ecx_AoEbatch_finish(req, EC_ERROR);
+         continue;
+      }
+      req->sent = TRUE;
+      head->pending++;
+   }
+   /* responses are read after the requests written so far */
+   if (head->pending && ((head->rxtrans.state == EC_MBXTRANS_IDLE) ||
+                         (head->rxtrans.state >= EC_MBXTRANS_DONE)))
+   {
+      ec_clearmbx(&(head->rxmbx));
+      head->rxtrans.slave = head->slave;
+      head->rxtrans.txmbx = NULL;
+      head->rxtrans.rxmbx = &(head->rxmbx);
+      head->rxtrans.timeout = head->timeout;
+      head->rxtrans.complete = ecx_AoEbatch_rxcomplete;
+      head->rxtrans.userdata = head;
+      if (!ecx_mbxsubmit(context, &(head->rxtrans)))
+      {
+         for (req = head; req; req = req->next)
+         {
+            if (req->busy)
+            {
+               ecx_AoEbatch_finish(req, EC_ERROR);
+            }
+         }
+         head->sendnext = NULL;
+      }
+   }
+}
+
+/* Request written or failed */
+static void ecx_AoEbatch_complete(ecx_contextt *context, ec_mbxtranst *trans)
+{
+   ec_AoErequestt *req;
+
+   req = (ec_AoErequestt *)trans->userdata;
+   if (trans->state != EC_MBXTRANS_DONE)
+   {
+      ecx_AoEbatch_finish(req, (trans->wkc < 0) ? trans->wkc : EC_ERROR);
+      ecx_AoEbatch_fill(context, req->head);
+   }
+}
+
+/* Response read, finish request with same invoke ID */
+static void ecx_AoEbatch_rxcomplete(ecx_contextt *context, ec_mbxtranst *trans)
+{
+   ec_AoErequestt *head, *req;
+   uint32 invokeid;
+
+   head = (ec_AoErequestt *)trans->userdata;
+   if (trans->state != EC_MBXTRANS_DONE)
+   {
+      /* no response, requests written are lost */
+      for (req = head; req; req = req->next)
+      {
+         if (req->busy && req->sent)
+         {
+            ecx_AoEbatch_finish(req, (trans->wkc < 0) ? trans->wkc : EC_ERROR);
+         }
+      }
+   }
+   else
+   {
+      invokeid = ecx_AoEresponseid(&(head->rxmbx));
+      for (req = head; req && invokeid; req = req->next)
+      {
+         if (req->busy && req->sent && (req->invokeid == invokeid))
+         {
+            ecx_AoEbatch_finish(req, ecx_AoEresponse(context, req, &(head->rxmbx), trans->wkc));
+            break;
+         }
+      }
+   }
+   ecx_AoEbatch_fill(context, head);
+}
+
+/* Reset batch request, without engine request it right away */
+static uint16 ecx_AoEbatch_prepare(ecx_contextt *context, void *p, void *arg, int timeout)
+{
+   ec_AoErequestt *req;
+
+   req = (ec_AoErequestt *)p;
+   req->busy = FALSE;
+   /* disabled request, result is kept */
+   if (req->slave == 0)
+   {
+      return 0;
+   }
+   req->wkc = 0;
+   req->result = 0;
+   req->sent = FALSE;
+   req->timeout = timeout;
+   req->next = NULL;
+   req->trans.state = EC_MBXTRANS_IDLE;
+   if ((req->slave > *(context->slavecount)) || (req->slave >= EC_MAXSLAVE))
+   {
+      req->wkc = EC_ERROR;
+      return 0;
+   }
+   /* without engine request one by one */
+   if (!context->mbxengine)
+   {
+      ecx_AoErequest(context, req, timeout);
+      return 0;
+   }
+   req->busy = TRUE;
+   /* every request can be the head of the pipeline of its slave */
+   req->head = req;
+   req->sendnext = req;
+   req->pending = 0;
+   req->depth = *(int *)arg;
+   req->rxtrans.state = EC_MBXTRANS_IDLE;
+   return req->slave;
+}
+
+/* Requests of a slave share the pipeline of the first request */
+static void ecx_AoEbatch_chain(void *prev, void *p)
+{
+   ec_AoErequestt *req;
+
+   req = (ec_AoErequestt *)p;
+   if (prev)
+   {
+      ((ec_AoErequestt *)prev)->next = req;
+      req->head = ((ec_AoErequestt *)prev)->head;
+   }
+}
+
+static void ecx_AoEbatch_first(ecx_contextt *context, void *req)
+{
+   ecx_AoEbatch_fill(context, (ec_AoErequestt *)req);
+}
+
+static boolean ecx_AoEbatch_busy(void *req)
+{
+   return ((ec_AoErequestt *)req)->busy;
+}
+
+/* count only requests of this batch */
+static boolean ecx_AoEbatch_success(void *p)
+{
+   ec_AoErequestt *req;
+
+   req = (ec_AoErequestt *)p;
+   return ((req->slave != 0) && (req->wkc > 0));
+}
+
+static void ecx_AoEbatch_cancel(void *p, int wkc)
+{
+   ec_AoErequestt *req;
+
+   req = (ec_AoErequestt *)p;
+   req->wkc = wkc;
+   req->busy = FALSE;
+}
+
+static const ec_mbxbatchopst ecx_AoEbatch_ops =
+{
+   sizeof(ec_AoErequestt),
+   ecx_AoEbatch_prepare,
+   ecx_AoEbatch_chain,
+   ecx_AoEbatch_first,
+   ecx_AoEbatch_busy,
+   ecx_AoEbatch_success,
+   ecx_AoEbatch_cancel
+};
+
+/** AoE requests to many slaves, blocking.
+ *
+ * All slaves are served in parallel by the mailbox engine. Per slave up to
+ * depth requests are written before the first response is read, the
+ * responses are matched by invoke ID. Only use depth > 1 for devices that
+ * accept several outstanding AoE requests. Without mailbox engine the
+ * requests are done one by one with ecx_AoErequest().
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     n        = number of requests
+ * @param[in,out] list     = requests, see ecx_AoErequest(). Requests with
+ *                           slave 0 are skipped.
+ * @param[in]     depth    = max. outstanding requests per slave, 1 to EC_AOEMAXPENDING
+ * @param[in]     timeout  = Timeout per mailbox transaction in us, standard is EC_TIMEOUTRXM
+ * @return number of requests done successfully
+ */
+int ecx_AoEbatch(ecx_contextt *context, int n, ec_AoErequestt *list, int depth, int timeout)
+{
+   if (depth < 1)
+   {
+      depth = 1;
+   }
+   if (depth > EC_AOEMAXPENDING)
+   {
+      depth = EC_AOEMAXPENDING;
+   }
+
+   return ecx_mbxbatch(context, &ecx_AoEbatch_ops, n, list, &depth, timeout);
+}
+
+#ifdef EC_VER1
+int ec_AoErequest(ec_AoErequestt *req, int timeout)
+{
+   return ecx_AoErequest(&ecx_context, req, timeout);
+}
+
+int ec_AoEread(uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+               uint32 indexgroup, uint32 indexoffset, int *psize, void *p, int timeout)
+{
+   return ecx_AoEread(&ecx_context, slave, target, source, indexgroup, indexoffset, psize, p, timeout);
+}
+
+int ec_AoEwrite(uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                uint32 indexgroup, uint32 indexoffset, int psize, const void *p, int timeout)
+{
+   return ecx_AoEwrite(&ecx_context, slave, target, source, indexgroup, indexoffset, psize, p, timeout);
+}
+
+int ec_AoEreadwrite(uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                    uint32 indexgroup, uint32 indexoffset, int wsize, const void *wdata,
+                    int *rsize, void *rdata, int timeout)
+{
+   return ecx_AoEreadwrite(&ecx_context, slave, target, source, indexgroup, indexoffset,
+                           wsize, wdata, rsize, rdata, timeout);
+}
+
+int ec_AoEbatch(int n, ec_AoErequestt *list, int depth, int timeout)
+{
+   return ecx_AoEbatch(&ecx_context, n, list, depth, timeout);
+}
+#endif
@@ -0,0 +1,126 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercataoe.c
+ */
+
+#ifndef _ethercataoe_
+#define _ethercataoe_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** ADS read command */
+#define EC_AOE_CMD_READ       0x0002
+/** ADS write command */
+#define EC_AOE_CMD_WRITE      0x0003
+/** ADS read write command */
+#define EC_AOE_CMD_READWRITE  0x0009
+/** AMS state flags of ADS request */
+#define EC_AOE_STATE_REQ      0x0004
+/** AMS state flag of response */
+#define EC_AOE_STATE_RES      0x0001
+/** max. AoE requests outstanding per slave in ecx_AoEbatch() */
+#define EC_AOEMAXPENDING      8
+
+/** AMS address */
+typedef struct
+{
+   /** AMS Net ID */
+   uint8           netid[6];
+   /** AMS port */
+   uint16          port;
+} ec_AoEaddrt;
+
+typedef struct ec_AoErequest ec_AoErequestt;
+
+/** AoE request, see ecx_AoErequest() and ecx_AoEbatch() */
+struct ec_AoErequest
+{
+   /** slave number */
+   uint16          slave;
+   /** AMS address of target in slave */
+   ec_AoEaddrt     target;
+   /** AMS address of master */
+   ec_AoEaddrt     source;
+   /** ADS command, EC_AOE_CMD_READ, EC_AOE_CMD_WRITE or EC_AOE_CMD_READWRITE */
+   uint16          command;
+   /** ADS index group */
+   uint32          indexgroup;
+   /** ADS index offset */
+   uint32          indexoffset;
+   /** size in bytes of data to write */
+   int             wsize;
+   /** data to write */
+   const void      *wdata;
+   /** size in bytes of read buffer, returns size of data read */
+   int             rsize;
+   /** read buffer */
+   void            *rdata;
+   /** result, workcounter >0 is success, 0 = ADS error or unexpected
+    * response, EC_TIMEOUT or EC_ERROR on mailbox failure */
+   int             wkc;
+   /** AMS error code or ADS result, 0 if no error */
+   uint32          result;
+   /** internal, invoke ID of request */
+   uint32          invokeid;
+   /** internal, request is not finished */
+   boolean         busy;
+   /** internal, request is written to slave */
+   boolean         sent;
+   /** internal, timeout per mailbox transaction in us */
+   int             timeout;
+   /** internal, first request of the same slave, holds the pipeline */
+   ec_AoErequestt  *head;
+   /** internal, next request of the same slave */
+   ec_AoErequestt  *next;
+   /** internal, head only, next request to write */
+   ec_AoErequestt  *sendnext;
+   /** internal, head only, requests written and not answered */
+   int             pending;
+   /** internal, head only, max. requests written and not answered */
+   int             depth;
+   /** internal, mailbox transaction of request */
+   ec_mbxtranst    trans;
+   /** internal, head only, mailbox transaction of responses */
+   ec_mbxtranst    rxtrans;
+   /** internal, request */
+   ec_mbxbuft      txmbx;
+   /** internal, head only, response */
+   ec_mbxbuft      rxmbx;
+};
+
+#ifdef EC_VER1
+int ec_AoErequest(ec_AoErequestt *req, int timeout);
+int ec_AoEread(uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+               uint32 indexgroup, uint32 indexoffset, int *psize, void *p, int timeout);
+int ec_AoEwrite(uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                uint32 indexgroup, uint32 indexoffset, int psize, const void *p, int timeout);
+int ec_AoEreadwrite(uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                    uint32 indexgroup, uint32 indexoffset, int wsize, const void *wdata,
+                    int *rsize, void *rdata, int timeout);
+int ec_AoEbatch(int n, ec_AoErequestt *list, int depth, int timeout);
+#endif
+
+void ecx_AoEerror(ecx_contextt *context, uint16 Slave, uint32 indexgroup, uint32 Error);
+int ecx_AoErequest(ecx_contextt *context, ec_AoErequestt *req, int timeout);
+int ecx_AoEread(ecx_contextt *context, uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                uint32 indexgroup, uint32 indexoffset, int *psize, void *p, int timeout);
+int ecx_AoEwrite(ecx_contextt *context, uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                 uint32 indexgroup, uint32 indexoffset, int psize, const void *p, int timeout);
+int ecx_AoEreadwrite(ecx_contextt *context, uint16 slave, const ec_AoEaddrt *target, const ec_AoEaddrt *source,
+                     uint32 indexgroup, uint32 indexoffset, int wsize, const void *wdata,
+                     int *rsize, void *rdata, int timeout);
+int ecx_AoEbatch(ecx_contextt *context, int n, ec_AoErequestt *list, int depth, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
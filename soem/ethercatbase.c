@@ -21,6 +21,13 @@
 #include "ethercattype.h"
 #include "ethercatbase.h"
 
+/** max. datagrams in one frame for ecx_dgrams() */
+#define EC_MAXDGRAM       128
+/** datagram bytes in frame besides data, header and workcounter */
+#define EC_DGRAMOVERHEAD  (EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE)
+/** space for datagrams in one frame */
+#define EC_DGRAMSPACE     (EC_MAXLRWDATA + EC_DGRAMOVERHEAD)
+
 /** Write data to EtherCAT datagram.
  *
  * @param[out] datagramdata   = data part of datagram
@@ -86,6 +93,8 @@ int ecx_setupdatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, uint16
    frameP[ETH_HEADERSIZE + EC_HEADERSIZE + length + 1] = 0x00;
    /* set size of frame in buffer array */
    port->txbuflength[idx] = ETH_HEADERSIZE + EC_HEADERSIZE + EC_WKCSIZE + length;
+   /* count datagrams for statistics */
+   port->dgramcnt++;
 
    return 0;
 }
@@ -139,6 +148,8 @@ uint16 ecx_adddatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, boole
    frameP[prevlength + EC_HEADERSIZE - EC_ELENGTHSIZE + length + 1] = 0x00;
    /* set size of frame in buffer array */
    port->txbuflength[idx] = prevlength + EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + length;
+   /* count datagrams for statistics */
+   port->dgramcnt++;
 
    /* return offset to data in rx frame
       14 bytes smaller than tx frame due to stripping of ethernet header */
@@ -535,6 +546,97 @@ int ecx_LRWDC(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, uint16
    return wkc;
 }
 
+/** Check if datagram command returns data to master.
+ *
+ * @param[in] cmd     = datagram command, f.e. EC_CMD_FPRD
+ * @return TRUE if data is read from slaves
+ */
+boolean ec_dgram_isread(uint8 cmd)
+{
+   switch (cmd)
+   {
+      case EC_CMD_NOP:
+      case EC_CMD_APWR:
+      case EC_CMD_FPWR:
+      case EC_CMD_BWR:
+      case EC_CMD_LWR:
+         return FALSE;
+      default:
+         return TRUE;
+   }
+}
+
+/** Exchange a list of datagrams with the network, packing as many datagrams
+ * as fit in each frame. Data of read datagrams is copied back to the buffers.
+ *
+ * @param[in]     port     = port context struct
+ * @param[in]     n        = number of datagrams
+ * @param[in,out] dgram    = datagram list, wkc is set per datagram
+ * @param[in]     timeout  = timeout per frame in us
+ * @return number of datagrams with wkc > 0
+ */
+int ecx_dgrams(ecx_portt *port, int n, ec_dgramt *dgram, int timeout)
+{
+   uint16 datapos[EC_MAXDGRAM];
+   uint16 le_wkc;
+   int first, last, lp, space, wkc, cnt;
+   uint8 idx;
+
+   cnt = 0;
+   first = 0;
+   while (first < n)
+   {
+      /* collect datagrams that fit in one frame */
+      space = EC_DGRAMSPACE;
+      last = first;
+      while ((last < n) && ((last - first) < EC_MAXDGRAM) &&
+             ((int)(dgram[last].length + EC_DGRAMOVERHEAD) <= space))
+      {
+         space -= (int)(dgram[last].length + EC_DGRAMOVERHEAD);
+         last++;
+      }
+      if (last == first) /* datagram does not fit in a frame */
+      {
+         dgram[first++].wkc = EC_ERROR;
+         continue;
+      }
+      idx = ecx_getindex(port);
+      ecx_setupdatagram(port, &(port->txbuf[idx]), dgram[first].cmd, idx,
+         dgram[first].ADP, dgram[first].ADO, dgram[first].length, dgram[first].data);
+      datapos[0] = EC_HEADERSIZE;
+      for (lp = first + 1; lp < last; lp++)
+      {
+         datapos[lp - first] = ecx_adddatagram(port, &(port->txbuf[idx]), dgram[lp].cmd, idx,
+            (lp < (last - 1)), dgram[lp].ADP, dgram[lp].ADO, dgram[lp].length, dgram[lp].data);
+      }
+      wkc = ecx_srconfirm(port, idx, timeout);
+      for (lp = first; lp < last; lp++)
+      {
+         if (wkc >= 0)
+         {
+            memcpy(&le_wkc, &(port->rxbuf[idx][datapos[lp - first] + dgram[lp].length]), EC_WKCSIZE);
+            dgram[lp].wkc = etohs(le_wkc);
+            if ((dgram[lp].wkc > 0) && ec_dgram_isread(dgram[lp].cmd))
+            {
+               memcpy(dgram[lp].data, &(port->rxbuf[idx][datapos[lp - first]]), dgram[lp].length);
+            }
+            if (dgram[lp].wkc > 0)
+            {
+               cnt++;
+            }
+         }
+         else
+         {
+            dgram[lp].wkc = wkc;
+         }
+      }
+      ecx_setbufstat(port, idx, EC_BUF_EMPTY);
+      first = last;
+   }
+
+   return cnt;
+}
+
 #ifdef EC_VER1
 int ec_setupdatagram(void *frame, uint8 com, uint8 idx, uint16 ADP, uint16 ADO, uint16 length, void *data)
 {
@@ -634,4 +736,9 @@ int ec_LRWDC(uint32 LogAdr, uint16 length, void *data, uint16 DCrs, int64 *DCtim
 {
    return ecx_LRWDC(&ecx_port, LogAdr, length, data, DCrs, DCtime, timeout);
 }
+
+int ec_dgrams(int n, ec_dgramt *dgram, int timeout)
+{
+   return ecx_dgrams(&ecx_port, n, dgram, timeout);
+}
 #endif
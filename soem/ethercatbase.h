@@ -16,6 +16,23 @@ extern "C"
 {
 #endif
 
+/** Datagram for ecx_dgrams() */
+typedef struct
+{
+   /** command, f.e. EC_CMD_FPRD */
+   uint8             cmd;
+   /** address position */
+   uint16            ADP;
+   /** address offset */
+   uint16            ADO;
+   /** data length */
+   uint16            length;
+   /** data to write or buffer for data read */
+   void              *data;
+   /** workcounter of datagram, EC_NOFRAME if frame is lost */
+   int               wkc;
+} ec_dgramt;
+
 int ecx_setupdatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, uint16 ADP, uint16 ADO, uint16 length, void *data);
 uint16 ecx_adddatagram(ecx_portt *port, void *frame, uint8 com, uint8 idx, boolean more, uint16 ADP, uint16 ADO, uint16 length, void *data);
 int ecx_BWR(ecx_portt *port, uint16 ADP,uint16 ADO,uint16 length,void *data,int timeout);
@@ -34,6 +51,8 @@ int ecx_LRW(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, int timeo
 int ecx_LRD(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, int timeout);
 int ecx_LWR(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, int timeout);
 int ecx_LRWDC(ecx_portt *port, uint32 LogAdr, uint16 length, void *data, uint16 DCrs, int64 *DCtime, int timeout);
+boolean ec_dgram_isread(uint8 cmd);
+int ecx_dgrams(ecx_portt *port, int n, ec_dgramt *dgram, int timeout);
 
 #ifdef EC_VER1
 int ec_setupdatagram(void *frame, uint8 com, uint8 idx, uint16 ADP, uint16 ADO, uint16 length, void *data);
@@ -54,6 +73,7 @@ int ec_LRW(uint32 LogAdr, uint16 length, void *data, int timeout);
 int ec_LRD(uint32 LogAdr, uint16 length, void *data, int timeout);
 int ec_LWR(uint32 LogAdr, uint16 length, void *data, int timeout);
 int ec_LRWDC(uint32 LogAdr, uint16 length, void *data, uint16 DCrs, int64 *DCtime, int timeout);
+int ec_dgrams(int n, ec_dgramt *dgram, int timeout);
 #endif
 
 #ifdef __cplusplus
@@ -17,6 +17,7 @@
 #include "ethercattype.h"
 #include "ethercatbase.h"
 #include "ethercatmain.h"
+#include "ethercatmbx.h"
 #include "ethercatcoe.h"
 
 /** SDO structure, not to be confused with EcSDOserviceT */
@@ -1310,6 +1311,1243 @@ int ecx_readOE(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist, ec_OElis
    return wkc;
 }
 
+/* Fill mailbox and CoE header of a SDO request */
+static void ecx_SDOheader(ecx_contextt *context, uint16 slave, ec_SDOt *SDOp, uint16 length)
+{
+   uint8 cnt;
+
+   SDOp->MbxHeader.length = htoes(length);
+   SDOp->MbxHeader.address = htoes(0x0000);
+   SDOp->MbxHeader.priority = 0x00;
+   /* get new mailbox count value, used as session handle */
+   cnt = ec_nextmbxcnt(context->slavelist[slave].mbx_cnt);
+   context->slavelist[slave].mbx_cnt = cnt;
+   SDOp->MbxHeader.mbxtype = ECT_MBXT_COE + MBX_HDR_SET_CNT(cnt); /* CoE */
+   SDOp->CANOpen = htoes(0x000 + (ECT_COES_SDOREQ << 12)); /* number 9bits service upper 4 bits (SDO request) */
+}
+
+static void ecx_SDObatch_complete(ecx_contextt *context, ec_mbxtranst *trans);
+static void ecx_SDObatch_start(ecx_contextt *context, ec_SDObatcht *entry);
+
+/* Submit request of a batch entry to the mailbox engine */
+static boolean ecx_SDObatch_submit(ecx_contextt *context, ec_SDObatcht *entry)
+{
+   ec_clearmbx(&(entry->rxmbx));
+   entry->trans.slave = entry->slave;
+   entry->trans.txmbx = &(entry->txmbx);
+   entry->trans.rxmbx = &(entry->rxmbx);
+   entry->trans.timeout = entry->timeout;
+   entry->trans.complete = ecx_SDObatch_complete;
+   entry->trans.userdata = entry;
+
+   return (ecx_mbxsubmit(context, &(entry->trans)) > 0);
+}
+
+/* Finish a batch entry and start the next entry of the same slave */
+static void ecx_SDObatch_finish(ecx_contextt *context, ec_SDObatcht *entry, int wkc)
+{
+   entry->wkc = wkc;
+   entry->busy = FALSE;
+   if (entry->next)
+   {
+      ecx_SDObatch_start(context, entry->next);
+   }
+}
+
+/* Report unexpected response of a batch entry */
+static void ecx_SDObatch_error(ecx_contextt *context, ec_SDObatcht *entry)
+{
+   ec_SDOt *aSDOp;
+
+   aSDOp = (ec_SDOt *)&(entry->rxmbx);
+   if (aSDOp->Command == ECT_SDO_ABORT) /* SDO abort frame received */
+   {
+      entry->abortcode = etohl(aSDOp->ldata[0]);
+      ecx_SDOerror(context, entry->slave, entry->index, entry->subindex, entry->abortcode);
+   }
+   else
+   {
+      ecx_packeterror(context, entry->slave, entry->index, entry->subindex, 1); /* Unexpected frame returned */
+   }
+}
+
+/* Build next segment request of a batch entry */
+static void ecx_SDObatch_segment(ecx_contextt *context, ec_SDObatcht *entry)
+{
+   ec_SDOt *SDOp;
+   int maxdata, framedatasize;
+   uint8 command;
+
+   ec_clearmbx(&(entry->txmbx));
+   SDOp = (ec_SDOt *)&(entry->txmbx);
+   if (!entry->write)
+   {
+      ecx_SDOheader(context, entry->slave, SDOp, 0x000a);
+      SDOp->Command = ECT_SDO_SEG_UP_REQ + entry->toggle; /* segment upload request */
+      SDOp->Index = htoes(entry->index);
+      SDOp->SubIndex = entry->subindex;
+   }
+   else
+   {
+      /* data section=mailbox size - 6 mbx - 2 CoE - 1 sdo seg */
+      maxdata = context->slavelist[entry->slave].mbx_l - 0x10 + 7;
+      framedatasize = entry->size - entry->done;
+      command = 0x01; /* last segment */
+      if (framedatasize > maxdata)
+      {
+         framedatasize = maxdata;  /*  more segments needed  */
+         command = 0x00; /* segments follow */
+      }
+      if ((command == 0x01) && (framedatasize < 7))
+      {
+         ecx_SDOheader(context, entry->slave, SDOp, 0x0a); /* minimum size */
+         command = (uint8)(0x01 + ((7 - framedatasize) << 1)); /* last segment reduced octets */
+      }
+      else
+      {
+         ecx_SDOheader(context, entry->slave, SDOp, (uint16)(framedatasize + 3)); /* data + 2 CoE + 1 SDO */
+      }
+      SDOp->Command = command + entry->toggle; /* add toggle bit to command byte */
+      /* copy parameter data to mailbox */
+      memcpy(&SDOp->Index, (uint8 *)entry->data + entry->done, framedatasize);
+      entry->done += framedatasize;
+   }
+   entry->toggle ^= 0x10; /* toggle bit for segment request */
+}
+
+/* Build and submit first request of a batch entry */
+static void ecx_SDObatch_start(ecx_contextt *context, ec_SDObatcht *entry)
+{
+   ec_SDOt *SDOp;
+   int maxdata, framedatasize;
+
+   ec_clearmbx(&(entry->txmbx));
+   SDOp = (ec_SDOt *)&(entry->txmbx);
+   entry->segmented = FALSE;
+   entry->toggle = 0x00;
+   entry->done = 0;
+   if (!entry->write)
+   {
+      ecx_SDOheader(context, entry->slave, SDOp, 0x000a);
+      if (entry->CA)
+      {
+         SDOp->Command = ECT_SDO_UP_REQ_CA; /* upload request complete access */
+      }
+      else
+      {
+         SDOp->Command = ECT_SDO_UP_REQ; /* upload request normal */
+      }
+   }
+   /* if small data use expedited transfer */
+   else if ((entry->size <= 4) && !entry->CA)
+   {
+      ecx_SDOheader(context, entry->slave, SDOp, 0x000a);
+      SDOp->Command = ECT_SDO_DOWN_EXP | (((4 - entry->size) << 2) & 0x0c); /* expedited SDO download transfer */
+      memcpy(&SDOp->ldata[0], entry->data, entry->size);
+      entry->done = entry->size;
+   }
+   else
+   {
+      /* data section=mailbox size - 6 mbx - 2 CoE - 8 sdo req */
+      maxdata = context->slavelist[entry->slave].mbx_l - 0x10;
+      framedatasize = entry->size;
+      if (framedatasize > maxdata)
+      {
+         framedatasize = maxdata;  /*  segmented transfer needed  */
+      }
+      ecx_SDOheader(context, entry->slave, SDOp, (uint16)(0x0a + framedatasize));
+      if (entry->CA)
+      {
+         SDOp->Command = ECT_SDO_DOWN_INIT_CA; /* Complete Access, normal SDO init download transfer */
+      }
+      else
+      {
+         SDOp->Command = ECT_SDO_DOWN_INIT; /* normal SDO init download transfer */
+      }
+      SDOp->ldata[0] = htoel(entry->size);
+      /* copy parameter data to mailbox */
+      memcpy(&SDOp->ldata[1], entry->data, framedatasize);
+      entry->done = framedatasize;
+   }
+   SDOp->Index = htoes(entry->index);
+   SDOp->SubIndex = entry->subindex;
+   if (entry->CA && (entry->subindex > 1))
+   {
+      SDOp->SubIndex = 1;
+   }
+   if (!ecx_SDObatch_submit(context, entry))
+   {
+      ecx_SDObatch_finish(context, entry, EC_ERROR);
+   }
+}
+
+/* Evaluate SDO upload response of a batch entry, returns TRUE when finished */
+static boolean ecx_SDObatch_read(ecx_contextt *context, ec_SDObatcht *entry)
+{
+   ec_SDOt *SDOp, *aSDOp;
+   uint16 bytesize, Framedatasize;
+   int32 SDOlen;
+
+   aSDOp = (ec_SDOt *)&(entry->rxmbx);
+   SDOp = (ec_SDOt *)&(entry->txmbx);
+   if (((aSDOp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_COE) ||
+       ((etohs(aSDOp->CANOpen) >> 12) != ECT_COES_SDORES))
+   {
+      ecx_SDObatch_error(context, entry);
+      return TRUE;
+   }
+   if (!entry->segmented)
+   {
+      /* slave response should be the correct index */
+      if (aSDOp->Index != SDOp->Index)
+      {
+         ecx_SDObatch_error(context, entry);
+      }
+      else if ((aSDOp->Command & 0x02) > 0)
+      {
+         /* expedited frame response */
+         bytesize = 4 - ((aSDOp->Command >> 2) & 0x03);
+         if (entry->size >= bytesize) /* parameter buffer big enough ? */
+         {
+            memcpy(entry->data, &aSDOp->ldata[0], bytesize);
+            entry->size = bytesize;
+            entry->wkc = entry->trans.wkc;
+         }
+         else
+         {
+            ecx_packeterror(context, entry->slave, entry->index, entry->subindex, 3); /*  data container too small for type */
+         }
+      }
+      else
+      { /* normal frame response */
+         SDOlen = etohl(aSDOp->ldata[0]);
+         Framedatasize = (etohs(aSDOp->MbxHeader.length) - 10);
+         /* Does parameter fit in parameter buffer ? */
+         if (SDOlen > entry->size)
+         {
+            ecx_packeterror(context, entry->slave, entry->index, entry->subindex, 3); /*  data container too small for type */
+         }
+         else if (Framedatasize < SDOlen) /* transfer in segments? */
+         {
+            memcpy(entry->data, &aSDOp->ldata[1], Framedatasize);
+            entry->done = Framedatasize;
+            entry->segmented = TRUE;
+            ecx_SDObatch_segment(context, entry);
+            return FALSE;
+         }
+         else
+         {
+            memcpy(entry->data, &aSDOp->ldata[1], SDOlen);
+            entry->size = SDOlen;
+            entry->wkc = entry->trans.wkc;
+         }
+      }
+      return TRUE;
+   }
+   /* segment response */
+   if ((aSDOp->Command & 0xe0) != 0x00)
+   {
+      ecx_SDObatch_error(context, entry);
+      return TRUE;
+   }
+   /* calculate mailbox transfer size */
+   Framedatasize = etohs(aSDOp->MbxHeader.length) - 3;
+   if (((aSDOp->Command & 0x01) > 0) && (Framedatasize == 7))
+   {
+      /* subtract unused bytes from frame */
+      Framedatasize = Framedatasize - ((aSDOp->Command & 0x0e) >> 1);
+   }
+   if ((entry->done + Framedatasize) > entry->size)
+   {
+      ecx_packeterror(context, entry->slave, entry->index, entry->subindex, 3); /*  data container too small for type */
+      return TRUE;
+   }
+   memcpy((uint8 *)entry->data + entry->done, &(aSDOp->Index), Framedatasize);
+   entry->done += Framedatasize;
+   if ((aSDOp->Command & 0x01) > 0) /* last segment */
+   {
+      entry->size = entry->done;
+      entry->wkc = entry->trans.wkc;
+      return TRUE;
+   }
+   ecx_SDObatch_segment(context, entry);
+
+   return FALSE;
+}
+
+/* Evaluate SDO download response of a batch entry, returns TRUE when finished */
+static boolean ecx_SDObatch_write(ecx_contextt *context, ec_SDObatcht *entry)
+{
+   ec_SDOt *SDOp, *aSDOp;
+
+   aSDOp = (ec_SDOt *)&(entry->rxmbx);
+   SDOp = (ec_SDOt *)&(entry->txmbx);
+   if (((aSDOp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_COE) ||
+       ((etohs(aSDOp->CANOpen) >> 12) != ECT_COES_SDORES) ||
+       (!entry->segmented && ((aSDOp->Index != SDOp->Index) || (aSDOp->SubIndex != SDOp->SubIndex))) ||
+       (entry->segmented && ((aSDOp->Command & 0xe0) != 0x20)))
+   {
+      ecx_SDObatch_error(context, entry);
+      return TRUE;
+   }
+   /* repeat while segments left */
+   if (entry->done < entry->size)
+   {
+      entry->segmented = TRUE;
+      ecx_SDObatch_segment(context, entry);
+      return FALSE;
+   }
+   entry->wkc = entry->trans.wkc;
+
+   return TRUE;
+}
+
+/* Mailbox engine callback of a batch entry */
+static void ecx_SDObatch_complete(ecx_contextt *context, ec_mbxtranst *trans)
+{
+   ec_SDObatcht *entry;
+   boolean finished;
+
+   entry = (ec_SDObatcht *)trans->userdata;
+   if (trans->state != EC_MBXTRANS_DONE)
+   {
+      ecx_SDObatch_finish(context, entry, (trans->wkc < 0) ? trans->wkc : EC_ERROR);
+      return;
+   }
+   entry->wkc = 0;
+   if (entry->write)
+   {
+      finished = ecx_SDObatch_write(context, entry);
+   }
+   else
+   {
+      finished = ecx_SDObatch_read(context, entry);
+   }
+   if (!finished && !ecx_SDObatch_submit(context, entry))
+   {
+      entry->wkc = EC_ERROR;
+      finished = TRUE;
+   }
+   if (finished)
+   {
+      ecx_SDObatch_finish(context, entry, entry->wkc);
+   }
+}
+
+/* Reset batch entry, without engine transfer it right away */
+static uint16 ecx_SDObatch_prepare(ecx_contextt *context, void *p, void *arg, int timeout)
+{
+   ec_SDObatcht *entry;
+   boolean write;
+
+   entry = (ec_SDObatcht *)p;
+   write = *(boolean *)arg;
+   entry->busy = FALSE;
+   /* disabled or already done entry, result is kept */
+   if ((entry->slave == 0) || entry->skip)
+   {
+      return 0;
+   }
+   entry->wkc = 0;
+   entry->abortcode = 0;
+   entry->write = write;
+   entry->timeout = timeout;
+   entry->next = NULL;
+   entry->trans.state = EC_MBXTRANS_IDLE;
+   if ((entry->slave > *(context->slavecount)) || (entry->slave >= EC_MAXSLAVE))
+   {
+      entry->wkc = EC_ERROR;
+      return 0;
+   }
+   /* without engine transfer one by one */
+   if (!context->mbxengine)
+   {
+      if (write)
+      {
+         entry->wkc = ecx_SDOwrite(context, entry->slave, entry->index, entry->subindex,
+                                   entry->CA, entry->size, entry->data, timeout);
+      }
+      else
+      {
+         entry->wkc = ecx_SDOread(context, entry->slave, entry->index, entry->subindex,
+                                  entry->CA, &(entry->size), entry->data, timeout);
+      }
+      return 0;
+   }
+   entry->busy = TRUE;
+   return entry->slave;
+}
+
+static void ecx_SDObatch_chain(void *prev, void *entry)
+{
+   if (prev)
+   {
+      ((ec_SDObatcht *)prev)->next = (ec_SDObatcht *)entry;
+   }
+}
+
+static void ecx_SDObatch_first(ecx_contextt *context, void *entry)
+{
+   ecx_SDObatch_start(context, (ec_SDObatcht *)entry);
+}
+
+static boolean ecx_SDObatch_busy(void *entry)
+{
+   return ((ec_SDObatcht *)entry)->busy;
+}
+
+/* count only entries of this batch */
+static boolean ecx_SDObatch_success(void *p)
+{
+   ec_SDObatcht *entry;
+
+   entry = (ec_SDObatcht *)p;
+   return ((entry->slave != 0) && !entry->skip && (entry->wkc > 0));
+}
+
+static void ecx_SDObatch_cancel(void *p, int wkc)
+{
+   ec_SDObatcht *entry;
+
+   entry = (ec_SDObatcht *)p;
+   entry->wkc = wkc;
+   entry->busy = FALSE;
+}
+
+static const ec_mbxbatchopst ecx_SDObatch_ops =
+{
+   sizeof(ec_SDObatcht),
+   ecx_SDObatch_prepare,
+   ecx_SDObatch_chain,
+   ecx_SDObatch_first,
+   ecx_SDObatch_busy,
+   ecx_SDObatch_success,
+   ecx_SDObatch_cancel
+};
+
+/* Run SDO batch on the mailbox engine, one transfer per slave at a time */
+static int ecx_SDObatch(ecx_contextt *context, int n, ec_SDObatcht *list, int timeout, boolean write)
+{
+   return ecx_mbxbatch(context, &ecx_SDObatch_ops, n, list, &write, timeout);
+}
+
+/** CoE SDO read of a list of objects, blocking.
+ *
+ * All slaves are served in parallel by the mailbox engine, the entries of
+ * one slave are read one after the other. Segmented transfers are
+ * supported. Without mailbox engine the entries are read with
+ * ecx_SDOread().
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries, slave, index, subindex, CA, size and data
+ *                           must be set, size and result are returned per entry.
+ *                           Entries with slave 0 are skipped.
+ * @param[in]     timeout  = Timeout per mailbox transfer in us, standard is EC_TIMEOUTRXM
+ * @return number of entries read successfully
+ */
+int ecx_SDOread_batch(ecx_contextt *context, int n, ec_SDObatcht *list, int timeout)
+{
+   int lp;
+
+   for (lp = 0; lp < n; lp++)
+   {
+      list[lp].skip = FALSE;
+   }
+   return ecx_SDObatch(context, n, list, timeout, FALSE);
+}
+
+/** CoE SDO write of a list of objects, blocking.
+ *
+ * All slaves are served in parallel by the mailbox engine, the entries of
+ * one slave are written one after the other. Expedited, normal and
+ * segmented transfers are used as in ecx_SDOwrite(). Without mailbox
+ * engine the entries are written with ecx_SDOwrite().
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries, slave, index, subindex, CA, size and data
+ *                           must be set, result is returned per entry.
+ *                           Entries with slave 0 are skipped.
+ * @param[in]     timeout  = Timeout per mailbox transfer in us, standard is EC_TIMEOUTRXM
+ * @return number of entries written successfully
+ */
+int ecx_SDOwrite_batch(ecx_contextt *context, int n, ec_SDObatcht *list, int timeout)
+{
+   int lp;
+
+   for (lp = 0; lp < n; lp++)
+   {
+      list[lp].skip = FALSE;
+   }
+   return ecx_SDObatch(context, n, list, timeout, TRUE);
+}
+
+/* Add name of len chars to name pool of cache.
+ * Returns offset of name, 0 (empty name) if pool is full.
+ */
+static uint32 ec_ODcache_addname(ec_ODcachet *cache, const char *name, int len)
+{
+   uint32 pos;
+
+   if ((len <= 0) || ((cache->namesize + len + 1) > EC_ODCNAMESIZE))
+   {
+      return 0;
+   }
+   pos = cache->namesize;
+   memcpy(&cache->name[pos], name, len);
+   cache->name[pos + len] = 0;
+   cache->namesize += len + 1;
+   return pos;
+}
+
+/* Clear cache and set device identity */
+static void ec_ODcache_clear(ec_ODcachet *cache, uint32 man, uint32 id, uint32 rev)
+{
+   cache->valid = FALSE;
+   cache->eep_man = man;
+   cache->eep_id = id;
+   cache->eep_rev = rev;
+   cache->nobject = 0;
+   cache->nentry = 0;
+   /* offset 0 is the empty name */
+   cache->name[0] = 0;
+   cache->namesize = 1;
+}
+
+/* Sort objects of cache by index, list from slave is normally sorted already */
+static void ec_ODcache_sort(ec_ODcachet *cache)
+{
+   ec_ODCobjectt object;
+   int lp, i;
+
+   for (lp = 1; lp < cache->nobject; lp++)
+   {
+      object = cache->object[lp];
+      for (i = lp; (i > 0) && (cache->object[i - 1].index > object.index); i--)
+      {
+         cache->object[i] = cache->object[i - 1];
+      }
+      cache->object[i] = object;
+   }
+}
+
+/** Build object dictionary cache of a slave.
+ *
+ * The cache holds the object descriptions and object entry descriptions
+ * of one device type. When the cache already holds the dictionary of the
+ * vendor, product and revision of the slave nothing is read, otherwise the
+ * dictionary is read with ecx_readODlist(), ecx_readODdescription() and
+ * ecx_readOE(). Of every object subindex 0 and all subindexes with a
+ * bit length are stored.
+ *
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[in,out] cache   = object dictionary cache
+ * @return number of objects in cache, 0 if reading the dictionary failed,
+ * -1 if the entries do not fit in EC_MAXODCENTRY, the cache is not valid then
+ */
+int ecx_ODcache_build(ecx_contextt *context, uint16 slave, ec_ODcachet *cache)
+{
+   ec_slavet *sl;
+   ec_ODCobjectt *object;
+   ec_ODCentryt *entry;
+   int wkc, sub;
+   uint16 item;
+
+   sl = &context->slavelist[slave];
+   if (cache->valid && (cache->eep_man == sl->eep_man) &&
+       (cache->eep_id == sl->eep_id) && (cache->eep_rev == sl->eep_rev))
+   {
+      return cache->nobject;
+   }
+   ec_ODcache_clear(cache, sl->eep_man, sl->eep_id, sl->eep_rev);
+   memset(&cache->ODlist, 0x00, sizeof(cache->ODlist));
+   wkc = ecx_readODlist(context, slave, &cache->ODlist);
+   if (wkc <= 0)
+   {
+      return 0;
+   }
+   for (item = 0; item < cache->ODlist.Entries; item++)
+   {
+      wkc = ecx_readODdescription(context, item, &cache->ODlist);
+      if (wkc < 0)
+      {
+         return 0;
+      }
+      object = &cache->object[cache->nobject++];
+      object->index = cache->ODlist.Index[item];
+      object->datatype = cache->ODlist.DataType[item];
+      object->objectcode = cache->ODlist.ObjectCode[item];
+      object->maxsub = cache->ODlist.MaxSub[item];
+      object->name = ec_ODcache_addname(cache, cache->ODlist.Name[item],
+                                        (int)strlen(cache->ODlist.Name[item]));
+      object->firstentry = cache->nentry;
+      object->nentry = 0;
+      /* object without description has no entries to read */
+      if (wkc == 0)
+      {
+         continue;
+      }
+      memset(&cache->OElist, 0x00, sizeof(cache->OElist));
+      wkc = ecx_readOE(context, item, &cache->ODlist, &cache->OElist);
+      if (wkc < 0)
+      {
+         return 0;
+      }
+      for (sub = 0; sub <= object->maxsub; sub++)
+      {
+         if ((sub > 0) && (cache->OElist.BitLength[sub] == 0))
+         {
+            continue;
+         }
+         /* dictionary does not fit, cache stays invalid */
+         if (cache->nentry >= EC_MAXODCENTRY)
+         {
+            return -1;
+         }
+         entry = &cache->entry[cache->nentry++];
+         entry->subindex = (uint8)sub;
+         entry->valueinfo = cache->OElist.ValueInfo[sub];
+         entry->datatype = cache->OElist.DataType[sub];
+         entry->bitlength = cache->OElist.BitLength[sub];
+         entry->objaccess = cache->OElist.ObjAccess[sub];
+         entry->name = ec_ODcache_addname(cache, cache->OElist.Name[sub],
+                                          (int)strlen(cache->OElist.Name[sub]));
+         object->nentry++;
+      }
+   }
+   ec_ODcache_sort(cache);
+   cache->valid = TRUE;
+
+   return cache->nobject;
+}
+
+/** Find object in object dictionary cache.
+ *
+ * @param[in]  cache      = object dictionary cache
+ * @param[in]  index      = Index of object
+ * @return pointer to object, NULL if not found
+ */
+const ec_ODCobjectt *ec_ODcache_object(const ec_ODcachet *cache, uint16 index)
+{
+   int low, high, mid;
+
+   if (!cache->valid)
+   {
+      return NULL;
+   }
+   low = 0;
+   high = cache->nobject - 1;
+   while (low <= high)
+   {
+      mid = (low + high) / 2;
+      if (cache->object[mid].index == index)
+      {
+         return &cache->object[mid];
+      }
+      if (cache->object[mid].index < index)
+      {
+         low = mid + 1;
+      }
+      else
+      {
+         high = mid - 1;
+      }
+   }
+   return NULL;
+}
+
+/** Find object entry in object dictionary cache.
+ *
+ * @param[in]  cache      = object dictionary cache
+ * @param[in]  index      = Index of object
+ * @param[in]  subindex   = Subindex of entry
+ * @return pointer to entry, NULL if not found
+ */
+const ec_ODCentryt *ec_ODcache_entry(const ec_ODcachet *cache, uint16 index, uint8 subindex)
+{
+   const ec_ODCobjectt *object;
+   int lp;
+
+   object = ec_ODcache_object(cache, index);
+   if (!object)
+   {
+      return NULL;
+   }
+   for (lp = object->firstentry; lp < (object->firstentry + object->nentry); lp++)
+   {
+      if (cache->entry[lp].subindex == subindex)
+      {
+         return &cache->entry[lp];
+      }
+   }
+   return NULL;
+}
+
+/** Get name of object or entry from object dictionary cache.
+ *
+ * @param[in]  cache      = object dictionary cache
+ * @param[in]  name       = name offset of object or entry
+ * @return zero terminated name, empty string if unknown
+ */
+const char *ec_ODcache_name(const ec_ODcachet *cache, uint32 name)
+{
+   if (name >= cache->namesize)
+   {
+      name = 0;
+   }
+   return &cache->name[name];
+}
+
+/** Store object dictionary cache in a compact image, f.e. to write it to
+ * a file. All values are little endian, names are stored without
+ * terminator.
+ *
+ * @param[in]  cache      = object dictionary cache
+ * @param[out] image      = image buffer
+ * @param[in]  size       = size of image buffer in bytes
+ * @return bytes used in image, 0 if cache is empty or buffer too small
+ */
+int ec_ODcache_save(const ec_ODcachet *cache, uint8 *image, int size)
+{
+   const ec_ODCobjectt *object;
+   const ec_ODCentryt *entry;
+   const char *name;
+   int pos, ok, lp, i, len;
+
+   if (!cache->valid)
+   {
+      return 0;
+   }
+   pos = 0;
+   ok = ec_image_put(image, size, &pos, 4, EC_ODCMAGIC) &&
+        ec_image_put(image, size, &pos, 4, cache->eep_man) &&
+        ec_image_put(image, size, &pos, 4, cache->eep_id) &&
+        ec_image_put(image, size, &pos, 4, cache->eep_rev) &&
+        ec_image_put(image, size, &pos, 2, cache->nobject);
+   for (lp = 0; ok && (lp < cache->nobject); lp++)
+   {
+      object = &cache->object[lp];
+      name = ec_ODcache_name(cache, object->name);
+      len = (int)strlen(name);
+      ok = ec_image_put(image, size, &pos, 2, object->index) &&
+           ec_image_put(image, size, &pos, 2, object->datatype) &&
+           ec_image_put(image, size, &pos, 1, object->objectcode) &&
+           ec_image_put(image, size, &pos, 1, object->maxsub) &&
+           ec_image_put(image, size, &pos, 2, object->nentry) &&
+           ec_image_put(image, size, &pos, 1, (uint32)len) &&
+           ((pos + len) <= size);
+      if (ok)
+      {
+         memcpy(&image[pos], name, len);
+         pos += len;
+      }
+      for (i = object->firstentry; ok && (i < (object->firstentry + object->nentry)); i++)
+      {
+         entry = &cache->entry[i];
+         name = ec_ODcache_name(cache, entry->name);
+         len = (int)strlen(name);
+         ok = ec_image_put(image, size, &pos, 1, entry->subindex) &&
+              ec_image_put(image, size, &pos, 1, entry->valueinfo) &&
+              ec_image_put(image, size, &pos, 2, entry->datatype) &&
+              ec_image_put(image, size, &pos, 2, entry->bitlength) &&
+              ec_image_put(image, size, &pos, 2, entry->objaccess) &&
+              ec_image_put(image, size, &pos, 1, (uint32)len) &&
+              ((pos + len) <= size);
+         if (ok)
+         {
+            memcpy(&image[pos], name, len);
+            pos += len;
+         }
+      }
+   }
+
+   return ok ? pos : 0;
+}
+
+/** Load object dictionary cache from an image made by ec_ODcache_save().
+ *
+ * @param[out] cache      = object dictionary cache
+ * @param[in]  image      = image buffer
+ * @param[in]  size       = size of image in bytes
+ * @return bytes used from image, 0 if image is invalid
+ */
+int ec_ODcache_load(ec_ODcachet *cache, const uint8 *image, int size)
+{
+   ec_ODCobjectt *object;
+   ec_ODCentryt *entry;
+   uint32 magic, man, id, rev, nobject, val[6];
+   int pos, lp, i;
+
+   pos = 0;
+   if (!ec_image_get(image, size, &pos, 4, &magic) || (magic != EC_ODCMAGIC) ||
+       !ec_image_get(image, size, &pos, 4, &man) ||
+       !ec_image_get(image, size, &pos, 4, &id) ||
+       !ec_image_get(image, size, &pos, 4, &rev) ||
+       !ec_image_get(image, size, &pos, 2, &nobject) ||
+       (nobject > EC_MAXODLIST))
+   {
+      return 0;
+   }
+   ec_ODcache_clear(cache, man, id, rev);
+   for (lp = 0; lp < (int)nobject; lp++)
+   {
+      if (!ec_image_get(image, size, &pos, 2, &val[0]) ||
+          !ec_image_get(image, size, &pos, 2, &val[1]) ||
+          !ec_image_get(image, size, &pos, 1, &val[2]) ||
+          !ec_image_get(image, size, &pos, 1, &val[3]) ||
+          !ec_image_get(image, size, &pos, 2, &val[4]) ||
+          !ec_image_get(image, size, &pos, 1, &val[5]) ||
+          ((pos + (int)val[5]) > size) ||
+          ((cache->nentry + val[4]) > EC_MAXODCENTRY))
+      {
+         return 0;
+      }
+      object = &cache->object[cache->nobject++];
+      object->index = (uint16)val[0];
+      object->datatype = (uint16)val[1];
+      object->objectcode = (uint8)val[2];
+      object->maxsub = (uint8)val[3];
+      object->firstentry = cache->nentry;
+      object->nentry = (uint16)val[4];
+      object->name = ec_ODcache_addname(cache, (const char *)&image[pos], (int)val[5]);
+      pos += val[5];
+      for (i = 0; i < object->nentry; i++)
+      {
+         if (!ec_image_get(image, size, &pos, 1, &val[0]) ||
+             !ec_image_get(image, size, &pos, 1, &val[1]) ||
+             !ec_image_get(image, size, &pos, 2, &val[2]) ||
+             !ec_image_get(image, size, &pos, 2, &val[3]) ||
+             !ec_image_get(image, size, &pos, 2, &val[4]) ||
+             !ec_image_get(image, size, &pos, 1, &val[5]) ||
+             ((pos + (int)val[5]) > size))
+         {
+            return 0;
+         }
+         entry = &cache->entry[cache->nentry++];
+         entry->subindex = (uint8)val[0];
+         entry->valueinfo = (uint8)val[1];
+         entry->datatype = (uint16)val[2];
+         entry->bitlength = (uint16)val[3];
+         entry->objaccess = (uint16)val[4];
+         entry->name = ec_ODcache_addname(cache, (const char *)&image[pos], (int)val[5]);
+         pos += val[5];
+      }
+   }
+   ec_ODcache_sort(cache);
+   cache->valid = TRUE;
+
+   return pos;
+}
+
+/* Read all subindexes of an object one by one, for slaves without
+ * Complete Access support. Subindex 0 is padded to 16 bits, the other
+ * subindexes follow on byte boundaries. This is not the Complete Access
+ * layout for objects with bit sized subindexes, CA packs those bitwise.
+ */
+static void ecx_ODsnapshot_single(ecx_contextt *context, ec_SDObatcht *entry, int timeout)
+{
+   uint8 *p;
+   int pos, size, wkc;
+   uint8 sub, maxsub;
+
+   p = (uint8 *)entry->data;
+   entry->wkc = 0;
+   if (entry->size < 2)
+   {
+      entry->size = 0;
+      return;
+   }
+   size = 1;
+   p[1] = 0;
+   wkc = ecx_SDOread(context, entry->slave, entry->index, 0, FALSE, &size, p, timeout);
+   if (wkc <= 0)
+   {
+      entry->size = 0;
+      entry->wkc = wkc;
+      return;
+   }
+   maxsub = p[0];
+   pos = 2;
+   for (sub = 1; (sub <= maxsub) && (wkc > 0); sub++)
+   {
+      size = entry->size - pos;
+      wkc = ecx_SDOread(context, entry->slave, entry->index, sub, FALSE, &size, &p[pos], timeout);
+      if (wkc > 0)
+      {
+         pos += size;
+      }
+   }
+   entry->size = pos;
+   entry->wkc = wkc;
+}
+
+/** Read a snapshot of all values of a set of objects, blocking.
+ *
+ * Objects of slaves that support Complete Access are read with one
+ * Complete Access upload per object, all slaves in parallel by
+ * ecx_SDOread_batch(). Objects of other slaves are read subindex by
+ * subindex, subindex 0 padded to 16 bits followed by the other subindexes
+ * each on a byte boundary. For objects with only byte sized subindexes
+ * that is the Complete Access layout, but BOOL and other bit sized
+ * subindexes, packed bitwise by Complete Access, take a byte each.
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries, slave, index, size and data must be set,
+ *                           size and result are returned per entry
+ * @param[in]     timeout  = Timeout per mailbox transfer in us, standard is EC_TIMEOUTRXM
+ * @return number of objects read successfully
+ */
+int ecx_ODsnapshot(ecx_contextt *context, int n, ec_SDObatcht *list, int timeout)
+{
+   ec_SDObatcht *entry;
+   int lp, cnt;
+
+   cnt = 0;
+   for (lp = 0; lp < n; lp++)
+   {
+      entry = &list[lp];
+      entry->subindex = 0;
+      entry->CA = FALSE;
+      entry->done = 0;
+      entry->skip = FALSE;
+      if ((entry->slave == 0) || (entry->slave > *(context->slavecount)) ||
+          (entry->slave >= EC_MAXSLAVE))
+      {
+         entry->wkc = EC_ERROR;
+         continue;
+      }
+      if (context->slavelist[entry->slave].CoEdetails & ECT_COEDET_SDOCA)
+      {
+         entry->CA = TRUE;
+         continue;
+      }
+      ecx_ODsnapshot_single(context, entry, timeout);
+      if (entry->wkc > 0)
+      {
+         cnt++;
+      }
+      /* already read, not part of the batch */
+      entry->skip = TRUE;
+   }
+   cnt += ecx_SDObatch(context, n, list, timeout, FALSE);
+
+   return cnt;
+}
+
+/** abort code sent to the slave when a stream callback stops the transfer */
+#define EC_SDOSTREAMABORT 0x08000020
+
+/* Send SDO abort request to slave, stops a running segmented transfer */
+static void ecx_SDOstream_abort(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                                ec_SDOstreamt *stream)
+{
+   ec_SDOt *SDOp;
+
+   SDOp = (ec_SDOt *)&(stream->txmbx);
+   ecx_SDOheader(context, slave, SDOp, 0x000a);
+   SDOp->Command = ECT_SDO_ABORT;
+   SDOp->Index = htoes(index);
+   SDOp->SubIndex = subindex;
+   SDOp->ldata[0] = htoel(EC_SDOSTREAMABORT);
+   ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+   ecx_SDOerror(context, slave, index, subindex, EC_SDOSTREAMABORT);
+}
+
+/* Check SDO response of a stream transfer, report error if unexpected */
+static boolean ecx_SDOstream_check(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                                   ec_SDOstreamt *stream, boolean ok)
+{
+   ec_SDOt *aSDOp;
+
+   aSDOp = (ec_SDOt *)&(stream->rxmbx);
+   if (((aSDOp->MbxHeader.mbxtype & 0x0f) == ECT_MBXT_COE) &&
+       ((etohs(aSDOp->CANOpen) >> 12) == ECT_COES_SDORES) && ok)
+   {
+      return TRUE;
+   }
+   if (aSDOp->Command == ECT_SDO_ABORT) /* SDO abort frame received */
+   {
+      ecx_SDOerror(context, slave, index, subindex, etohl(aSDOp->ldata[0]));
+   }
+   else
+   {
+      ecx_packeterror(context, slave, index, subindex, 1); /* Unexpected frame returned */
+   }
+
+   return FALSE;
+}
+
+/** CoE SDO read with streaming of the data, blocking.
+ *
+ * Same transfer as ecx_SDOread(), but the data is not collected in a caller
+ * buffer. Every expedited, normal or segment response is passed to the
+ * chunk callback of the stream straight from the response mailbox, so
+ * objects of any size can be processed while they arrive. The mailbox
+ * buffers of the stream are reused for all segments.
+ *
+ * @param[in]     context    = context struct
+ * @param[in]     slave      = Slave number
+ * @param[in]     index      = Index to read
+ * @param[in]     subindex   = Subindex to read, must be 0 or 1 if CA is used.
+ * @param[in]     CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes read.
+ * @param[in,out] stream     = stream with chunk callback, size and done are returned
+ * @param[in]     timeout    = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ */
+int ecx_SDOread_stream(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                       boolean CA, ec_SDOstreamt *stream, int timeout)
+{
+   ec_SDOt *SDOp, *aSDOp;
+   int wkc, framedatasize;
+   uint8 toggle;
+   boolean last;
+   uint8 *data;
+
+   stream->size = 0;
+   stream->done = 0;
+   /* Empty slave out mailbox if something is in. Timeout set to 0 */
+   wkc = ecx_mbxreceive(context, slave, &(stream->rxmbx), 0);
+   aSDOp = (ec_SDOt *)&(stream->rxmbx);
+   SDOp = (ec_SDOt *)&(stream->txmbx);
+   ecx_SDOheader(context, slave, SDOp, 0x000a);
+   if (CA)
+   {
+      SDOp->Command = ECT_SDO_UP_REQ_CA; /* upload request complete access */
+   }
+   else
+   {
+      SDOp->Command = ECT_SDO_UP_REQ; /* upload request normal */
+   }
+   SDOp->Index = htoes(index);
+   if (CA && (subindex > 1))
+   {
+      subindex = 1;
+   }
+   SDOp->SubIndex = subindex;
+   SDOp->ldata[0] = 0;
+   /* send CoE request to slave */
+   wkc = ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+   if (wkc > 0)
+   {
+      wkc = ecx_mbxreceive(context, slave, &(stream->rxmbx), timeout);
+   }
+   if (wkc <= 0)
+   {
+      return wkc;
+   }
+   /* slave response should be CoE, SDO response and the correct index */
+   if (!ecx_SDOstream_check(context, slave, index, subindex, stream, (aSDOp->Index == SDOp->Index)))
+   {
+      return 0;
+   }
+   if ((aSDOp->Command & 0x02) > 0)
+   {
+      /* expedited frame response */
+      framedatasize = 4 - ((aSDOp->Command >> 2) & 0x03);
+      stream->size = framedatasize;
+      data = (uint8 *)&(aSDOp->ldata[0]);
+      last = TRUE;
+   }
+   else
+   {
+      /* normal frame response */
+      stream->size = etohl(aSDOp->ldata[0]);
+      framedatasize = etohs(aSDOp->MbxHeader.length) - 10;
+      data = (uint8 *)&(aSDOp->ldata[1]);
+      last = (framedatasize >= stream->size);
+      if (last)
+      {
+         framedatasize = stream->size;
+      }
+   }
+   if (stream->chunk(context, slave, stream, data, framedatasize) < 0)
+   {
+      ecx_SDOstream_abort(context, slave, index, subindex, stream);
+      return 0;
+   }
+   stream->done = framedatasize;
+   toggle = 0x00;
+   /* segmented transfer */
+   while (!last)
+   {
+      ecx_SDOheader(context, slave, SDOp, 0x000a);
+      SDOp->Command = ECT_SDO_SEG_UP_REQ + toggle; /* segment upload request */
+      SDOp->Index = htoes(index);
+      SDOp->SubIndex = subindex;
+      SDOp->ldata[0] = 0;
+      wkc = ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+      if (wkc > 0)
+      {
+         wkc = ecx_mbxreceive(context, slave, &(stream->rxmbx), timeout);
+      }
+      if (wkc <= 0)
+      {
+         return wkc;
+      }
+      /* slave response should be CoE, SDO response */
+      if (!ecx_SDOstream_check(context, slave, index, subindex, stream, ((aSDOp->Command & 0xe0) == 0x00)))
+      {
+         return 0;
+      }
+      /* calculate mailbox transfer size */
+      framedatasize = etohs(aSDOp->MbxHeader.length) - 3;
+      last = ((aSDOp->Command & 0x01) > 0);
+      if (last && (framedatasize == 7))
+      {
+         /* subtract unused bytes from frame */
+         framedatasize = framedatasize - ((aSDOp->Command & 0x0e) >> 1);
+      }
+      if (stream->chunk(context, slave, stream, (uint8 *)&(aSDOp->Index), framedatasize) < 0)
+      {
+         ecx_SDOstream_abort(context, slave, index, subindex, stream);
+         return 0;
+      }
+      stream->done += framedatasize;
+      toggle = toggle ^ 0x10; /* toggle bit for segment request */
+   }
+
+   return wkc;
+}
+
+/** CoE SDO write with streaming of the data, blocking.
+ *
+ * Same transfer as ecx_SDOwrite(), but the data is not taken from a caller
+ * buffer. For every expedited, normal or segment request the chunk
+ * callback of the stream fills the data straight into the request
+ * mailbox, the callback must fill the requested number of bytes.
+ * The mailbox buffers of the stream are reused for all segments.
+ *
+ * @param[in]     context    = context struct
+ * @param[in]     slave      = Slave number
+ * @param[in]     index      = Index to write
+ * @param[in]     subindex   = Subindex to write, must be 0 or 1 if CA is used.
+ * @param[in]     CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes written.
+ * @param[in,out] stream     = stream with chunk callback and size, done is returned
+ * @param[in]     timeout    = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ */
+int ecx_SDOwrite_stream(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                        boolean CA, ec_SDOstreamt *stream, int timeout)
+{
+   ec_SDOt *SDOp, *aSDOp;
+   int wkc, maxdata, framedatasize;
+   uint8 toggle, command;
+   uint8 *data;
+
+   stream->done = 0;
+   /* Empty slave out mailbox if something is in. Timeout set to 0 */
+   wkc = ecx_mbxreceive(context, slave, &(stream->rxmbx), 0);
+   aSDOp = (ec_SDOt *)&(stream->rxmbx);
+   SDOp = (ec_SDOt *)&(stream->txmbx);
+   maxdata = context->slavelist[slave].mbx_l - 0x10; /* data section=mailbox size - 6 mbx - 2 CoE - 8 sdo req */
+   /* if small data use expedited transfer */
+   if ((stream->size <= 4) && !CA)
+   {
+      framedatasize = stream->size;
+      ecx_SDOheader(context, slave, SDOp, 0x000a);
+      SDOp->Command = ECT_SDO_DOWN_EXP | (((4 - framedatasize) << 2) & 0x0c); /* expedited SDO download transfer */
+      data = (uint8 *)&(SDOp->ldata[0]);
+   }
+   else
+   {
+      framedatasize = stream->size;
+      if (framedatasize > maxdata)
+      {
+         framedatasize = maxdata;  /*  segmented transfer needed  */
+      }
+      ecx_SDOheader(context, slave, SDOp, (uint16)(0x0a + framedatasize));
+      if (CA)
+      {
+         SDOp->Command = ECT_SDO_DOWN_INIT_CA; /* Complete Access, normal SDO init download transfer */
+      }
+      else
+      {
+         SDOp->Command = ECT_SDO_DOWN_INIT; /* normal SDO init download transfer */
+      }
+      SDOp->ldata[0] = htoel(stream->size);
+      data = (uint8 *)&(SDOp->ldata[1]);
+   }
+   SDOp->Index = htoes(index);
+   if (CA && (subindex > 1))
+   {
+      subindex = 1;
+   }
+   SDOp->SubIndex = subindex;
+   /* let the caller fill the parameter data in the mailbox */
+   if (stream->chunk(context, slave, stream, data, framedatasize) != framedatasize)
+   {
+      ecx_packeterror(context, slave, index, subindex, 3); /* no data */
+      return 0;
+   }
+   stream->done = framedatasize;
+   /* send mailbox SDO download request to slave */
+   wkc = ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+   if (wkc > 0)
+   {
+      wkc = ecx_mbxreceive(context, slave, &(stream->rxmbx), timeout);
+   }
+   if (wkc <= 0)
+   {
+      return wkc;
+   }
+   /* response should be CoE, SDO response, correct index and subindex */
+   if (!ecx_SDOstream_check(context, slave, index, subindex, stream,
+                            (aSDOp->Index == SDOp->Index) && (aSDOp->SubIndex == SDOp->SubIndex)))
+   {
+      return 0;
+   }
+   maxdata += 7;
+   toggle = 0;
+   /* repeat while segments left */
+   while (stream->done < stream->size)
+   {
+      framedatasize = stream->size - stream->done;
+      command = 0x01; /* last segment */
+      if (framedatasize > maxdata)
+      {
+         framedatasize = maxdata;  /*  more segments needed  */
+         command = 0x00; /* segments follow */
+      }
+      if ((command == 0x01) && (framedatasize < 7))
+      {
+         ecx_SDOheader(context, slave, SDOp, 0x0a); /* minimum size */
+         command = (uint8)(0x01 + ((7 - framedatasize) << 1)); /* last segment reduced octets */
+      }
+      else
+      {
+         ecx_SDOheader(context, slave, SDOp, (uint16)(framedatasize + 3)); /* data + 2 CoE + 1 SDO */
+      }
+      SDOp->Command = command + toggle; /* add toggle bit to command byte */
+      /* let the caller fill the parameter data in the mailbox */
+      if (stream->chunk(context, slave, stream, (uint8 *)&(SDOp->Index), framedatasize) != framedatasize)
+      {
+         ecx_SDOstream_abort(context, slave, index, subindex, stream);
+         return 0;
+      }
+      /* send SDO download request */
+      wkc = ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+      if (wkc > 0)
+      {
+         wkc = ecx_mbxreceive(context, slave, &(stream->rxmbx), timeout);
+      }
+      if (wkc <= 0)
+      {
+         return wkc;
+      }
+      if (!ecx_SDOstream_check(context, slave, index, subindex, stream, ((aSDOp->Command & 0xe0) == 0x20)))
+      {
+         return 0;
+      }
+      stream->done += framedatasize;
+      toggle = toggle ^ 0x10; /* toggle bit for segment request */
+   }
+
+   return wkc;
+}
+
 #ifdef EC_VER1
 /** Report SDO error.
  *
@@ -1502,4 +2740,90 @@ int ec_readOE(uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist)
 {
    return ecx_readOE(&ecx_context, Item, pODlist, pOElist);
 }
+
+/** CoE SDO read of a list of objects, blocking.
+ *
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries
+ * @param[in]     timeout  = Timeout per mailbox transfer in us, standard is EC_TIMEOUTRXM
+ * @return number of entries read successfully
+ * @see ecx_SDOread_batch
+ */
+int ec_SDOread_batch(int n, ec_SDObatcht *list, int timeout)
+{
+   return ecx_SDOread_batch(&ecx_context, n, list, timeout);
+}
+
+/** CoE SDO write of a list of objects, blocking.
+ *
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries
+ * @param[in]     timeout  = Timeout per mailbox transfer in us, standard is EC_TIMEOUTRXM
+ * @return number of entries written successfully
+ * @see ecx_SDOwrite_batch
+ */
+int ec_SDOwrite_batch(int n, ec_SDObatcht *list, int timeout)
+{
+   return ecx_SDOwrite_batch(&ecx_context, n, list, timeout);
+}
+
+/** Build object dictionary cache of a slave.
+ *
+ * @param[in]  slave      = Slave number
+ * @param[in,out] cache   = object dictionary cache
+ * @return number of objects in cache, 0 if reading the dictionary failed,
+ * -1 if the entries do not fit in EC_MAXODCENTRY
+ * @see ecx_ODcache_build
+ */
+int ec_ODcache_build(uint16 slave, ec_ODcachet *cache)
+{
+   return ecx_ODcache_build(&ecx_context, slave, cache);
+}
+
+/** Read a snapshot of all values of a set of objects, blocking.
+ *
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries
+ * @param[in]     timeout  = Timeout per mailbox transfer in us, standard is EC_TIMEOUTRXM
+ * @return number of objects read successfully
+ * @see ecx_ODsnapshot
+ */
+int ec_ODsnapshot(int n, ec_SDObatcht *list, int timeout)
+{
+   return ecx_ODsnapshot(&ecx_context, n, list, timeout);
+}
+
+/** CoE SDO read with streaming of the data, blocking.
+ *
+ * @param[in]     slave      = Slave number
+ * @param[in]     index      = Index to read
+ * @param[in]     subindex   = Subindex to read, must be 0 or 1 if CA is used.
+ * @param[in]     CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes read.
+ * @param[in,out] stream     = stream with chunk callback
+ * @param[in]     timeout    = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ * @see ecx_SDOread_stream
+ */
+int ec_SDOread_stream(uint16 slave, uint16 index, uint8 subindex,
+                      boolean CA, ec_SDOstreamt *stream, int timeout)
+{
+   return ecx_SDOread_stream(&ecx_context, slave, index, subindex, CA, stream, timeout);
+}
+
+/** CoE SDO write with streaming of the data, blocking.
+ *
+ * @param[in]     slave      = Slave number
+ * @param[in]     index      = Index to write
+ * @param[in]     subindex   = Subindex to write, must be 0 or 1 if CA is used.
+ * @param[in]     CA         = FALSE = single subindex. TRUE = Complete Access, all subindexes written.
+ * @param[in,out] stream     = stream with chunk callback and size
+ * @param[in]     timeout    = Timeout in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response
+ * @see ecx_SDOwrite_stream
+ */
+int ec_SDOwrite_stream(uint16 slave, uint16 index, uint8 subindex,
+                       boolean CA, ec_SDOstreamt *stream, int timeout)
+{
+   return ecx_SDOwrite_stream(&ecx_context, slave, index, subindex, CA, stream, timeout);
+}
 #endif
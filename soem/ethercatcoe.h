@@ -58,6 +58,150 @@ typedef struct
    char   Name[EC_MAXOELIST][EC_MAXNAME+1];
 } ec_OElistt;
 
+/** max entries (subindexes) in object dictionary cache */
+#define EC_MAXODCENTRY 4096
+/** size of name pool of object dictionary cache */
+#define EC_ODCNAMESIZE 0x10000
+/** magic of object dictionary cache image, "ODC1" */
+#define EC_ODCMAGIC    0x3143444f
+
+/** Object in object dictionary cache */
+typedef struct
+{
+   /** index */
+   uint16  index;
+   /** datatype, see EtherCAT specification */
+   uint16  datatype;
+   /** object code, see EtherCAT specification */
+   uint8   objectcode;
+   /** highest subindex */
+   uint8   maxsub;
+   /** first entry of object in entry list */
+   uint16  firstentry;
+   /** number of entries of object */
+   uint16  nentry;
+   /** offset of name in name pool */
+   uint32  name;
+} ec_ODCobjectt;
+
+/** Object entry (subindex) in object dictionary cache */
+typedef struct
+{
+   /** subindex */
+   uint8   subindex;
+   /** value info, see EtherCAT specification */
+   uint8   valueinfo;
+   /** datatype, see EtherCAT specification */
+   uint16  datatype;
+   /** bit length */
+   uint16  bitlength;
+   /** object access bits, see EtherCAT specification */
+   uint16  objaccess;
+   /** offset of name in name pool */
+   uint32  name;
+} ec_ODCentryt;
+
+/** Object dictionary of one device type, identified by vendor, product
+ * and revision. Objects are sorted by index.
+ */
+typedef struct
+{
+   /** TRUE if cache is filled */
+   boolean        valid;
+   /** manufacturer from EEprom */
+   uint32         eep_man;
+   /** ID from EEprom */
+   uint32         eep_id;
+   /** revision from EEprom */
+   uint32         eep_rev;
+   /** number of objects */
+   uint16         nobject;
+   /** number of entries */
+   uint16         nentry;
+   /** used bytes of name pool */
+   uint32         namesize;
+   /** objects */
+   ec_ODCobjectt  object[EC_MAXODLIST];
+   /** entries */
+   ec_ODCentryt   entry[EC_MAXODCENTRY];
+   /** name pool, zero terminated strings */
+   char           name[EC_ODCNAMESIZE];
+   /** internal, object description list while building */
+   ec_ODlistt     ODlist;
+   /** internal, object entry list while building */
+   ec_OElistt     OElist;
+} ec_ODcachet;
+
+typedef struct ec_SDObatch ec_SDObatcht;
+
+/** Entry of a SDO batch, see ecx_SDOread_batch() and ecx_SDOwrite_batch() */
+struct ec_SDObatch
+{
+   /** slave number */
+   uint16          slave;
+   /** index */
+   uint16          index;
+   /** subindex, must be 0 or 1 if CA is used */
+   uint8           subindex;
+   /** FALSE = single subindex. TRUE = Complete Access, all subindexes */
+   boolean         CA;
+   /** size in bytes of data buffer, on read returns size of data read */
+   int             size;
+   /** data buffer */
+   void            *data;
+   /** result, workcounter >0 is success, 0 = SDO abort or unexpected
+    * response, EC_TIMEOUT or EC_ERROR on mailbox failure */
+   int             wkc;
+   /** SDO abort code, 0 if not aborted */
+   int32           abortcode;
+   /** internal, entry is not finished */
+   boolean         busy;
+   /** internal, entry is already done by ecx_ODsnapshot(), result is kept */
+   boolean         skip;
+   /** internal, TRUE for SDO write */
+   boolean         write;
+   /** internal, segmented transfer running */
+   boolean         segmented;
+   /** internal, toggle bit of next segment */
+   uint8           toggle;
+   /** internal, bytes transferred */
+   int             done;
+   /** internal, timeout per mailbox transaction in us */
+   int             timeout;
+   /** internal, next entry of the same slave */
+   ec_SDObatcht    *next;
+   /** internal, mailbox transaction */
+   ec_mbxtranst    trans;
+   /** internal, request */
+   ec_mbxbuft      txmbx;
+   /** internal, response */
+   ec_mbxbuft      rxmbx;
+};
+
+typedef struct ec_SDOstream ec_SDOstreamt;
+
+/** Streaming SDO transfer, see ecx_SDOread_stream() and ecx_SDOwrite_stream().
+ * The mailbox buffers are reused for every segment, keep the stream
+ * allocated for repeated transfers.
+ */
+struct ec_SDOstream
+{
+   /** called per chunk. On read data points to the received chunk, return
+    * <0 to abort. On write fill length bytes at data and return length. */
+   int             (*chunk)(ecx_contextt *context, uint16 slave, ec_SDOstreamt *stream,
+                            uint8 *data, int length);
+   /** free for use by caller */
+   void            *userdata;
+   /** object size, returned on read and set by caller on write */
+   int32           size;
+   /** bytes transferred */
+   int32           done;
+   /** request mailbox */
+   ec_mbxbuft      txmbx;
+   /** response mailbox */
+   ec_mbxbuft      rxmbx;
+};
+
 #ifdef EC_VER1
 void ec_SDOerror(uint16 Slave, uint16 Index, uint8 SubIdx, int32 AbortCode);
 int ec_SDOread(uint16 slave, uint16 index, uint8 subindex,
@@ -72,6 +216,14 @@ int ec_readODlist(uint16 Slave, ec_ODlistt *pODlist);
 int ec_readODdescription(uint16 Item, ec_ODlistt *pODlist);
 int ec_readOEsingle(uint16 Item, uint8 SubI, ec_ODlistt *pODlist, ec_OElistt *pOElist);
 int ec_readOE(uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist);
+int ec_SDOread_batch(int n, ec_SDObatcht *list, int timeout);
+int ec_SDOwrite_batch(int n, ec_SDObatcht *list, int timeout);
+int ec_ODcache_build(uint16 slave, ec_ODcachet *cache);
+int ec_ODsnapshot(int n, ec_SDObatcht *list, int timeout);
+int ec_SDOread_stream(uint16 slave, uint16 index, uint8 subindex,
+                      boolean CA, ec_SDOstreamt *stream, int timeout);
+int ec_SDOwrite_stream(uint16 slave, uint16 index, uint8 subindex,
+                       boolean CA, ec_SDOstreamt *stream, int timeout);
 #endif
 
 void ecx_SDOerror(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubIdx, int32 AbortCode);
@@ -87,6 +239,19 @@ int ecx_readODlist(ecx_contextt *context, uint16 Slave, ec_ODlistt *pODlist);
 int ecx_readODdescription(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist);
 int ecx_readOEsingle(ecx_contextt *context, uint16 Item, uint8 SubI, ec_ODlistt *pODlist, ec_OElistt *pOElist);
 int ecx_readOE(ecx_contextt *context, uint16 Item, ec_ODlistt *pODlist, ec_OElistt *pOElist);
+int ecx_SDOread_batch(ecx_contextt *context, int n, ec_SDObatcht *list, int timeout);
+int ecx_SDOwrite_batch(ecx_contextt *context, int n, ec_SDObatcht *list, int timeout);
+int ecx_ODcache_build(ecx_contextt *context, uint16 slave, ec_ODcachet *cache);
+const ec_ODCobjectt *ec_ODcache_object(const ec_ODcachet *cache, uint16 index);
+const ec_ODCentryt *ec_ODcache_entry(const ec_ODcachet *cache, uint16 index, uint8 subindex);
+const char *ec_ODcache_name(const ec_ODcachet *cache, uint32 name);
+int ec_ODcache_save(const ec_ODcachet *cache, uint8 *image, int size);
+int ec_ODcache_load(ec_ODcachet *cache, const uint8 *image, int size);
+int ecx_ODsnapshot(ecx_contextt *context, int n, ec_SDObatcht *list, int timeout);
+int ecx_SDOread_stream(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                       boolean CA, ec_SDOstreamt *stream, int timeout);
+int ecx_SDOwrite_stream(ecx_contextt *context, uint16 slave, uint16 index, uint8 subindex,
+                        boolean CA, ec_SDOstreamt *stream, int timeout);
 
 #ifdef __cplusplus
 }
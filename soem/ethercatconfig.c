@@ -18,9 +18,11 @@
 #include "ethercattype.h"
 #include "ethercatbase.h"
 #include "ethercatmain.h"
+#include "ethercatmbx.h"
 #include "ethercatcoe.h"
 #include "ethercatsoe.h"
 #include "ethercatconfig.h"
+#include "ethercatprofile.h"
 
 
 typedef struct
@@ -36,6 +38,11 @@ ecx_mapt_t ecx_mapt[EC_MAX_MAPT];
 OSAL_THREAD_HANDLE ecx_threadh[EC_MAX_MAPT];
 #endif
 
+static ecx_mapt_t ecx_hookt[EC_MAX_HOOKT];
+#if EC_MAX_HOOKT > 1
+static OSAL_THREAD_HANDLE ecx_hookthreadh[EC_MAX_HOOKT];
+#endif
+
 #ifdef EC_VER1
 /** Slave configuration structure */
 typedef const struct
@@ -109,11 +116,19 @@ void ecx_init_context(ecx_contextt *context)
    memset(context->grouplist, 0x00, sizeof(ec_groupt) * context->maxgroup);
    /* clear slave eeprom cache, does not actually read any eeprom */
    ecx_siigetbyte(context, 0, EC_MAXEEPBUF);
+   ecx_siiinvalidate(context, 0);
    for(lp = 0; lp < context->maxgroup; lp++)
    {
       /* default start address per group entry */
       context->grouplist[lp].logstartaddr = lp << EC_LOGGROUPOFFSET;
    }
+   if (context->eni)
+   {
+      /* forget previous ENI image, init commands are not executed any more */
+      context->eni->image = NULL;
+      context->eni->size = 0;
+      context->eni->nslave = 0;
+   }
 }
 
 int ecx_detect_slaves(ecx_contextt *context)
@@ -121,7 +136,9 @@ int ecx_detect_slaves(ecx_contextt *context)
    uint8  b;
    uint16 w;
    int    wkc;
+   ec_profmarkt mark;
 
+   ecx_profile_start(context, &mark);
    /* make special pre-init register writes to enable MAC[1] local administered bit *
     * setting for old netX100 slaves */
    b = 0x00;
@@ -142,9 +159,10 @@ int ecx_detect_slaves(ecx_contextt *context)
       {
          EC_PRINT("Error: too many slaves on network: num_slaves=%d, max_slaves=%d\n",
                wkc, context->maxslave);
-         return EC_SLAVECOUNTEXCEEDED;
+         wkc = EC_SLAVECOUNTEXCEEDED;
       }
    }
+   ecx_profile_stop(context, EC_PROF_DETECT, 0, &mark);
    return wkc;
 }
 
@@ -299,6 +317,55 @@ static int ecx_lookup_prev_sii(ecx_contextt *context, uint16 slave)
    return 0;
 }
 
+/* Put SII word pair read during slave enumeration in SII cache,
+ * so later SII accesses of the slave do not read it again.
+ */
+static void ecx_config_siiput(ecx_contextt *context, uint16 slave, uint16 eeproma, uint32 eedat)
+{
+   uint8 bdat[4];
+
+   put_unaligned32(eedat, &bdat[0]);
+   ecx_siicache_put(context, slave, (uint16)(eeproma << 1), &bdat[0], 4);
+}
+
+/* Assign configured station address to slave at auto increment position
+ * and read interface type, alias and eeprom capabilities.
+ */
+static void ecx_config_address(ecx_contextt *context, uint16 slave)
+{
+   uint16 ADPh, configadr, estat;
+   int16 aliasadr;
+   uint16 val16;
+   uint8 b;
+
+   ADPh = (uint16)(1 - slave);
+   val16 = ecx_APRDw(context->port, ADPh, ECT_REG_PDICTL, EC_TIMEOUTRET3); /* read interface type of slave */
+   context->slavelist[slave].Itype = etohs(val16);
+   /* a node offset is used to improve readability of network frames */
+   /* this has no impact on the number of addressable slaves (auto wrap around) */
+   ecx_APWRw(context->port, ADPh, ECT_REG_STADR, htoes(slave + EC_NODEOFFSET) , EC_TIMEOUTRET3); /* set node address of slave */
+   if (slave == 1)
+   {
+      b = 1; /* kill non ecat frames for first slave */
+   }
+   else
+   {
+      b = 0; /* pass all frames for following slaves */
+   }
+   ecx_APWRw(context->port, ADPh, ECT_REG_DLCTL, htoes(b), EC_TIMEOUTRET3); /* set non ecat frame behaviour */
+   configadr = ecx_APRDw(context->port, ADPh, ECT_REG_STADR, EC_TIMEOUTRET3);
+   configadr = etohs(configadr);
+   context->slavelist[slave].configadr = configadr;
+   ecx_FPRD(context->port, configadr, ECT_REG_ALIAS, sizeof(aliasadr), &aliasadr, EC_TIMEOUTRET3);
+   context->slavelist[slave].aliasadr = etohs(aliasadr);
+   ecx_FPRD(context->port, configadr, ECT_REG_EEPSTAT, sizeof(estat), &estat, EC_TIMEOUTRET3);
+   estat = etohs(estat);
+   if (estat & EC_ESTAT_R64) /* check if slave can read 8 byte chunks */
+   {
+      context->slavelist[slave].eep_8byte = 1;
+   }
+}
+
 /** Enumerate and init all slaves.
  *
  * @param[in] context      = context struct
@@ -307,72 +374,53 @@ static int ecx_lookup_prev_sii(ecx_contextt *context, uint16 slave)
  */
 int ecx_config_init(ecx_contextt *context, uint8 usetable)
 {
-   uint16 slave, ADPh, configadr, ssigen;
-   uint16 topology, estat;
-   int16 topoc, slavec, aliasadr;
+   uint16 slave, configadr, ssigen;
+   uint16 topology;
+   int16 topoc, slavec;
    uint8 b,h;
    uint8 SMc;
    uint32 eedat;
    int wkc, cindex, nSM;
    uint16 val16;
+   ec_profmarkt mark, slavemark;
 
    EC_PRINT("ec_config_init %d\n",usetable);
    ecx_init_context(context);
+   ecx_profile_start(context, &mark);
    wkc = ecx_detect_slaves(context);
    if (wkc > 0)
    {
       ecx_set_slaves_to_default(context);
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         ADPh = (uint16)(1 - slave);
-         val16 = ecx_APRDw(context->port, ADPh, ECT_REG_PDICTL, EC_TIMEOUTRET3); /* read interface type of slave */
-         context->slavelist[slave].Itype = etohs(val16);
-         /* a node offset is used to improve readability of network frames */
-         /* this has no impact on the number of addressable slaves (auto wrap around) */
-         ecx_APWRw(context->port, ADPh, ECT_REG_STADR, htoes(slave + EC_NODEOFFSET) , EC_TIMEOUTRET3); /* set node address of slave */
-         if (slave == 1)
-         {
-            b = 1; /* kill non ecat frames for first slave */
-         }
-         else
-         {
-            b = 0; /* pass all frames for following slaves */
-         }
-         ecx_APWRw(context->port, ADPh, ECT_REG_DLCTL, htoes(b), EC_TIMEOUTRET3); /* set non ecat frame behaviour */
-         configadr = ecx_APRDw(context->port, ADPh, ECT_REG_STADR, EC_TIMEOUTRET3);
-         configadr = etohs(configadr);
-         context->slavelist[slave].configadr = configadr;
-         ecx_FPRD(context->port, configadr, ECT_REG_ALIAS, sizeof(aliasadr), &aliasadr, EC_TIMEOUTRET3);
-         context->slavelist[slave].aliasadr = etohs(aliasadr);
-         ecx_FPRD(context->port, configadr, ECT_REG_EEPSTAT, sizeof(estat), &estat, EC_TIMEOUTRET3);
-         estat = etohs(estat);
-         if (estat & EC_ESTAT_R64) /* check if slave can read 8 byte chunks */
-         {
-            context->slavelist[slave].eep_8byte = 1;
-         }
+         ecx_config_address(context, slave);
          ecx_readeeprom1(context, slave, ECT_SII_MANUF); /* Manuf */
       }
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
          eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* Manuf */
+         ecx_config_siiput(context, slave, ECT_SII_MANUF, eedat);
          context->slavelist[slave].eep_man = etohl(eedat);
          ecx_readeeprom1(context, slave, ECT_SII_ID); /* ID */
       }
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
          eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* ID */
+         ecx_config_siiput(context, slave, ECT_SII_ID, eedat);
          context->slavelist[slave].eep_id = etohl(eedat);
          ecx_readeeprom1(context, slave, ECT_SII_REV); /* revision */
       }
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
          eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* revision */
+         ecx_config_siiput(context, slave, ECT_SII_REV, eedat);
          context->slavelist[slave].eep_rev = etohl(eedat);
          ecx_readeeprom1(context, slave, ECT_SII_RXMBXADR); /* write mailbox address + mailboxsize */
       }
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
          eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* write mailbox address and mailboxsize */
+         ecx_config_siiput(context, slave, ECT_SII_RXMBXADR, eedat);
          context->slavelist[slave].mbx_wo = (uint16)LO_WORD(etohl(eedat));
          context->slavelist[slave].mbx_l = (uint16)HI_WORD(etohl(eedat));
          if (context->slavelist[slave].mbx_l > 0)
@@ -382,9 +430,11 @@ int ecx_config_init(ecx_contextt *context, uint8 usetable)
       }
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
+         ecx_profile_start(context, &slavemark);
          if (context->slavelist[slave].mbx_l > 0)
          {
             eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* read mailbox offset */
+            ecx_config_siiput(context, slave, ECT_SII_TXMBXADR, eedat);
             context->slavelist[slave].mbx_ro = (uint16)LO_WORD(etohl(eedat)); /* read mailbox offset */
             context->slavelist[slave].mbx_rl = (uint16)HI_WORD(etohl(eedat)); /*read mailbox length */
             if (context->slavelist[slave].mbx_rl == 0)
@@ -484,6 +534,7 @@ int ecx_config_init(ecx_contextt *context, uint8 usetable)
             context->slavelist[slave].SM[1].SMlength = htoes(context->slavelist[slave].mbx_rl);
             context->slavelist[slave].SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
             eedat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP);
+            ecx_config_siiput(context, slave, ECT_SII_MBXPROTO, eedat);
             context->slavelist[slave].mbx_proto = (uint16)etohl(eedat);
          }
          cindex = 0;
@@ -599,8 +650,10 @@ int ecx_config_init(ecx_contextt *context, uint8 usetable)
                htoes(EC_STATE_PRE_OP | EC_STATE_ACK),
                EC_TIMEOUTRET3); /* set preop status */
          }
+         ecx_profile_stop(context, EC_PROF_SLAVEINIT, slave, &slavemark);
       }
    }
+   ecx_profile_stop(context, EC_PROF_CONFIGINIT, 0, &mark);
    return wkc;
 }
 
@@ -638,16 +691,43 @@ static int ecx_lookup_mapping(ecx_contextt *context, uint16 slave, uint32 *Osize
    return 0;
 }
 
-static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
+/* Collect slaves of a group in a list.
+ * Group 0 collects all slaves. Returns number of slaves in list.
+ */
+static int ecx_config_slavelist(ecx_contextt *context, uint8 group, uint16 *slavelst, int maxn)
 {
-   uint32 Isize, Osize;
-   int rval;
+   uint16 slave;
+   int n;
+
+   n = 0;
+   for (slave = 1; (slave <= *(context->slavecount)) && (n < maxn); slave++)
+   {
+      if (!group || (group == context->slavelist[slave].group))
+      {
+         slavelst[n++] = slave;
+      }
+   }
+   return n;
+}
 
-   ecx_statecheck(context, slave, EC_STATE_PRE_OP, EC_TIMEOUTSTATE); /* check state change pre-op */
+static int ecx_eni_initcmds(ecx_contextt *context, uint16 slave);
 
-   EC_PRINT(" >Slave %d, configadr %x, state %2.2x\n",
-            slave, context->slavelist[slave].configadr, context->slavelist[slave].state);
+/* Check if slave has ENI init commands to execute in Pre-Op */
+static boolean ecx_eni_hasinitcmds(ecx_contextt *context, uint16 slave)
+{
+   ec_enit *eni;
+
+   eni = context->eni;
+   return (eni && eni->image && (slave <= eni->nslave) && eni->initcmd[slave]);
+}
 
+static void ecx_run_hooks(ecx_contextt *context, uint16 slave)
+{
+   /* ENI init commands first, application hooks can still override them */
+   if (ecx_eni_hasinitcmds(context, slave))
+   {
+      ecx_eni_initcmds(context, slave);
+   }
    /* execute special slave configuration hook Pre-Op to Safe-OP */
    if(context->slavelist[slave].PO2SOconfig) /* only if registered */
    {
@@ -657,8 +737,107 @@ static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
    {
       context->slavelist[slave].PO2SOconfigx(context, slave);
    }
+}
+
+#if EC_MAX_HOOKT > 1
+static OSAL_THREAD_FUNC ecx_hook_thread(void *param)
+{
+   ecx_mapt_t *hooktp;
+   hooktp = param;
+   ecx_run_hooks(hooktp->context, hooktp->slave);
+   hooktp->running = 0;
+}
+
+static int ecx_find_hookt(void)
+{
+   int p;
+   p = 0;
+   while((p < EC_MAX_HOOKT) && ecx_hookt[p].running)
+   {
+      p++;
+   }
+   if(p < EC_MAX_HOOKT)
+   {
+      return p;
+   }
+   else
+   {
+      return -1;
+   }
+}
+#endif
+
+static int ecx_get_hookthreadcount(void)
+{
+   int thrc, thrn;
+   thrc = 0;
+   for(thrn = 0 ; thrn < EC_MAX_HOOKT ; thrn++)
+   {
+      thrc += ecx_hookt[thrn].running;
+   }
+   return thrc;
+}
+
+/* Run PO2SO hooks of a list of slaves.
+ * Hooks of different slaves are independent, so with EC_MAX_HOOKT > 1 they
+ * run in parallel threads and their mailbox transfers overlap on the wire.
+ * Returns after all hooks are finished.
+ */
+static void ecx_config_hooks(ecx_contextt *context, int n, uint16 *slavelst)
+{
+   int lp, thrc;
+   uint16 slave;
+#if EC_MAX_HOOKT > 1
+   int thrn;
+#endif
+
+   for (lp = 0; lp < n; lp++)
+   {
+      slave = slavelst[lp];
+      if (context->slavelist[slave].PO2SOconfig || context->slavelist[slave].PO2SOconfigx ||
+          ecx_eni_hasinitcmds(context, slave))
+      {
+#if EC_MAX_HOOKT > 1
+         /* multi-threaded version */
+         while ((thrn = ecx_find_hookt()) < 0)
+         {
+            osal_usleep(1000);
+         }
+         ecx_hookt[thrn].context = context;
+         ecx_hookt[thrn].slave = slave;
+         ecx_hookt[thrn].thread_n = thrn;
+         ecx_hookt[thrn].running = 1;
+         osal_thread_create(&(ecx_hookthreadh[thrn]), 128000,
+            &ecx_hook_thread, &(ecx_hookt[thrn]));
+#else
+         /* serialised version */
+         ecx_run_hooks(context, slave);
+#endif
+      }
+   }
+   /* wait for all threads to finish */
+   do
+   {
+      thrc = ecx_get_hookthreadcount();
+      if (thrc)
+      {
+         osal_usleep(1000);
+      }
+   } while (thrc);
+}
+
+static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
+{
+   uint32 Isize, Osize;
+   int rval;
+   ec_profmarkt mark;
+
+   ecx_profile_start(context, &mark);
+   EC_PRINT(" >Slave %d, configadr %x, state %2.2x\n",
+            slave, context->slavelist[slave].configadr, context->slavelist[slave].state);
+
    /* if slave not found in configlist find IO mapping in slave self */
-   if (!context->slavelist[slave].configindex)
+   if (!context->slavelist[slave].configindex && !context->slavelist[slave].eniconfig)
    {
       Isize = 0;
       Osize = 0;
@@ -688,6 +867,7 @@ static int ecx_map_coe_soe(ecx_contextt *context, uint16 slave, int thread_n)
       context->slavelist[slave].Obits = (uint16)Osize;
       context->slavelist[slave].Ibits = (uint16)Isize;
    }
+   ecx_profile_stop(context, EC_PROF_MAPCOE, slave, &mark);
 
    return 1;
 }
@@ -697,7 +877,9 @@ static int ecx_map_sii(ecx_contextt *context, uint16 slave)
    uint32 Isize, Osize;
    int nSM;
    ec_eepromPDOt eepPDO;
+   ec_profmarkt mark;
 
+   ecx_profile_start(context, &mark);
    Osize = context->slavelist[slave].Obits;
    Isize = context->slavelist[slave].Ibits;
 
@@ -735,6 +917,7 @@ static int ecx_map_sii(ecx_contextt *context, uint16 slave)
    context->slavelist[slave].Ibits = (uint16)Isize;
    EC_PRINT("     ISIZE:%d %d OSIZE:%d\n",
       context->slavelist[slave].Ibits, Isize,context->slavelist[slave].Obits);
+   ecx_profile_stop(context, EC_PROF_MAPSII, slave, &mark);
 
    return 1;
 }
@@ -743,7 +926,9 @@ static int ecx_map_sm(ecx_contextt *context, uint16 slave)
 {
    uint16 configadr;
    int nSM;
+   ec_profmarkt mark;
 
+   ecx_profile_start(context, &mark);
    configadr = context->slavelist[slave].configadr;
 
    EC_PRINT("  SM programming\n");
@@ -798,6 +983,7 @@ static int ecx_map_sm(ecx_contextt *context, uint16 slave)
    {
       context->slavelist[slave].Obytes = (context->slavelist[slave].Obits + 7) / 8;
    }
+   ecx_profile_stop(context, EC_PROF_MAPSM, slave, &mark);
 
    return 1;
 }
@@ -841,15 +1027,21 @@ static int ecx_get_threadcount(void)
    return thrc;
 }
 
-static void ecx_config_find_mappings(ecx_contextt *context, uint8 group)
+static void ecx_config_find_mappings(ecx_contextt *context, uint8 group, int nslave, uint16 *slavelst)
 {
    int thrn, thrc;
    uint16 slave;
+   ec_profmarkt mark;
 
+   ecx_profile_start(context, &mark);
    for (thrn = 0; thrn < EC_MAX_MAPT; thrn++)
    {
       ecx_mapt[thrn].running = 0;
    }
+   /* check state change pre-op of all slaves in one batched poll */
+   ecx_statecheck_multi(context, nslave, slavelst, EC_STATE_PRE_OP, EC_TIMEOUTSTATE);
+   /* execute special slave configuration hooks Pre-Op to Safe-OP */
+   ecx_config_hooks(context, nslave, slavelst);
    /* find CoE and SoE mapping of slaves in multiple threads */
    for (slave = 1; slave <= *(context->slavecount); slave++)
    {
@@ -891,6 +1083,7 @@ static void ecx_config_find_mappings(ecx_contextt *context, uint8 group)
          ecx_map_sm(context, slave);
       }
    }
+   ecx_profile_stop(context, EC_PROF_MAPPING, 0, &mark);
 }
 
 static void ecx_config_create_input_mappings(ecx_contextt *context, void *pIOmap, 
@@ -1175,15 +1368,109 @@ static void ecx_config_create_output_mappings(ecx_contextt *context, void *pIOma
       context->grouplist[group].outputsWKC++;
 }
 
+/* Map SM1 mailbox full flag of slave as one bit in the IOmap */
+static void ecx_config_create_mbxstatus_mappings(ecx_contextt *context, void *pIOmap,
+   uint8 group, int16 slave, uint32 * LogAddr, uint8 * BitPos)
+{
+   uint16 configadr;
+   uint8 FMMUc;
+
+   EC_PRINT("  MBXSTATUS MAPPING\n");
+
+   configadr = context->slavelist[slave].configadr;
+   FMMUc = context->slavelist[slave].FMMUunused;
+   context->slavelist[slave].FMMU[FMMUc].LogStart = htoel(*LogAddr);
+   context->slavelist[slave].FMMU[FMMUc].LogLength = htoes(1);
+   context->slavelist[slave].FMMU[FMMUc].LogStartbit = *BitPos;
+   context->slavelist[slave].FMMU[FMMUc].LogEndbit = *BitPos;
+   context->slavelist[slave].FMMU[FMMUc].PhysStart = htoes(ECT_REG_SM1STAT);
+   context->slavelist[slave].FMMU[FMMUc].PhysStartBit = 3; /* mailbox full */
+   context->slavelist[slave].FMMU[FMMUc].FMMUtype = 1;
+   context->slavelist[slave].FMMU[FMMUc].FMMUactive = 1;
+   /* program FMMU for mailbox status */
+   ecx_FPWR(context->port, configadr, ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc),
+      sizeof(ec_fmmut), &(context->slavelist[slave].FMMU[FMMUc]), EC_TIMEOUTRET3);
+   if (group)
+   {
+      context->slavelist[slave].mbxstatus =
+         (uint8 *)(pIOmap) + *LogAddr - context->grouplist[group].logstartaddr;
+   }
+   else
+   {
+      context->slavelist[slave].mbxstatus = (uint8 *)(pIOmap) + *LogAddr;
+   }
+   context->slavelist[slave].mbxstatusbit = *BitPos;
+   EC_PRINT("    slave %d Mbxstatus %p bit %d\n",
+      slave,
+      context->slavelist[slave].mbxstatus,
+      context->slavelist[slave].mbxstatusbit);
+   context->slavelist[slave].FMMUunused = FMMUc + 1;
+   *BitPos += 1;
+   if (*BitPos > 7)
+   {
+      *LogAddr += 1;
+      *BitPos = 0;
+   }
+}
+
+/* Segment of a group that carries byte pos of the IOmap */
+static uint16 ecx_config_segment_of(ec_groupt *grp, uint32 pos)
+{
+   uint16 seg;
+   uint32 end;
+
+   end = 0;
+   for (seg = 0; seg < grp->nsegments; seg++)
+   {
+      end += grp->IOsegment[seg];
+      if (pos < end)
+      {
+         return seg;
+      }
+   }
+
+   return (grp->nsegments > 0) ? (grp->nsegments - 1) : 0;
+}
+
+/* Add the mapped mailbox status of slave to the input WKC. A slave adds
+ * one to the WKC of every datagram that reads from it, so the status only
+ * counts if the segment of the status bit carries none of its inputs.
+ */
+static void ecx_config_mbxstatus_wkc(ecx_contextt *context, void *pIOmap, uint8 group, uint16 slave)
+{
+   ec_groupt *grp;
+   ec_slavet *csl;
+   uint16 seg, iseg, ieseg;
+   uint32 ipos;
+
+   grp = &(context->grouplist[group]);
+   csl = &(context->slavelist[slave]);
+   seg = ecx_config_segment_of(grp, (uint32)(csl->mbxstatus - (uint8 *)pIOmap));
+   if (csl->Ibits)
+   {
+      ipos = (uint32)(csl->inputs - (uint8 *)pIOmap);
+      iseg = ecx_config_segment_of(grp, ipos);
+      ieseg = ecx_config_segment_of(grp, ipos + ((csl->Istartbit + csl->Ibits - 1) / 8));
+      if ((seg >= iseg) && (seg <= ieseg))
+      {
+         return;
+      }
+   }
+   grp->inputsWKC++;
+}
+
 static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8 group, boolean forceByteAlignment)
 {
-   uint16 slave, configadr;
+   uint16 slave;
    uint8 BitPos;
    uint32 LogAddr = 0;
    uint32 oLogAddr = 0;
    uint32 diff;
    uint16 currentsegment = 0;
    uint32 segmentsize = 0;
+   uint16 slavelst[EC_MAXSLAVE];
+   uint16 mbxlst[EC_MAXSLAVE];
+   int nslave, nmbx, lp;
 
    if ((*(context->slavecount) > 0) && (group < context->maxgroup))
    {
@@ -1194,15 +1481,14 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
       context->grouplist[group].nsegments = 0;
       context->grouplist[group].outputsWKC = 0;
       context->grouplist[group].inputsWKC = 0;
+      nslave = ecx_config_slavelist(context, group, slavelst, EC_MAXSLAVE);
 
       /* Find mappings and program syncmanagers */
-      ecx_config_find_mappings(context, group);
+      ecx_config_find_mappings(context, group, nslave, slavelst);
 
       /* do output mapping of slave and program FMMUs */
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         configadr = context->slavelist[slave].configadr;
-
          if (!group || (group == context->slavelist[slave].group))
          {
             /* create output mapping */
@@ -1272,7 +1558,6 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
       /* do input mapping of slave and program FMMUs */
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         configadr = context->slavelist[slave].configadr;
          if (!group || (group == context->slavelist[slave].group))
          {
             /* create input mapping */
@@ -1309,16 +1594,6 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
             }
 
             ecx_eeprom2pdi(context, slave); /* set Eeprom control to PDI */
-            /* User may override automatic state change */
-            if (context->manualstatechange == 0)
-            {
-               /* request safe_op for slave */
-               ecx_FPWRw(context->port,
-                  configadr,
-                  ECT_REG_ALCTL,
-                  htoes(EC_STATE_SAFE_OP),
-                  EC_TIMEOUTRET3); /* set safeop status */
-            }
             if (context->slavelist[slave].blockLRW)
             {
                context->grouplist[group].blockLRW++;
@@ -1326,6 +1601,47 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
             context->grouplist[group].Ebuscurrent += context->slavelist[slave].Ebuscurrent;
          }
       }
+      /* map SM1 status of mailbox slaves behind the inputs */
+      nmbx = 0;
+      if (context->grouplist[group].mbxstatusmap)
+      {
+         for (slave = 1; slave <= *(context->slavecount); slave++)
+         {
+            if ((!group || (group == context->slavelist[slave].group)) &&
+                (context->slavelist[slave].mbx_rl > 0) &&
+                (context->slavelist[slave].FMMUunused < EC_MAXFMMU))
+            {
+               ecx_config_create_mbxstatus_mappings(context, pIOmap, group, slave, &LogAddr, &BitPos);
+               mbxlst[nmbx++] = slave;
+
+               if (forceByteAlignment)
+               {
+                  /* Force byte alignment of the status bit */
+                  if (BitPos)
+                  {
+                     LogAddr++;
+                     BitPos = 0;
+                  }
+               }
+
+               diff = LogAddr - oLogAddr;
+               oLogAddr = LogAddr;
+               if ((segmentsize + diff) > (EC_MAXLRWDATA - EC_FIRSTDCDATAGRAM))
+               {
+                  context->grouplist[group].IOsegment[currentsegment] = segmentsize;
+                  if (currentsegment < (EC_MAXIOSEGMENTS - 1))
+                  {
+                     currentsegment++;
+                     segmentsize = diff;
+                  }
+               }
+               else
+               {
+                  segmentsize += diff;
+               }
+            }
+         }
+      }
       if (BitPos)
       {
          LogAddr++;
@@ -1345,8 +1661,19 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
             segmentsize += 1;
          }
       }
+      /* User may override automatic state change */
+      if (context->manualstatechange == 0)
+      {
+         /* request safe_op for all slaves of the group in batched frames */
+         ecx_writestate_multi(context, nslave, slavelst, EC_STATE_SAFE_OP, EC_TIMEOUTRET3);
+      }
       context->grouplist[group].IOsegment[currentsegment] = segmentsize;
       context->grouplist[group].nsegments = currentsegment + 1;
+      /* segments are final, credit mailbox status to the input WKC */
+      for (lp = 0; lp < nmbx; lp++)
+      {
+         ecx_config_mbxstatus_wkc(context, pIOmap, group, mbxlst[lp]);
+      }
       context->grouplist[group].inputs = (uint8 *)(pIOmap) + context->grouplist[group].Obytes;
       context->grouplist[group].Ibytes = LogAddr - 
          context->grouplist[group].logstartaddr - 
@@ -1369,7 +1696,8 @@ static int ecx_main_config_map_group(ecx_contextt *context, void *pIOmap, uint8
 
 /** Map all PDOs in one group of slaves to IOmap with Outputs/Inputs
 * in sequential order (legacy SOEM way).
-*
+* If mbxstatusmap of the group is set, the SM1 mailbox full flag of every
+* mailbox slave is mapped as one bit behind the inputs, see ecx_mbxstatus().
  *
  * @param[in]  context    = context struct
  * @param[out] pIOmap     = pointer to IOmap
@@ -1405,7 +1733,7 @@ int ecx_config_map_group_aligned(ecx_contextt *context, void *pIOmap, uint8 grou
  */
 int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 group)
 {
-   uint16 slave, configadr;
+   uint16 slave;
    uint8 BitPos;
    uint32 mLogAddr = 0;
    uint32 siLogAddr = 0;
@@ -1414,6 +1742,8 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
    uint32 diff;
    uint16 currentsegment = 0;
    uint32 segmentsize = 0;
+   uint16 slavelst[EC_MAXSLAVE];
+   int nslave;
 
    if ((*(context->slavecount) > 0) && (group < context->maxgroup))
    {
@@ -1425,14 +1755,14 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
       context->grouplist[group].nsegments = 0;
       context->grouplist[group].outputsWKC = 0;
       context->grouplist[group].inputsWKC = 0;
+      nslave = ecx_config_slavelist(context, group, slavelst, EC_MAXSLAVE);
 
       /* Find mappings and program syncmanagers */
-      ecx_config_find_mappings(context, group);
+      ecx_config_find_mappings(context, group, nslave, slavelst);
       
       /* do IO mapping of slave and program FMMUs */
       for (slave = 1; slave <= *(context->slavecount); slave++)
       {
-         configadr = context->slavelist[slave].configadr;
          siLogAddr = soLogAddr = mLogAddr;
 
          if (!group || (group == context->slavelist[slave].group))
@@ -1481,16 +1811,6 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
             }
 
             ecx_eeprom2pdi(context, slave); /* set Eeprom control to PDI */
-            /* User may override automatic state change */
-            if (context->manualstatechange == 0)
-            {
-               /* request safe_op for slave */
-               ecx_FPWRw(context->port,
-                  configadr,
-                  ECT_REG_ALCTL,
-                  htoes(EC_STATE_SAFE_OP),
-                  EC_TIMEOUTRET3);
-            }
             if (context->slavelist[slave].blockLRW)
             {
                context->grouplist[group].blockLRW++;
@@ -1500,6 +1820,13 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
          }
       }
 
+      /* User may override automatic state change */
+      if (context->manualstatechange == 0)
+      {
+         /* request safe_op for all slaves of the group in batched frames */
+         ecx_writestate_multi(context, nslave, slavelst, EC_STATE_SAFE_OP, EC_TIMEOUTRET3);
+      }
+
       context->grouplist[group].IOsegment[currentsegment] = segmentsize;
       context->grouplist[group].nsegments = currentsegment + 1;
       context->grouplist[group].Isegment = 0;
@@ -1639,15 +1966,8 @@ int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout)
       state = ecx_statecheck(context, slave, EC_STATE_PRE_OP, EC_TIMEOUTSTATE); /* check state change pre-op */
       if( state == EC_STATE_PRE_OP)
       {
-         /* execute special slave configuration hook Pre-Op to Safe-OP */
-         if(context->slavelist[slave].PO2SOconfig) /* only if registered */
-         {
-            context->slavelist[slave].PO2SOconfig(slave);
-         }
-         if (context->slavelist[slave].PO2SOconfigx) /* only if registered */
-         {
-            context->slavelist[slave].PO2SOconfigx(context, slave);
-         }         
+         /* execute ENI init commands and special slave configuration hook Pre-Op to Safe-OP */
+         ecx_run_hooks(context, slave);
          ecx_FPWRw(context->port, configadr, ECT_REG_ALCTL, htoes(EC_STATE_SAFE_OP) , timeout); /* set safeop status */
          state = ecx_statecheck(context, slave, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE); /* check state change safe-op */
          /* program configured FMMU */
@@ -1662,6 +1982,517 @@ int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout)
    return state;
 }
 
+/** Reconfigure a list of slaves together.
+ * Same sequence as ecx_reconfig_slave() but all slaves walk the states
+ * in parallel. AL control writes and state checks are batched in multi
+ * datagram frames. With EC_MAX_HOOKT > 1 the PO2SO hooks of all slaves
+ * run concurrently, by default they run one after the other.
+ * Slaves that fail a transition are dropped from the following steps.
+ *
+ * @param[in] context  = context struct
+ * @param[in] n        = number of slaves in slavelst
+ * @param[in] slavelst = list of slaves to reconfigure
+ * @param[in] timeout  = local timeout f.e. EC_TIMEOUTRET3, used for the SM, FMMU
+ * and AL control writes
+ * @return number of slaves that reached SAFE_OP
+ */
+int ecx_reconfig_slaves(ecx_contextt *context, int n, uint16 *slavelst, int timeout)
+{
+   uint16 sublst[EC_MAXSLAVE];
+   uint16 slave, configadr;
+   int lp, nsub, nSM, FMMUc;
+
+   if (n > EC_MAXSLAVE)
+   {
+      n = EC_MAXSLAVE;
+   }
+   if (ecx_writestate_multi(context, n, slavelst, EC_STATE_INIT, timeout) <= 0)
+   {
+      return 0;
+   }
+   for (lp = 0; lp < n; lp++)
+   {
+      ecx_eeprom2pdi(context, slavelst[lp]); /* set Eeprom control to PDI */
+   }
+   /* check state change init */
+   ecx_statecheck_multi(context, n, slavelst, EC_STATE_INIT, EC_TIMEOUTSTATE);
+   nsub = 0;
+   for (lp = 0; lp < n; lp++)
+   {
+      slave = slavelst[lp];
+      if ((context->slavelist[slave].state & 0x0f) == EC_STATE_INIT)
+      {
+         configadr = context->slavelist[slave].configadr;
+         /* program all enabled SM */
+         for( nSM = 0 ; nSM < EC_MAXSM ; nSM++ )
+         {
+            if (context->slavelist[slave].SM[nSM].StartAddr)
+            {
+               ecx_FPWR(context->port, configadr, (uint16)(ECT_REG_SM0 + (nSM * sizeof(ec_smt))),
+                  sizeof(ec_smt), &context->slavelist[slave].SM[nSM], timeout);
+            }
+         }
+         sublst[nsub++] = slave;
+      }
+   }
+   ecx_writestate_multi(context, nsub, sublst, EC_STATE_PRE_OP, timeout);
+   /* check state change pre-op */
+   ecx_statecheck_multi(context, nsub, sublst, EC_STATE_PRE_OP, EC_TIMEOUTSTATE);
+   n = nsub;
+   nsub = 0;
+   for (lp = 0; lp < n; lp++)
+   {
+      if ((context->slavelist[sublst[lp]].state & 0x0f) == EC_STATE_PRE_OP)
+      {
+         sublst[nsub++] = sublst[lp];
+      }
+   }
+   /* execute special slave configuration hooks Pre-Op to Safe-OP */
+   ecx_config_hooks(context, nsub, sublst);
+   ecx_writestate_multi(context, nsub, sublst, EC_STATE_SAFE_OP, timeout); /* set safeop status */
+   /* check state change safe-op */
+   n = ecx_statecheck_multi(context, nsub, sublst, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE);
+   for (lp = 0; lp < nsub; lp++)
+   {
+      slave = sublst[lp];
+      configadr = context->slavelist[slave].configadr;
+      /* program configured FMMU */
+      for( FMMUc = 0 ; FMMUc < context->slavelist[slave].FMMUunused ; FMMUc++ )
+      {
+         ecx_FPWR(context->port, configadr, (uint16)(ECT_REG_FMMU0 + (sizeof(ec_fmmut) * FMMUc)),
+            sizeof(ec_fmmut), &context->slavelist[slave].FMMU[FMMUc], timeout);
+      }
+   }
+
+   return n;
+}
+
+/** Switch the mailbox of a slave between the standard and the bootstrap
+ * mailbox. The bootstrap mailbox is read from SII and is often larger
+ * than the standard mailbox, mailbox protocols like FoE then use the
+ * larger size automatically. Call with the slave in INIT, before
+ * requesting BOOT state and after leaving it. A mailbox larger than
+ * EC_MAXMBX is refused, SM0 and SM1 must match the size the slave expects
+ * and a mailbox is only handed over when its last byte is accessed.
+ *
+ * @param[in] context  = context struct
+ * @param[in] slave    = slave number
+ * @param[in] boot     = TRUE = bootstrap mailbox, FALSE = standard mailbox
+ * @return 1 if mailbox is switched, 0 if slave has no such mailbox, the
+ * mailbox does not fit in EC_MAXMBX or the SM write is not acknowledged
+ */
+int ecx_config_bootmbx(ecx_contextt *context, uint16 slave, boolean boot)
+{
+   ec_slavet *csl;
+   uint32 rxmbx, txmbx;
+   uint16 wo, l, ro, rl;
+   int wkc;
+
+   if ((slave == 0) || (slave > *(context->slavecount)))
+   {
+      return 0;
+   }
+   csl = &(context->slavelist[slave]);
+   rxmbx = ecx_readeeprom(context, slave, boot ? ECT_SII_BOOTRXMBX : ECT_SII_RXMBXADR, EC_TIMEOUTEEP);
+   txmbx = ecx_readeeprom(context, slave, boot ? ECT_SII_BOOTTXMBX : ECT_SII_TXMBXADR, EC_TIMEOUTEEP);
+   wo = (uint16)LO_WORD(rxmbx);
+   l = (uint16)HI_WORD(rxmbx);
+   ro = (uint16)LO_WORD(txmbx);
+   rl = (uint16)HI_WORD(txmbx);
+   if ((wo == 0) || (l == 0) || (ro == 0))
+   {
+      return 0;
+   }
+   if (rl == 0)
+   {
+      rl = l;
+   }
+   if ((l > EC_MAXMBX) || (rl > EC_MAXMBX))
+   {
+      return 0;
+   }
+   csl->mbx_wo = wo;
+   csl->mbx_l = l;
+   csl->mbx_ro = ro;
+   csl->mbx_rl = rl;
+   csl->SM[0].StartAddr = htoes(wo);
+   csl->SM[0].SMlength = htoes(l);
+   csl->SM[1].StartAddr = htoes(ro);
+   csl->SM[1].SMlength = htoes(rl);
+   if (!csl->SM[0].SMflags)
+   {
+      csl->SM[0].SMflags = htoel(EC_DEFAULTMBXSM0);
+   }
+   if (!csl->SM[1].SMflags)
+   {
+      csl->SM[1].SMflags = htoel(EC_DEFAULTMBXSM1);
+   }
+   /* turnaround of bootloader differs from application */
+   memset(&(csl->mbxstat), 0x00, sizeof(csl->mbxstat));
+   csl->bootmbx = boot;
+   /* program SM0 mailbox in and SM1 mailbox out in one datagram */
+   wkc = ecx_FPWR(context->port, csl->configadr, ECT_REG_SM0, sizeof(ec_smt) * 2,
+      &(csl->SM[0]), EC_TIMEOUTRET3);
+   if (wkc <= 0)
+   {
+      return 0;
+   }
+
+   return 1;
+}
+
+/* Execute ENI init commands of slave in the Pre-Op to Safe-Op step,
+ * before the application hooks. Init commands are CoE downloads.
+ */
+static int ecx_eni_initcmds(ecx_contextt *context, uint16 slave)
+{
+   ec_enit *eni;
+   int pos, wkc;
+   uint32 ncmd, idx, sub, flags, size;
+
+   eni = context->eni;
+   if (!eni || !eni->image || (slave > eni->nslave) || !eni->initcmd[slave])
+   {
+      return 0;
+   }
+   pos = (int)eni->initcmd[slave];
+   if (!ec_image_get(eni->image, eni->size, &pos, 2, &ncmd))
+   {
+      return 0;
+   }
+   while (ncmd--)
+   {
+      if (!ec_image_get(eni->image, eni->size, &pos, 2, &idx) ||
+          !ec_image_get(eni->image, eni->size, &pos, 1, &sub) ||
+          !ec_image_get(eni->image, eni->size, &pos, 1, &flags) ||
+          !ec_image_get(eni->image, eni->size, &pos, 2, &size) ||
+          ((pos + (int)size) > eni->size))
+      {
+         return 0;
+      }
+      wkc = ecx_SDOwrite(context, slave, (uint16)idx, (uint8)sub, (boolean)(flags & 0x01),
+         (int)size, (void *)&eni->image[pos], EC_TIMEOUTRXM);
+      if (wkc <= 0)
+      {
+         EC_PRINT("ENI init command slave %d %4.4x:%2.2x failed\n", slave, idx, sub);
+         return 0;
+      }
+      pos += (int)size;
+   }
+   return 1;
+}
+
+/* Read one ENI slave record into slave structure.
+ * Returns 0 when record is truncated.
+ */
+static int ecx_eni_getslave(ecx_contextt *context, ec_enit *eni, uint16 slave, int *pos)
+{
+   ec_slavet *csl;
+   const uint8 *image;
+   uint32 v[25];
+   int lp, nSM, size;
+   uint32 ncmd, len;
+
+   csl = &(context->slavelist[slave]);
+   image = eni->image;
+   size = eni->size;
+   /* man id rev */
+   for (lp = 0; lp < 3; lp++)
+   {
+      if (!ec_image_get(image, size, pos, 4, &v[lp]))
+      {
+         return 0;
+      }
+   }
+   /* alias Itype Dtype Obits Ibits mbx_wo mbx_l mbx_ro mbx_rl mbx_proto */
+   for (lp = 3; lp < 13; lp++)
+   {
+      if (!ec_image_get(image, size, pos, 2, &v[lp]))
+      {
+         return 0;
+      }
+   }
+   /* CoE FoE EoE SoE hasdc ptype topology activeports */
+   for (lp = 13; lp < 21; lp++)
+   {
+      if (!ec_image_get(image, size, pos, 1, &v[lp]))
+      {
+         return 0;
+      }
+   }
+   /* parent blockLRW group Ebuscurrent */
+   if (!ec_image_get(image, size, pos, 2, &v[21]) ||
+       !ec_image_get(image, size, pos, 1, &v[22]) ||
+       !ec_image_get(image, size, pos, 1, &v[23]) ||
+       !ec_image_get(image, size, pos, 2, &v[24]))
+   {
+      return 0;
+   }
+   if ((csl->eep_man != v[0]) || (csl->eep_id != v[1]) || (csl->eep_rev != v[2]))
+   {
+      EC_PRINT("ENI slave %d mismatch M:%8.8x I:%8.8x R:%8.8x\n", slave,
+         (unsigned int)csl->eep_man, (unsigned int)csl->eep_id, (unsigned int)csl->eep_rev);
+      return 0;
+   }
+   if ((uint16)v[3] && (csl->aliasadr != (uint16)v[3]))
+   {
+      EC_PRINT("ENI slave %d alias mismatch %4.4x\n", slave, csl->aliasadr);
+      return 0;
+   }
+   csl->Dtype = (uint16)v[5];
+   csl->Obits = (uint16)v[6];
+   csl->Ibits = (uint16)v[7];
+   csl->mbx_wo = (uint16)v[8];
+   csl->mbx_l = (uint16)v[9];
+   csl->mbx_ro = (uint16)v[10];
+   csl->mbx_rl = (uint16)v[11];
+   csl->mbx_proto = (uint16)v[12];
+   csl->CoEdetails = (uint8)v[13];
+   csl->FoEdetails = (uint8)v[14];
+   csl->EoEdetails = (uint8)v[15];
+   csl->SoEdetails = (uint8)v[16];
+   csl->hasdc = (boolean)v[17];
+   csl->ptype = (uint8)v[18];
+   csl->topology = (uint8)v[19];
+   csl->activeports = (uint8)v[20];
+   csl->parent = (uint16)v[21];
+   if (v[22])
+   {
+      csl->blockLRW = 1;
+      context->slavelist[0].blockLRW++;
+   }
+   csl->group = (uint8)v[23];
+   csl->Ebuscurrent = (int16)v[24];
+   context->slavelist[0].Ebuscurrent += csl->Ebuscurrent;
+   for (nSM = 0; nSM < EC_MAXSM; nSM++)
+   {
+      if (!ec_image_get(image, size, pos, 2, &v[0]) ||
+          !ec_image_get(image, size, pos, 2, &v[1]) ||
+          !ec_image_get(image, size, pos, 4, &v[2]) ||
+          !ec_image_get(image, size, pos, 1, &v[3]))
+      {
+         return 0;
+      }
+      csl->SM[nSM].StartAddr = htoes((uint16)v[0]);
+      csl->SM[nSM].SMlength = htoes((uint16)v[1]);
+      csl->SM[nSM].SMflags = htoel(v[2]);
+      csl->SMtype[nSM] = (uint8)v[3];
+   }
+   for (lp = 0; lp < 5; lp++)
+   {
+      if (!ec_image_get(image, size, pos, 1, &v[lp]))
+      {
+         return 0;
+      }
+   }
+   csl->FMMU0func = (uint8)v[0];
+   csl->FMMU1func = (uint8)v[1];
+   csl->FMMU2func = (uint8)v[2];
+   csl->FMMU3func = (uint8)v[3];
+   len = v[4];
+   if ((*pos + (int)len) > size)
+   {
+      return 0;
+   }
+   lp = (len > EC_MAXNAME) ? EC_MAXNAME : (int)len;
+   memcpy(csl->name, &image[*pos], lp);
+   csl->name[lp] = 0;
+   *pos += (int)len;
+   /* init command list, only remember position and skip */
+   eni->initcmd[slave] = (uint32)*pos;
+   if (!ec_image_get(image, size, pos, 2, &ncmd))
+   {
+      return 0;
+   }
+   if (!ncmd)
+   {
+      eni->initcmd[slave] = 0;
+   }
+   while (ncmd--)
+   {
+      *pos += 4;
+      if (!ec_image_get(image, size, pos, 2, &len) || ((*pos + (int)len) > size))
+      {
+         return 0;
+      }
+      *pos += (int)len;
+   }
+   /* slave is configured by ENI, do not read mapping from slave */
+   csl->eniconfig = 1;
+   return 1;
+}
+
+/** Configure all slaves from an offline ENI image instead of scanning
+ * the SII of every slave. The network is only checked to match the
+ * ENI in slave count and identity, then station addresses, mailbox SM
+ * and PRE_OP are set as with ecx_config_init(). PDO mapping is taken
+ * from the ENI so ecx_config_map_group() does no CoE/SII mapping reads.
+ * Init commands in the ENI are executed in every Pre-Op to Safe-Op
+ * transition before the PO2SO hooks, the image must stay valid for that.
+ *
+ * @param[in] context  = context struct
+ * @param[in] image    = compact binary ENI image, see ec_enit
+ * @param[in] size     = size of image in bytes
+ * @return number of slaves configured, 0 if network does not match ENI
+ */
+int ecx_config_from_eni(ecx_contextt *context, const uint8 *image, int size)
+{
+   ec_enit *eni;
+   uint16 slave, configadr;
+   uint32 val;
+   int wkc, pos;
+   uint16 slavelst[EC_MAXSLAVE];
+   ec_profmarkt mark;
+
+   EC_PRINT("ec_config_from_eni %d\n", size);
+   ecx_init_context(context);
+   ecx_profile_start(context, &mark);
+   eni = context->eni;
+   if (!eni || !image)
+   {
+      return 0;
+   }
+   pos = 0;
+   if (!ec_image_get(image, size, &pos, 4, &val) || (val != EC_ENI_MAGIC) ||
+       !ec_image_get(image, size, &pos, 2, &val) || (val != EC_ENI_VERSION) ||
+       !ec_image_get(image, size, &pos, 2, &val))
+   {
+      EC_PRINT("ENI image invalid\n");
+      return 0;
+   }
+   wkc = ecx_detect_slaves(context);
+   if ((wkc <= 0) || (wkc != (int)val))
+   {
+      EC_PRINT("ENI slave count %d, network %d\n", (int)val, wkc);
+      return 0;
+   }
+   eni->image = image;
+   eni->size = size;
+   eni->nslave = (uint16)val;
+   ecx_set_slaves_to_default(context);
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      ecx_config_address(context, slave);
+      ecx_readeeprom1(context, slave, ECT_SII_MANUF); /* Manuf */
+   }
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      val = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* Manuf */
+      context->slavelist[slave].eep_man = etohl(val);
+      ecx_readeeprom1(context, slave, ECT_SII_ID); /* ID */
+   }
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      val = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* ID */
+      context->slavelist[slave].eep_id = etohl(val);
+      ecx_readeeprom1(context, slave, ECT_SII_REV); /* revision */
+   }
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      val = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP); /* revision */
+      context->slavelist[slave].eep_rev = etohl(val);
+   }
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      if (!ecx_eni_getslave(context, eni, slave, &pos))
+      {
+         EC_PRINT("ENI does not match slave %d\n", slave);
+         ecx_init_context(context);
+         return 0;
+      }
+   }
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      configadr = context->slavelist[slave].configadr;
+      if (context->slavelist[slave].mbx_l > 0)
+      {
+         /* program SM0 mailbox in and SM1 mailbox out for slave */
+         ecx_FPWR(context->port, configadr, ECT_REG_SM0, sizeof(ec_smt) * 2,
+            &(context->slavelist[slave].SM[0]), EC_TIMEOUTRET3);
+      }
+      /* some slaves need eeprom available to PDI in init->preop transition */
+      ecx_eeprom2pdi(context, slave);
+      slavelst[slave - 1] = slave;
+   }
+   /* User may override automatic state change */
+   if (context->manualstatechange == 0)
+   {
+      ecx_writestate_multi(context, *(context->slavecount), slavelst, EC_STATE_PRE_OP, EC_TIMEOUTRET3);
+   }
+   ecx_profile_stop(context, EC_PROF_CONFIGINIT, 0, &mark);
+   return *(context->slavecount);
+}
+
+/** Write the current slave configuration as compact binary ENI image.
+ * Use after ecx_config_init() and ecx_config_map_group() so the PDO
+ * mapping is included. The image contains no init commands.
+ *
+ * @param[in]  context  = context struct
+ * @param[out] image    = buffer for ENI image
+ * @param[in]  size     = size of buffer in bytes
+ * @return number of bytes written, 0 if buffer is too small
+ */
+int ecx_config_to_eni(ecx_contextt *context, uint8 *image, int size)
+{
+   ec_slavet *csl;
+   uint16 slave;
+   int pos, ok, nSM, len;
+
+   pos = 0;
+   ok = ec_image_put(image, size, &pos, 4, EC_ENI_MAGIC);
+   ok = ok && ec_image_put(image, size, &pos, 2, EC_ENI_VERSION);
+   ok = ok && ec_image_put(image, size, &pos, 2, *(context->slavecount));
+   for (slave = 1; ok && (slave <= *(context->slavecount)); slave++)
+   {
+      csl = &(context->slavelist[slave]);
+      ok = ec_image_put(image, size, &pos, 4, csl->eep_man);
+      ok = ok && ec_image_put(image, size, &pos, 4, csl->eep_id);
+      ok = ok && ec_image_put(image, size, &pos, 4, csl->eep_rev);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->aliasadr);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->Itype);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->Dtype);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->Obits);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->Ibits);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->mbx_wo);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->mbx_l);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->mbx_ro);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->mbx_rl);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->mbx_proto);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->CoEdetails);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->FoEdetails);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->EoEdetails);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->SoEdetails);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->hasdc);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->ptype);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->topology);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->activeports);
+      ok = ok && ec_image_put(image, size, &pos, 2, csl->parent);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->blockLRW);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->group);
+      ok = ok && ec_image_put(image, size, &pos, 2, (uint16)csl->Ebuscurrent);
+      for (nSM = 0; ok && (nSM < EC_MAXSM); nSM++)
+      {
+         ok = ec_image_put(image, size, &pos, 2, etohs(csl->SM[nSM].StartAddr));
+         ok = ok && ec_image_put(image, size, &pos, 2, etohs(csl->SM[nSM].SMlength));
+         ok = ok && ec_image_put(image, size, &pos, 4, etohl(csl->SM[nSM].SMflags));
+         ok = ok && ec_image_put(image, size, &pos, 1, csl->SMtype[nSM]);
+      }
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->FMMU0func);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->FMMU1func);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->FMMU2func);
+      ok = ok && ec_image_put(image, size, &pos, 1, csl->FMMU3func);
+      len = (int)strlen(csl->name);
+      ok = ok && ec_image_put(image, size, &pos, 1, (uint32)len) && ((pos + len) <= size);
+      if (ok)
+      {
+         memcpy(&image[pos], csl->name, len);
+         pos += len;
+      }
+      ok = ok && ec_image_put(image, size, &pos, 2, 0); /* no init commands */
+   }
+   return ok ? pos : 0;
+}
+
 #ifdef EC_VER1
 /** Enumerate and init all slaves.
  *
@@ -1803,4 +2634,55 @@ int ec_reconfig_slave(uint16 slave, int timeout)
 {
    return ecx_reconfig_slave(&ecx_context, slave, timeout);
 }
+
+/** Reconfigure a list of slaves together.
+ *
+ * @param[in] n        = number of slaves in slavelst
+ * @param[in] slavelst = list of slaves to reconfigure
+ * @param[in] timeout  = local timeout f.e. EC_TIMEOUTRET3, used for the SM, FMMU
+ * and AL control writes
+ * @return number of slaves that reached SAFE_OP
+ * @see ecx_reconfig_slaves
+ */
+int ec_reconfig_slaves(int n, uint16 *slavelst, int timeout)
+{
+   return ecx_reconfig_slaves(&ecx_context, n, slavelst, timeout);
+}
+
+/** Switch the mailbox of a slave between the standard and the bootstrap
+ * mailbox.
+ *
+ * @param[in] slave    = slave number
+ * @param[in] boot     = TRUE = bootstrap mailbox, FALSE = standard mailbox
+ * @return 1 if mailbox is switched, 0 if slave has no such mailbox
+ * @see ecx_config_bootmbx
+ */
+int ec_config_bootmbx(uint16 slave, boolean boot)
+{
+   return ecx_config_bootmbx(&ecx_context, slave, boot);
+}
+
+/** Configure all slaves from an offline ENI image.
+ *
+ * @param[in] image    = compact binary ENI image
+ * @param[in] size     = size of image in bytes
+ * @return number of slaves configured, 0 if network does not match ENI
+ * @see ecx_config_from_eni
+ */
+int ec_config_from_eni(const uint8 *image, int size)
+{
+   return ecx_config_from_eni(&ecx_context, image, size);
+}
+
+/** Write the current slave configuration as compact binary ENI image.
+ *
+ * @param[out] image    = buffer for ENI image
+ * @param[in]  size     = size of buffer in bytes
+ * @return number of bytes written, 0 if buffer is too small
+ * @see ecx_config_to_eni
+ */
+int ec_config_to_eni(uint8 *image, int size)
+{
+   return ecx_config_to_eni(&ecx_context, image, size);
+}
 #endif
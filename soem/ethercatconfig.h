@@ -19,6 +19,38 @@ extern "C"
 #define EC_NODEOFFSET      0x1000
 #define EC_TEMPNODE        0xffff
 
+/** compact binary ENI image magic, "ENIB" */
+#define EC_ENI_MAGIC       0x42494e45
+/** compact binary ENI image version */
+#define EC_ENI_VERSION     1
+
+/** Offline configuration from a compact binary ENI image.
+ *
+ * Image layout, all values little endian:
+ * header  : magic(u32) version(u16) slaves(u16)
+ * slave   : man(u32) id(u32) rev(u32) alias(u16) Itype(u16) Dtype(u16)
+ *           Obits(u16) Ibits(u16) mbx_wo(u16) mbx_l(u16) mbx_ro(u16) mbx_rl(u16)
+ *           mbx_proto(u16) CoE(u8) FoE(u8) EoE(u8) SoE(u8) hasdc(u8) ptype(u8)
+ *           topology(u8) activeports(u8) parent(u16) blockLRW(u8) group(u8)
+ *           Ebuscurrent(i16) EC_MAXSM x [StartAddr(u16) SMlength(u16) SMflags(u32)
+ *           SMtype(u8)] FMMU0func..FMMU3func(u8) namelength(u8) name
+ *           initcmds(u16)
+ * initcmd : index(u16) subindex(u8) flags(u8, bit0 = complete access)
+ *           size(u16) data
+ * Init commands are CoE downloads executed in the PRE_OP to SAFE_OP transition.
+ */
+struct ec_eni
+{
+   /** ENI image, must stay valid as long as init commands are used */
+   const uint8    *image;
+   /** size of ENI image in bytes */
+   int            size;
+   /** number of slaves in ENI image */
+   uint16         nslave;
+   /** offset of init command list per slave in image */
+   uint32         initcmd[EC_MAXSLAVE];
+};
+
 #ifdef EC_VER1
 int ec_config_init(uint8 usetable);
 int ec_config_map(void *pIOmap);
@@ -31,6 +63,10 @@ int ec_config(uint8 usetable, void *pIOmap);
 int ec_config_overlap(uint8 usetable, void *pIOmap);
 int ec_recover_slave(uint16 slave, int timeout);
 int ec_reconfig_slave(uint16 slave, int timeout);
+int ec_reconfig_slaves(int n, uint16 *slavelst, int timeout);
+int ec_config_bootmbx(uint16 slave, boolean boot);
+int ec_config_from_eni(const uint8 *image, int size);
+int ec_config_to_eni(uint8 *image, int size);
 #endif
 
 int ecx_config_init(ecx_contextt *context, uint8 usetable);
@@ -39,6 +75,10 @@ int ecx_config_overlap_map_group(ecx_contextt *context, void *pIOmap, uint8 grou
 int ecx_config_map_group_aligned(ecx_contextt *context, void *pIOmap, uint8 group);
 int ecx_recover_slave(ecx_contextt *context, uint16 slave, int timeout);
 int ecx_reconfig_slave(ecx_contextt *context, uint16 slave, int timeout);
+int ecx_reconfig_slaves(ecx_contextt *context, int n, uint16 *slavelst, int timeout);
+int ecx_config_bootmbx(ecx_contextt *context, uint16 slave, boolean boot);
+int ecx_config_from_eni(ecx_contextt *context, const uint8 *image, int size);
+int ecx_config_to_eni(ecx_contextt *context, uint8 *image, int size);
 
 #ifdef __cplusplus
 }
@@ -8,12 +8,14 @@
  * Distributed Clock EtherCAT functions.
  *
  */
+#include <string.h>
 #include "oshw.h"
 #include "osal.h"
 #include "ethercattype.h"
 #include "ethercatbase.h"
 #include "ethercatmain.h"
 #include "ethercatdc.h"
+#include "ethercatprofile.h"
 
 #define PORTM0 0x01
 #define PORTM1 0x02
@@ -23,6 +25,11 @@
 /** 1st sync pulse delay in ns here 100ms */
 #define SyncDelay       ((int32)100000000)
 
+/** DC slaves per datagram batch in ecx_configdc_avg() */
+#define EC_DCBATCH      32
+/** receive time registers read per slave, port 0..3 up to processing unit */
+#define EC_DCREGSIZE    (ECT_REG_DCSOF + sizeof(int64) - ECT_REG_DCTIME0)
+
 /**
  * Set DC of slave to fire sync0 at CyclTime interval with CyclShift offset.
  *
@@ -243,6 +250,122 @@ static uint8 ecx_parentport(ecx_contextt *context, uint16 parent)
    return parentport;
 }
 
+/* Latch receive times of all slaves and read them from the DC slaves in
+ * batches. Port times are summed relative to the earliest active port of
+ * each slave, the receive time of the processing unit and the master time
+ * of the latch are kept from the first sample.
+ */
+static void ecx_dclatch(ecx_contextt *context, uint16 ndc, const uint16 *dclist, boolean first,
+                        int32 *base, int32 (*portsum)[4], int64 *sof, uint64 *mastertime64)
+{
+   ec_dgramt dgram[EC_DCBATCH];
+   uint8 regs[EC_DCBATCH][EC_DCREGSIZE];
+   uint16 lp, cnt, n, i;
+   uint8 port;
+   int32 ht, tmin;
+   int32 t[4];
+   int64 hrt;
+   boolean found;
+   ec_timet mastertime;
+
+   ht = 0;
+   ecx_BWR(context->port, 0, ECT_REG_DCTIME0, sizeof(ht), &ht, EC_TIMEOUTRET);  /* latch DCrecvTimeA of all slaves */
+   if (first)
+   {
+      mastertime = osal_current_time();
+      mastertime.sec -= 946684800UL;  /* EtherCAT uses 2000-01-01 as epoch start instead of 1970-01-01 */
+      *mastertime64 = (((uint64)mastertime.sec * 1000000) + (uint64)mastertime.usec) * 1000;
+   }
+   for (lp = 0; lp < ndc; lp += n)
+   {
+      n = ndc - lp;
+      if (n > EC_DCBATCH)
+      {
+         n = EC_DCBATCH;
+      }
+      memset(regs, 0x00, sizeof(regs));
+      for (cnt = 0; cnt < n; cnt++)
+      {
+         dgram[cnt].cmd = EC_CMD_FPRD;
+         dgram[cnt].ADP = context->slavelist[dclist[lp + cnt]].configadr;
+         dgram[cnt].ADO = ECT_REG_DCTIME0;
+         dgram[cnt].length = EC_DCREGSIZE;
+         dgram[cnt].data = regs[cnt];
+      }
+      (void)ecx_dgrams(context->port, n, dgram, EC_TIMEOUTRET);
+      for (cnt = 0; cnt < n; cnt++)
+      {
+         i = dclist[lp + cnt];
+         tmin = 0;
+         found = FALSE;
+         for (port = 0; port < 4; port++)
+         {
+            memcpy(&ht, &regs[cnt][port * sizeof(int32)], sizeof(ht));
+            t[port] = etohl(ht);
+            if ((context->slavelist[i].activeports & (1 << port)) &&
+                (!found || (t[port] < tmin)))
+            {
+               tmin = t[port];
+               found = TRUE;
+            }
+         }
+         if (first)
+         {
+            /* 64bit latched DCrecvTimeA of each specific slave */
+            memcpy(&hrt, &regs[cnt][ECT_REG_DCSOF - ECT_REG_DCTIME0], sizeof(hrt));
+            sof[i] = etohll(hrt);
+            base[i] = tmin;
+         }
+         for (port = 0; port < 4; port++)
+         {
+            if (context->slavelist[i].activeports & (1 << port))
+            {
+               portsum[i][port] = (first ? 0 : portsum[i][port]) + (t[port] - tmin);
+            }
+            else if (first)
+            {
+               portsum[i][port] = t[port];
+            }
+         }
+      }
+   }
+}
+
+/* Write system time offsets and propagation delays of the DC slaves in batches. */
+static void ecx_dcwrite(ecx_contextt *context, uint16 ndc, const uint16 *dclist, int64 *offset, int32 *delay)
+{
+   ec_dgramt dgram[2 * EC_DCBATCH];
+   uint16 lp, cnt, n, i;
+   int ndgram;
+
+   for (lp = 0; lp < ndc; lp += n)
+   {
+      n = ndc - lp;
+      if (n > EC_DCBATCH)
+      {
+         n = EC_DCBATCH;
+      }
+      ndgram = 0;
+      for (cnt = 0; cnt < n; cnt++)
+      {
+         i = dclist[lp + cnt];
+         dgram[ndgram].cmd = EC_CMD_FPWR;
+         dgram[ndgram].ADP = context->slavelist[i].configadr;
+         dgram[ndgram].ADO = ECT_REG_DCSYSOFFSET;
+         dgram[ndgram].length = sizeof(int64);
+         dgram[ndgram].data = &offset[i];
+         ndgram++;
+         dgram[ndgram].cmd = EC_CMD_FPWR;
+         dgram[ndgram].ADP = context->slavelist[i].configadr;
+         dgram[ndgram].ADO = ECT_REG_DCSYSDELAY;
+         dgram[ndgram].length = sizeof(int32);
+         dgram[ndgram].data = &delay[i];
+         ndgram++;
+      }
+      (void)ecx_dgrams(context->port, ndgram, dgram, EC_TIMEOUTRET);
+   }
+}
+
 /**
  * Locate DC slaves, measure propagation delays.
  *
@@ -251,26 +374,60 @@ static uint8 ecx_parentport(ecx_contextt *context, uint16 parent)
  */
 boolean ecx_configdc(ecx_contextt *context)
 {
-   uint16 i, slaveh, parent, child;
+   return ecx_configdc_avg(context, 1);
+}
+
+/* Body of ecx_configdc_avg() on the given work area */
+static boolean ecx_configdc_work(ecx_contextt *context, int samples, ec_dcworkt *work)
+{
+   uint16 i, parent, child;
    uint16 parenthold = 0;
    uint16 prevDCslave = 0;
-   int32 ht, dt1, dt2, dt3;
-   int64 hrt;
+   uint16 ndc;
+   int32 dt1, dt2, dt3;
    uint8 entryport;
    int8 nlist;
    int8 plist[4];
    int32 tlist[4];
-   ec_timet mastertime;
+   int sample;
+   uint16 *dclist;
+   int32 *base;
+   int32 (*portsum)[4];
+   int64 *sof;
+   int32 *delay;
    uint64 mastertime64;
+   ec_profmarkt mark;
 
+   ecx_profile_start(context, &mark);
    context->slavelist[0].hasdc = FALSE;
    context->grouplist[0].hasdc = FALSE;
-   ht = 0;
+   if (samples < 1)
+   {
+      samples = 1;
+   }
+   if (samples > EC_DCMAXSAMPLES)
+   {
+      samples = EC_DCMAXSAMPLES;
+   }
 
-   ecx_BWR(context->port, 0, ECT_REG_DCTIME0, sizeof(ht), &ht, EC_TIMEOUTRET);  /* latch DCrecvTimeA of all slaves */
-   mastertime = osal_current_time();
-   mastertime.sec -= 946684800UL;  /* EtherCAT uses 2000-01-01 as epoch start instead of 1970-01-01 */
-   mastertime64 = (((uint64)mastertime.sec * 1000000) + (uint64)mastertime.usec) * 1000;
+   dclist = work->dclist;
+   base = work->base;
+   portsum = work->portsum;
+   sof = work->sof;
+   delay = work->delay;
+   ndc = 0;
+   for (i = 1; i <= *(context->slavecount); i++)
+   {
+      if (context->slavelist[i].hasdc)
+      {
+         dclist[ndc++] = i;
+      }
+   }
+   mastertime64 = 0;
+   for (sample = 0; sample < samples; sample++)
+   {
+      ecx_dclatch(context, ndc, dclist, (sample == 0), base, portsum, sof, &mastertime64);
+   }
    for (i = 1; i <= *(context->slavecount); i++)
    {
       context->slavelist[i].consumedports = context->slavelist[i].activeports;
@@ -292,21 +449,29 @@ boolean ecx_configdc(ecx_contextt *context)
          /* this branch has DC slave so remove parenthold */
          parenthold = 0;
          prevDCslave = i;
-         slaveh = context->slavelist[i].configadr;
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME0, sizeof(ht), &ht, EC_TIMEOUTRET);
-         context->slavelist[i].DCrtA = etohl(ht);
-         /* 64bit latched DCrecvTimeA of each specific slave */
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCSOF, sizeof(hrt), &hrt, EC_TIMEOUTRET);
-         /* use it as offset in order to set local time around 0 + mastertime */
-         hrt = htoell(-etohll(hrt) + mastertime64);
-         /* save it in the offset register */
-         (void)ecx_FPWR(context->port, slaveh, ECT_REG_DCSYSOFFSET, sizeof(hrt), &hrt, EC_TIMEOUTRET);
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME1, sizeof(ht), &ht, EC_TIMEOUTRET);
-         context->slavelist[i].DCrtB = etohl(ht);
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME2, sizeof(ht), &ht, EC_TIMEOUTRET);
-         context->slavelist[i].DCrtC = etohl(ht);
-         (void)ecx_FPRD(context->port, slaveh, ECT_REG_DCTIME3, sizeof(ht), &ht, EC_TIMEOUTRET);
-         context->slavelist[i].DCrtD = etohl(ht);
+         /* use latched time as offset in order to set local time around 0 + mastertime */
+         sof[i] = htoell(-sof[i] + (int64)mastertime64);
+         /* average port times of active ports */
+         context->slavelist[i].DCrtA = portsum[i][0];
+         context->slavelist[i].DCrtB = portsum[i][1];
+         context->slavelist[i].DCrtC = portsum[i][2];
+         context->slavelist[i].DCrtD = portsum[i][3];
+         if (context->slavelist[i].activeports & PORTM0)
+         {
+            context->slavelist[i].DCrtA = base[i] + portsum[i][0] / samples;
+         }
+         if (context->slavelist[i].activeports & PORTM1)
+         {
+            context->slavelist[i].DCrtB = base[i] + portsum[i][1] / samples;
+         }
+         if (context->slavelist[i].activeports & PORTM2)
+         {
+            context->slavelist[i].DCrtC = base[i] + portsum[i][2] / samples;
+         }
+         if (context->slavelist[i].activeports & PORTM3)
+         {
+            context->slavelist[i].DCrtD = base[i] + portsum[i][3] / samples;
+         }
 
          /* make list of active ports and their time stamps */
          nlist = 0;
@@ -403,10 +568,9 @@ boolean ecx_configdc(ecx_contextt *context)
             /* assumption : forward delay equals return delay */
             context->slavelist[i].pdelay = ((dt3 - dt1) / 2) + dt2 +
                context->slavelist[parent].pdelay;
-            ht = htoel(context->slavelist[i].pdelay);
-            /* write propagation delay*/
-            (void)ecx_FPWR(context->port, slaveh, ECT_REG_DCSYSDELAY, sizeof(ht), &ht, EC_TIMEOUTRET);
          }
+         /* propagation delay is written with the offsets */
+         delay[i] = htoel(context->slavelist[i].pdelay);
       }
       else
       {
@@ -426,11 +590,555 @@ boolean ecx_configdc(ecx_contextt *context)
          }
       }
    }
+   /* write system time offsets and propagation delays */
+   ecx_dcwrite(context, ndc, dclist, sof, delay);
+   ecx_profile_stop(context, EC_PROF_DC, 0, &mark);
 
    return context->slavelist[0].hasdc;
 }
 
+/* ecx_configdc_work() with work area on the stack, for contexts without dcwork */
+static boolean ecx_configdc_stack(ecx_contextt *context, int samples)
+{
+   ec_dcworkt work;
+
+   return ecx_configdc_work(context, samples, &work);
+}
+
+/**
+ * Locate DC slaves, measure propagation delays averaged over several
+ * latches of the port receive times. Register access of the DC slaves is
+ * batched in multi datagram frames.
+ *
+ * The work area is context->dcwork, or the stack of the caller if that is
+ * NULL, so masters on different threads can configure DC concurrently.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  samples        = number of port time latches, 1 .. EC_DCMAXSAMPLES
+ * @return boolean if slaves are found with DC
+ */
+boolean ecx_configdc_avg(ecx_contextt *context, int samples)
+{
+   if (context->dcwork)
+   {
+      return ecx_configdc_work(context, samples, context->dcwork);
+   }
+   return ecx_configdc_stack(context, samples);
+}
+
+/** Initialise master clock synchronisation with default gains.
+ *
+ * @param[out] sync        = synchronisation state
+ * @param[in]  cycletime   = cycle time in ns
+ * @param[in]  shift       = wanted DC time of the frame at the reference clock
+ *                           within the cycle in ns, f.e. 50000 = 50us after cycle start
+ * @param[in]  start       = first wakeup in local time in ns
+ */
+void ec_dcsync_init(ec_dcsynct *sync, int64 cycletime, int64 shift, int64 start)
+{
+   memset(sync, 0x00, sizeof(ec_dcsynct));
+   sync->cycletime = cycletime;
+   sync->shift = shift;
+   sync->kp = 100;
+   sync->ki = 5;
+   sync->lockwindow = 1000;
+   sync->wakeup = start;
+   sync->prevwakeup = start;
+}
+
+/* Update lock state and offset statistics */
+static void ec_dcsync_stats(ec_dcsynct *sync, int32 offset)
+{
+   int32 change;
+
+   change = offset - sync->offset;
+   if (change < 0)
+   {
+      change = -change;
+   }
+   /* moving average over about 16 cycles */
+   sync->jitter += (change - sync->jitter) / 16;
+   sync->offset = offset;
+   if ((offset <= sync->lockwindow) && (offset >= -sync->lockwindow))
+   {
+      if (!sync->locked && (++sync->lockcnt >= EC_DCSYNCLOCKCNT))
+      {
+         sync->locked = TRUE;
+         sync->offsetmin = offset;
+         sync->offsetmax = offset;
+      }
+   }
+   else if (!sync->locked || (offset > 2 * sync->lockwindow) || (offset < -2 * sync->lockwindow))
+   {
+      if (sync->locked)
+      {
+         sync->lockloss++;
+      }
+      sync->locked = FALSE;
+      sync->lockcnt = 0;
+   }
+   if (sync->locked)
+   {
+      if (offset < sync->offsetmin)
+      {
+         sync->offsetmin = offset;
+      }
+      if (offset > sync->offsetmax)
+      {
+         sync->offsetmax = offset;
+      }
+   }
+}
+
+/** Master clock synchronisation step, call once per cycle after the
+ * processdata is received.
+ *
+ * The DC time of the frame, read from the reference clock by the FRMW
+ * datagram, and the local send time of the same frame give the offset of
+ * the DC clock to the local clock. It is tracked by a PI controller on
+ * offset and drift, samples that jump by more than a quarter cycle while
+ * locked are ignored. The next wakeup is the local time that lets the
+ * frame sent after it reach the reference clock at the wanted shift in the
+ * DC cycle, the average time from wakeup to send is measured and taken
+ * into account. Without new DC time the wakeup advances by one cycle.
+ *
+ * @param[in]     context  = context struct
+ * @param[in,out] sync     = synchronisation state, see ec_dcsync_init()
+ * @param[in]     sendtime = local time in ns the received frame was sent
+ * @return next wakeup in local time in ns
+ */
+int64 ecx_dcsync_cycle(ecx_contextt *context, ec_dcsynct *sync, int64 sendtime)
+{
+   int64 dctime, measured, predicted, err, phase, next, wakeup;
+
+   dctime = *(context->DCtime);
+   /* no new DC time, frame lost or no DC */
+   if ((dctime == 0) || (dctime == sync->lastdctime) || (sync->cycletime <= 0))
+   {
+      sync->prevwakeup = sync->wakeup;
+      sync->wakeup += sync->cycletime;
+      return sync->wakeup;
+   }
+   sync->lastdctime = dctime;
+   measured = dctime - sendtime;
+   if (sync->cycles++ == 0)
+   {
+      sync->clockoffset = measured;
+      sync->drift = 0;
+   }
+   else
+   {
+      predicted = sync->clockoffset + sync->drift / 1000;
+      err = measured - predicted;
+      if (sync->locked && ((err > sync->cycletime / 4) || (err < -sync->cycletime / 4)))
+      {
+         sync->outliers++;
+         err = 0;
+      }
+      sync->clockoffset = predicted + (err * sync->kp) / 1000;
+      sync->drift += err * sync->ki;
+   }
+   /* position of frame in the DC cycle, -cycletime/2 .. cycletime/2 */
+   phase = (dctime - sync->shift) % sync->cycletime;
+   if (phase < 0)
+   {
+      phase += sync->cycletime;
+   }
+   if (phase > (sync->cycletime / 2))
+   {
+      phase -= sync->cycletime;
+   }
+   ec_dcsync_stats(sync, (int32)phase);
+   /* frame was sent after the latest wakeup before sendtime */
+   wakeup = (sendtime >= sync->wakeup) ? sync->wakeup : sync->prevwakeup;
+   if ((sendtime >= wakeup) && ((sendtime - wakeup) < sync->cycletime))
+   {
+      /* moving average over about 16 cycles */
+      sync->latency += (int32)((sendtime - wakeup) - sync->latency) / 16;
+   }
+   /* local wakeup for the wanted DC time of this frame, time from send
+    * to reference clock is part of clockoffset */
+   next = (dctime - phase) - (sync->clockoffset + sync->drift / 1000) - sync->latency;
+   /* first wanted DC time well after the last wakeup */
+   while (next <= (sync->wakeup + sync->cycletime / 2))
+   {
+      next += sync->cycletime;
+   }
+   sync->prevwakeup = sync->wakeup;
+   sync->wakeup = next;
+
+   return sync->wakeup;
+}
+
+/** Read the master clock.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  dcmaster       = master clock state
+ * @return master time in ns since 2000-01-01
+ */
+static int64 ecx_dcmaster_clock(ecx_contextt *context, ec_dcmastert *dcmaster)
+{
+   ec_timet now;
+
+   if (dcmaster->clock)
+   {
+      return dcmaster->clock(context);
+   }
+   now = osal_current_time();
+   now.sec -= 946684800UL;  /* EtherCAT uses 2000-01-01 as epoch start instead of 1970-01-01 */
+   return (((int64)now.sec * 1000000) + (int64)now.usec) * 1000;
+}
+
+/** Make the master clock the DC time base instead of the first DC slave.
+ * The system time of all DC slaves is moved to the master clock, then the
+ * reference slave gets burst writes of the master time for the initial drift
+ * compensation, the other DC slaves follow the reference slave in the same
+ * frames. From then on ecx_send_processdata() writes the master time to the
+ * reference slave in every frame, its time control loop compensates the
+ * drift to the master clock. Call after ecx_configdc() and before sync0 is
+ * activated. The first processdata segment must leave EC_FIRSTDCDATAGRAM
+ * bytes free in the frame for the extra write, see nospace.
+ *
+ * @param[in]  context        = context struct
+ * @param[out] dcmaster       = master clock state, must stay valid while in use
+ * @param[in]  clock          = master clock returning ns since 2000-01-01, f.e. CLOCK_MONOTONIC
+ *                              plus epoch offset or a PTP clock, NULL = osal_current_time()
+ * @param[in]  delay          = delay in ns from reading the master clock to the frame passing the reference slave
+ * @param[in]  burst          = number of writes for initial drift compensation, f.e. EC_DCMASTERBURST
+ * @return TRUE if master clock is time base, FALSE if no DC slave or a DC slave does not respond,
+ *         the system time offsets of the other DC slaves are then already shifted
+ */
+boolean ecx_dcmaster_init(ecx_contextt *context, ec_dcmastert *dcmaster, int64 (*clock)(ecx_contextt *context),
+                          int32 delay, int burst)
+{
+   uint16 slave, configadr;
+   uint8 idx;
+   int64 hrt, delta;
+   int wkc, cnt;
+   boolean failed;
+
+   context->dcmaster = NULL;
+   memset(dcmaster, 0x00, sizeof(ec_dcmastert));
+   dcmaster->clock = clock;
+   dcmaster->delay = delay;
+   if (!context->slavelist[0].hasdc)
+   {
+      return FALSE;
+   }
+   configadr = context->slavelist[context->slavelist[0].DCnext].configadr;
+   /* difference of master clock to system time of reference slave */
+   wkc = ecx_FPRD(context->port, configadr, ECT_REG_DCSYSTIME, sizeof(hrt), &hrt, EC_TIMEOUTRET);
+   if (wkc <= 0)
+   {
+      return FALSE;
+   }
+   delta = ecx_dcmaster_clock(context, dcmaster) - etohll(hrt);
+   /* shift system time offset of all DC slaves, keeps them aligned to each other */
+   failed = FALSE;
+   for (slave = 1; slave <= *(context->slavecount); slave++)
+   {
+      if (context->slavelist[slave].hasdc)
+      {
+         /* offset of a slave that can not be read is left as it is */
+         wkc = ecx_FPRD(context->port, context->slavelist[slave].configadr, ECT_REG_DCSYSOFFSET,
+                        sizeof(hrt), &hrt, EC_TIMEOUTRET);
+         if (wkc > 0)
+         {
+            hrt = htoell(etohll(hrt) + delta);
+            wkc = ecx_FPWR(context->port, context->slavelist[slave].configadr, ECT_REG_DCSYSOFFSET,
+                           sizeof(hrt), &hrt, EC_TIMEOUTRET);
+         }
+         if (wkc <= 0)
+         {
+            failed = TRUE;
+         }
+      }
+   }
+   if (failed)
+   {
+      return FALSE;
+   }
+   /* initial drift compensation, master time to reference slave and
+      reference slave time to all other DC slaves in one frame */
+   for (cnt = 0; cnt < burst; cnt++)
+   {
+      idx = ecx_getindex(context->port);
+      hrt = htoell(ecx_dcmaster_clock(context, dcmaster) + delay);
+      ecx_setupdatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPWR, idx,
+                        configadr, ECT_REG_DCSYSTIME, sizeof(hrt), &hrt);
+      hrt = 0;
+      (void)ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
+                            configadr, ECT_REG_DCSYSTIME, sizeof(hrt), &hrt);
+      wkc = ecx_srconfirm(context->port, idx, EC_TIMEOUTRET);
+      ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
+      if (wkc > 0)
+      {
+         dcmaster->writes++;
+      }
+   }
+   if (burst && !dcmaster->writes)
+   {
+      return FALSE;
+   }
+   context->dcmaster = dcmaster;
+
+   return TRUE;
+}
+
+/** Read the master clock that is the DC time base.
+ *
+ * @param[in]  context        = context struct
+ * @return master time in ns since 2000-01-01, 0 if the reference slave is the time base
+ */
+int64 ecx_dcmaster_time(ecx_contextt *context)
+{
+   if (!context->dcmaster)
+   {
+      return 0;
+   }
+   return ecx_dcmaster_clock(context, context->dcmaster);
+}
+
+/** Start the DC health monitor. Call after ecx_configdc(), samples are
+ * taken by ecx_send_processdata() and ecx_receive_processdata().
+ *
+ * @param[in]  context        = context struct
+ * @param[out] monitor        = monitor state, must stay valid while in use
+ * @param[in]  budget         = frame bytes per cycle, EC_DCMONSAMPLESIZE per sampled slave
+ * @param[in]  threshold      = deviation in ns that raises EC_DCMON_DEVIATION
+ * @param[in]  step           = change of deviation in ns that raises EC_DCMON_STEP, 0 = off
+ */
+void ecx_dcmonitor_init(ecx_contextt *context, ec_dcmonitort *monitor, int budget, int32 threshold, int32 step)
+{
+   memset(monitor, 0x00, sizeof(ec_dcmonitort));
+   monitor->budget = budget;
+   monitor->threshold = threshold;
+   monitor->step = step;
+   monitor->next = 1;
+   context->dcmonitor = monitor;
+}
+
+/** Clear statistics and alarms of the DC health monitor.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  slave          = slave number, 0 = all slaves
+ */
+void ecx_dcmonitor_clear(ecx_contextt *context, uint16 slave)
+{
+   ec_dcmonitort *mon;
+   uint16 i;
+
+   mon = context->dcmonitor;
+   if (!mon || (slave >= EC_MAXSLAVE))
+   {
+      return;
+   }
+   for (i = (slave ? slave : 1); (i < EC_MAXSLAVE) && (!slave || (i == slave)); i++)
+   {
+      if (mon->slave[i].alarm && mon->alarmslaves)
+      {
+         mon->alarmslaves--;
+      }
+      memset(&mon->slave[i], 0x00, sizeof(ec_dcmonslavet));
+   }
+}
+
+/** Append DC health monitor samples to a processdata frame, the next DC
+ * slaves in turn within the byte budget. For use by the processdata send
+ * functions, once per cycle.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  idx            = index of processdata frame
+ */
+void ecx_dcmonitor_append(ecx_contextt *context, uint8 idx)
+{
+   ec_dcmonitort *mon;
+   ecx_portt *port;
+   ec_comt *datagramP;
+   uint8 *frameP;
+   int last, budget;
+   uint16 slave, cnt;
+   int32 ht;
+
+   mon = context->dcmonitor;
+   if (!mon)
+   {
+      return;
+   }
+   /* samples of a frame that was not received are dropped */
+   mon->nsent = 0;
+   port = context->port;
+   frameP = (uint8 *)&(port->txbuf[idx]);
+   /* find header of last datagram in frame */
+   last = ETH_HEADERSIZE;
+   datagramP = (ec_comt *)&frameP[last];
+   while (etohs(datagramP->dlength) & EC_DATAGRAMFOLLOWS)
+   {
+      last += EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + (etohs(datagramP->dlength) & 0x07ff);
+      datagramP = (ec_comt *)&frameP[last];
+   }
+   ht = 0;
+   budget = mon->budget;
+   slave = mon->next;
+   for (cnt = 0; cnt < *(context->slavecount); cnt++)
+   {
+      if ((budget < (int)EC_DCMONSAMPLESIZE) || (mon->nsent >= EC_DCMONMAXSAMPLES) ||
+          ((port->txbuflength[idx] + (int)EC_DCMONSAMPLESIZE) > EC_MAXFRAMELENGTH))
+      {
+         break;
+      }
+      if ((slave == 0) || (slave > *(context->slavecount)) || (slave >= EC_MAXSLAVE))
+      {
+         slave = 1;
+      }
+      if (context->slavelist[slave].hasdc)
+      {
+         /* datagram follows the last one */
+         datagramP = (ec_comt *)&frameP[last];
+         datagramP->dlength = htoes(etohs(datagramP->dlength) | EC_DATAGRAMFOLLOWS);
+         mon->datapos[mon->nsent] = ecx_adddatagram(port, frameP, EC_CMD_FPRD, idx, FALSE,
+            context->slavelist[slave].configadr, ECT_REG_DCSYSDIFF, sizeof(ht), &ht);
+         last = mon->datapos[mon->nsent] + ETH_HEADERSIZE - EC_HEADERSIZE;
+         mon->sent[mon->nsent++] = slave;
+         budget -= (int)EC_DCMONSAMPLESIZE;
+      }
+      slave++;
+   }
+   mon->next = slave;
+   mon->idx = idx;
+}
+
+/* Raise alarms of a slave, new alarms are put in the error list. */
+static void ecx_dcmonitor_alarm(ecx_contextt *context, uint16 slave, uint8 alarm)
+{
+   ec_dcmonitort *mon;
+   ec_dcmonslavet *sl;
+   ec_errort Ec;
+
+   mon = context->dcmonitor;
+   sl = &mon->slave[slave];
+   alarm &= (uint8)~sl->alarm;
+   if (!alarm)
+   {
+      return;
+   }
+   if (!sl->alarm)
+   {
+      mon->alarmslaves++;
+   }
+   sl->alarm |= alarm;
+   sl->alarmcnt++;
+   memset(&Ec, 0, sizeof(Ec));
+   Ec.Time = osal_current_time();
+   Ec.Slave = slave;
+   Ec.Index = alarm;
+   Ec.SubIdx = 0;
+   *(context->ecaterror) = TRUE;
+   Ec.Etype = EC_ERR_TYPE_DC_ALARM;
+   Ec.AbortCode = sl->deviation;
+   ecx_pusherror(context, &Ec);
+}
+
+/** Update the DC health of the slaves sampled in a received processdata
+ * frame. For use by the processdata receive functions before the frame
+ * buffer is released.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  idx            = index of processdata frame
+ * @param[in]  wkc            = result of frame receive, EC_NOFRAME if lost
+ */
+void ecx_dcmonitor_receive(ecx_contextt *context, uint8 idx, int wkc)
+{
+   ec_dcmonitort *mon;
+   ec_dcmonslavet *sl;
+   uint8 *rxframe;
+   uint16 le_wkc;
+   uint32 diff;
+   int32 deviation, change;
+   uint8 alarm;
+   int lp;
+
+   mon = context->dcmonitor;
+   if (!mon || !mon->nsent || (mon->idx != idx))
+   {
+      return;
+   }
+   if (wkc > EC_NOFRAME)
+   {
+      mon->cycles++;
+      rxframe = (uint8 *)&(context->port->rxbuf[idx]);
+      for (lp = 0; lp < mon->nsent; lp++)
+      {
+         sl = &mon->slave[mon->sent[lp]];
+         memcpy(&le_wkc, &rxframe[mon->datapos[lp] + sizeof(diff)], EC_WKCSIZE);
+         if (etohs(le_wkc) == 0)
+         {
+            sl->noresponse++;
+            ecx_dcmonitor_alarm(context, mon->sent[lp], EC_DCMON_NORESPONSE);
+            continue;
+         }
+         memcpy(&diff, &rxframe[mon->datapos[lp]], sizeof(diff));
+         diff = etohl(diff);
+         /* bit 31 set = local copy of system time is smaller than received system time */
+         deviation = (int32)(diff & 0x7fffffff);
+         if (diff & 0x80000000)
+         {
+            deviation = -deviation;
+         }
+         change = deviation - sl->deviation;
+         alarm = 0;
+         if (mon->step && sl->samples && ((change > mon->step) || (change < -mon->step)))
+         {
+            alarm |= EC_DCMON_STEP;
+         }
+         if ((deviation > mon->threshold) || (deviation < -mon->threshold))
+         {
+            alarm |= EC_DCMON_DEVIATION;
+         }
+         sl->deviation = deviation;
+         if (!sl->samples || (deviation < sl->min))
+         {
+            sl->min = deviation;
+         }
+         if (!sl->samples || (deviation > sl->max))
+         {
+            sl->max = deviation;
+         }
+         sl->samples++;
+         sl->sum += deviation;
+         sl->mean = (int32)(sl->sum / (int64)sl->samples);
+         ecx_dcmonitor_alarm(context, mon->sent[lp], alarm);
+      }
+   }
+   mon->nsent = 0;
+}
+
 #ifdef EC_VER1
+int64 ec_dcsync_cycle(ec_dcsynct *sync, int64 sendtime)
+{
+   return ecx_dcsync_cycle(&ecx_context, sync, sendtime);
+}
+
+boolean ec_dcmaster_init(ec_dcmastert *dcmaster, int64 (*clock)(ecx_contextt *context), int32 delay, int burst)
+{
+   return ecx_dcmaster_init(&ecx_context, dcmaster, clock, delay, burst);
+}
+
+int64 ec_dcmaster_time(void)
+{
+   return ecx_dcmaster_time(&ecx_context);
+}
+
+void ec_dcmonitor_init(ec_dcmonitort *monitor, int budget, int32 threshold, int32 step)
+{
+   ecx_dcmonitor_init(&ecx_context, monitor, budget, threshold, step);
+}
+
+void ec_dcmonitor_clear(uint16 slave)
+{
+   ecx_dcmonitor_clear(&ecx_context, slave);
+}
+
 void ec_dcsync0(uint16 slave, boolean act, uint32 CyclTime, int32 CyclShift)
 {
    ecx_dcsync0(&ecx_context, slave, act, CyclTime, CyclShift);
@@ -445,4 +1153,9 @@ boolean ec_configdc(void)
 {
    return ecx_configdc(&ecx_context);
 }
+
+boolean ec_configdc_avg(int samples)
+{
+   return ecx_configdc_avg(&ecx_context, samples);
+}
 #endif
@@ -16,15 +16,195 @@ extern "C"
 {
 #endif
 
+/** maximum number of port time latches averaged by ecx_configdc_avg() */
+#define EC_DCMAXSAMPLES   1000
+
+/** consecutive cycles inside lock window before DC sync is locked */
+#define EC_DCSYNCLOCKCNT  100
+
+/** Master clock synchronisation to the DC reference clock, see
+ * ecx_dcsync_cycle(). Local times are in ns of the clock the application
+ * sleeps on, f.e. CLOCK_MONOTONIC.
+ */
+typedef struct
+{
+   /** cycle time in ns */
+   int64          cycletime;
+   /** wanted DC time of the frame at the reference clock within the cycle, in ns */
+   int64          shift;
+   /** proportional gain of clock offset in 1/1000 */
+   int32          kp;
+   /** integral gain of clock drift in 1/1000 */
+   int32          ki;
+   /** offset in ns that counts as locked */
+   int32          lockwindow;
+   /** offset in ns of last frame from the wanted DC time, -cycletime/2 .. cycletime/2 */
+   int32          offset;
+   /** smallest offset since lock */
+   int32          offsetmin;
+   /** largest offset since lock */
+   int32          offsetmax;
+   /** average change of offset from cycle to cycle in ns */
+   int32          jitter;
+   /** TRUE when offset stayed in lock window for EC_DCSYNCLOCKCNT cycles */
+   boolean        locked;
+   /** number of times the lock was lost */
+   uint32         lockloss;
+   /** cycles with new DC time */
+   uint32         cycles;
+   /** samples ignored as outlier, f.e. delayed frames */
+   uint32         outliers;
+   /** estimated DC time minus local time in ns */
+   int64          clockoffset;
+   /** estimated drift of clockoffset in ns per cycle, scaled by 1000 */
+   int64          drift;
+   /** average time in ns from wakeup to send */
+   int32          latency;
+   /** next wakeup in local time */
+   int64          wakeup;
+   /** internal, wakeup before next wakeup */
+   int64          prevwakeup;
+   /** internal, DC time of last sample */
+   int64          lastdctime;
+   /** internal, cycles in lock window */
+   int32          lockcnt;
+} ec_dcsynct;
+
+/** default number of system time writes for the initial drift compensation */
+#define EC_DCMASTERBURST  15000
+
+/** Master clock as DC time base, see ecx_dcmaster_init(). Every processdata
+ * frame writes the master time to the system time of the reference slave,
+ * the time control loop of the reference slave then follows the master clock
+ * and all other DC slaves follow the reference slave as usual.
+ */
+struct ec_dcmaster
+{
+   /** master clock, returns ns since 2000-01-01, NULL = osal_current_time() */
+   int64          (*clock)(ecx_contextt *context);
+   /** delay in ns from reading the master clock to the frame passing the reference slave */
+   int32          delay;
+   /** master time written by last processdata frame */
+   int64          mastertime;
+   /** DC time returned by last processdata frame minus written master time and delay */
+   int64          deviation;
+   /** number of system time writes */
+   uint32         writes;
+   /** frames without system time write, first processdata segment leaves no room */
+   uint32         nospace;
+   /** internal, index of frame carrying the system time write */
+   uint8          idx;
+   /** internal, system time write of frame idx is not evaluated yet */
+   boolean        carried;
+};
+
+/** DC monitor alarm, deviation is larger than the alarm threshold */
+#define EC_DCMON_DEVIATION  0x01
+/** DC monitor alarm, deviation changed more than the step threshold, f.e. re-synchronisation */
+#define EC_DCMON_STEP       0x02
+/** DC monitor alarm, slave did not answer the sample */
+#define EC_DCMON_NORESPONSE 0x04
+
+/** maximum number of slaves sampled per cycle by the DC monitor */
+#define EC_DCMONMAXSAMPLES  64
+/** frame bytes of one DC monitor sample, FPRD of ECT_REG_DCSYSDIFF */
+#define EC_DCMONSAMPLESIZE  (EC_HEADERSIZE - EC_ELENGTHSIZE + sizeof(int32) + EC_WKCSIZE)
+
+/** DC health of one slave */
+typedef struct
+{
+   /** last deviation in ns, local copy of system time minus received system time */
+   int32          deviation;
+   /** smallest deviation since clear */
+   int32          min;
+   /** largest deviation since clear */
+   int32          max;
+   /** mean deviation since clear */
+   int32          mean;
+   /** number of samples since clear */
+   uint32         samples;
+   /** number of samples without answer since clear */
+   uint32         noresponse;
+   /** active alarms, see EC_DCMON_xxx, kept until ecx_dcmonitor_clear() */
+   uint8          alarm;
+   /** number of raised alarms since clear */
+   uint32         alarmcnt;
+   /** internal, sum of deviations since clear */
+   int64          sum;
+} ec_dcmonslavet;
+
+/** DC health monitor. Every processdata frame with the DC datagram carries
+ * FPRD of ECT_REG_DCSYSDIFF for the next DC slaves in turn, as many as fit
+ * in the byte budget. Raised alarms are also put in the error list.
+ */
+struct ec_dcmonitor
+{
+   /** frame bytes per cycle for samples, EC_DCMONSAMPLESIZE per slave */
+   int            budget;
+   /** deviation in ns that raises EC_DCMON_DEVIATION */
+   int32          threshold;
+   /** change of deviation in ns between samples that raises EC_DCMON_STEP, 0 = off */
+   int32          step;
+   /** number of frames with samples */
+   uint32         cycles;
+   /** slaves with active alarm */
+   uint16         alarmslaves;
+   /** internal, next slave to sample */
+   uint16         next;
+   /** internal, index of frame with samples */
+   uint8          idx;
+   /** internal, number of samples in frame */
+   int            nsent;
+   /** internal, sampled slaves */
+   uint16         sent[EC_DCMONMAXSAMPLES];
+   /** internal, offset of sample data in frame */
+   uint16         datapos[EC_DCMONMAXSAMPLES];
+   /** health per slave */
+   ec_dcmonslavet slave[EC_MAXSLAVE];
+};
+
+/** Per slave work area of ecx_configdc_avg(), kept off the stack by
+ * ecx_contextt.dcwork.
+ */
+struct ec_dcwork
+{
+   /** list of DC slaves */
+   uint16 dclist[EC_MAXSLAVE];
+   /** receive time of earliest active port in first latch */
+   int32  base[EC_MAXSLAVE];
+   /** port receive times summed over all latches */
+   int32  portsum[EC_MAXSLAVE][4];
+   /** latched receive time of processing unit, then system time offset */
+   int64  sof[EC_MAXSLAVE];
+   /** propagation delay to write */
+   int32  delay[EC_MAXSLAVE];
+};
+
 #ifdef EC_VER1
+int64 ec_dcsync_cycle(ec_dcsynct *sync, int64 sendtime);
+boolean ec_dcmaster_init(ec_dcmastert *dcmaster, int64 (*clock)(ecx_contextt *context), int32 delay, int burst);
+int64 ec_dcmaster_time(void);
+void ec_dcmonitor_init(ec_dcmonitort *monitor, int budget, int32 threshold, int32 step);
+void ec_dcmonitor_clear(uint16 slave);
 boolean ec_configdc();
+boolean ec_configdc_avg(int samples);
 void ec_dcsync0(uint16 slave, boolean act, uint32 CyclTime, int32 CyclShift);
 void ec_dcsync01(uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift);
 #endif
 
 boolean ecx_configdc(ecx_contextt *context);
+boolean ecx_configdc_avg(ecx_contextt *context, int samples);
 void ecx_dcsync0(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclTime, int32 CyclShift);
 void ecx_dcsync01(ecx_contextt *context, uint16 slave, boolean act, uint32 CyclTime0, uint32 CyclTime1, int32 CyclShift);
+void ec_dcsync_init(ec_dcsynct *sync, int64 cycletime, int64 shift, int64 start);
+int64 ecx_dcsync_cycle(ecx_contextt *context, ec_dcsynct *sync, int64 sendtime);
+boolean ecx_dcmaster_init(ecx_contextt *context, ec_dcmastert *dcmaster, int64 (*clock)(ecx_contextt *context),
+                          int32 delay, int burst);
+int64 ecx_dcmaster_time(ecx_contextt *context);
+void ecx_dcmonitor_init(ecx_contextt *context, ec_dcmonitort *monitor, int budget, int32 threshold, int32 step);
+void ecx_dcmonitor_clear(ecx_contextt *context, uint16 slave);
+void ecx_dcmonitor_append(ecx_contextt *context, uint8 idx);
+void ecx_dcmonitor_receive(ecx_contextt *context, uint8 idx, int wkc);
 
 #ifdef __cplusplus
 }
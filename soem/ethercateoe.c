@@ -632,3 +632,469 @@ int ecx_EOEreadfragment(
    }
    return wkc;
 }
+
+/** Initialise EoE reassembly context of a slave port.
+*
+* @param[out] rx    = reassembly context
+* @param[in]  slave = Slave number
+* @param[in]  port  = Port number on slave
+*/
+void ecx_EOErx_init(ec_EOErxt *rx, uint16 slave, uint8 port)
+{
+   int lp;
+
+   rx->slave = slave;
+   rx->port = port;
+   rx->frames = 0;
+   rx->errors = 0;
+   rx->dropped = 0;
+   rx->seq = 0;
+   for (lp = 0; lp < EC_EOERXFRAMES; lp++)
+   {
+      rx->frame[lp].state = EC_EOERX_FREE;
+   }
+}
+
+/* Frame buffer for first fragment of a frame. Reuses a buffer with the same
+ * frame number, else a free one, else evicts the oldest frame in assembly.
+ */
+static ec_EOErxframet *ecx_EOErx_newframe(ec_EOErxt *rx, uint8 frameno)
+{
+   ec_EOErxframet *frame, *freeframe, *oldest;
+   int lp;
+
+   freeframe = NULL;
+   oldest = NULL;
+   for (lp = 0; lp < EC_EOERXFRAMES; lp++)
+   {
+      frame = &(rx->frame[lp]);
+      if (frame->state == EC_EOERX_ASSEMBLING)
+      {
+         if (frame->frameno == frameno)
+         {
+            /* restart of a frame, previous fragments are lost */
+            rx->errors++;
+            return frame;
+         }
+         if (!oldest || ((int32)(frame->seq - oldest->seq) < 0))
+         {
+            oldest = frame;
+         }
+      }
+      else if ((frame->state == EC_EOERX_FREE) && !freeframe)
+      {
+         freeframe = frame;
+      }
+   }
+   if (freeframe)
+   {
+      return freeframe;
+   }
+   if (oldest)
+   {
+      rx->dropped++;
+   }
+   return oldest;
+}
+
+/** Add EoE fragment to reassembly context. The fragment is copied once into
+* the frame buffer with the same frame number, fragments of other frames are
+* not affected by a fragment out of sequence. A complete frame is handed out
+* in place and its buffer stays in use until ecx_EOErx_release().
+*
+* @param[in,out] rx    = reassembly context
+* @param[in]  MbxIn    = Received mailbox containing fragment data
+* @param[out] frame    = complete frame, valid if return > 0
+* @return 0= if fragment OK, >0 if frame is complete, <0 on error
+*/
+int ecx_EOErx_fragment(ec_EOErxt *rx, ec_mbxbuft *MbxIn, ec_EOErxframet **frame)
+{
+   uint16 frameinfo1, frameinfo2, eoedatasize;
+   uint8 frameno, fragmentno;
+   ec_EOErxframet *fp;
+   ec_EOEt *aEOEp;
+   int lp;
+
+   aEOEp = (ec_EOEt *)MbxIn;
+   if (((aEOEp->mbxheader.mbxtype & 0x0f) != ECT_MBXT_EOE) ||
+       (etohs(aEOEp->mbxheader.length) < 0x0004))
+   {
+      return -EC_ERR_TYPE_PACKET_ERROR;
+   }
+   eoedatasize = etohs(aEOEp->mbxheader.length) - 0x0004;
+   frameinfo1 = etohs(aEOEp->frameinfo1);
+   frameinfo2 = etohs(aEOEp->frameinfo2);
+   if ((EOE_HDR_FRAME_TYPE_GET(frameinfo1) != EOE_FRAG_DATA) ||
+       (EOE_HDR_FRAME_PORT_GET(frameinfo1) != rx->port))
+   {
+      return -EC_ERR_TYPE_PACKET_ERROR;
+   }
+   frameno = (uint8)EOE_HDR_FRAME_NO_GET(frameinfo2);
+   fragmentno = (uint8)EOE_HDR_FRAG_NO_GET(frameinfo2);
+   fp = NULL;
+   if (fragmentno == 0)
+   {
+      fp = ecx_EOErx_newframe(rx, frameno);
+      if (!fp)
+      {
+         /* all buffers are held by the consumer */
+         rx->dropped++;
+         return -EC_ERR_TYPE_EOE_INVALID_RX_DATA;
+      }
+      fp->state = EC_EOERX_ASSEMBLING;
+      fp->frameno = frameno;
+      fp->fragmentno = 0;
+      fp->size = (uint16)(EOE_HDR_FRAME_OFFSET_GET(frameinfo2) << 5);
+      fp->offset = 0;
+      fp->seq = rx->seq++;
+      fp->start = osal_current_time();
+   }
+   else
+   {
+      for (lp = 0; (lp < EC_EOERXFRAMES) && !fp; lp++)
+      {
+         if ((rx->frame[lp].state == EC_EOERX_ASSEMBLING) && (rx->frame[lp].frameno == frameno))
+         {
+            fp = &(rx->frame[lp]);
+         }
+      }
+      if (!fp)
+      {
+         rx->errors++;
+         return -EC_ERR_TYPE_EOE_INVALID_RX_DATA;
+      }
+   }
+   /* timestamp appended to last fragment is no frame data */
+   if (EOE_HDR_LAST_FRAGMENT_GET(frameinfo1) && EOE_HDR_TIME_APPEND_GET(frameinfo1) &&
+       (eoedatasize >= 4))
+   {
+      eoedatasize -= 4;
+   }
+   /* fragment must continue the frame and stay inside announced size */
+   if ((fragmentno != fp->fragmentno) ||
+       ((fragmentno > 0) && (fp->offset != (EOE_HDR_FRAME_OFFSET_GET(frameinfo2) << 5))) ||
+       ((fp->offset + eoedatasize) > fp->size) ||
+       ((fp->offset + eoedatasize) > EC_EOEMAXFRAME))
+   {
+      fp->state = EC_EOERX_FREE;
+      rx->errors++;
+      return -EC_ERR_TYPE_EOE_INVALID_RX_DATA;
+   }
+   memcpy(&(fp->data[fp->offset]), aEOEp->data, eoedatasize);
+   fp->offset += eoedatasize;
+   fp->fragmentno++;
+   if (!EOE_HDR_LAST_FRAGMENT_GET(frameinfo1))
+   {
+      return 0;
+   }
+   fp->size = fp->offset;
+   fp->state = EC_EOERX_READY;
+   rx->frames++;
+   *frame = fp;
+
+   return 1;
+}
+
+/** Return frame handed out by ecx_EOErx_fragment() to the reassembly context.
+*
+* @param[in,out] rx = reassembly context
+* @param[in]  frame = frame to release
+*/
+void ecx_EOErx_release(ec_EOErxt *rx, ec_EOErxframet *frame)
+{
+   (void)rx;
+   frame->state = EC_EOERX_FREE;
+}
+
+/* Add latency sample to average and maximum */
+static void ecx_EOElatency(uint32 *avg, uint32 *max, uint32 time)
+{
+   /* moving average over about 8 frames */
+   *avg = (*avg) ? ((*avg * 7 + time) / 8) : time;
+   if (time > *max)
+   {
+      *max = time;
+   }
+}
+
+static void ecx_EOEswitch_txcomplete(ecx_contextt *context, ec_mbxtranst *trans);
+static void ecx_EOEswitch_rxcomplete(ecx_contextt *context, ec_mbxtranst *trans);
+
+/** Initialise EoE switch.
+*
+* @param[out] sw        = EoE switch
+* @param[in]  hostread  = get frame of host interface, must not block
+* @param[in]  hostwrite = pass frame to host interface
+* @param[in]  timeout   = timeout in us of a fragment write, standard is EC_TIMEOUTTXM
+*/
+void ecx_EOEswitch_init(ec_EOEswitcht *sw,
+   int (*hostread)(ecx_contextt *context, ec_EOEportt *port, uint8 *frame, int size),
+   void (*hostwrite)(ecx_contextt *context, ec_EOEportt *port, const uint8 *frame, int size),
+   int timeout)
+{
+   memset(sw, 0x00, sizeof(ec_EOEswitcht));
+   sw->hostread = hostread;
+   sw->hostwrite = hostwrite;
+   sw->timeout = timeout;
+}
+
+/** Add EoE port of a slave to the switch.
+*
+* @param[in]  context    = context struct
+* @param[in]  sw         = EoE switch
+* @param[in]  slave      = Slave number
+* @param[in]  port       = Port number on slave
+* @param[in]  hosthandle = handle of host interface, f.e. TAP file descriptor
+* @return pointer to switch port, NULL if slave has no EoE or switch is full
+*/
+ec_EOEportt *ecx_EOEswitch_add(ecx_contextt *context, ec_EOEswitcht *sw, uint16 slave,
+   uint8 port, int hosthandle)
+{
+   ec_EOEportt *eport;
+
+   if ((sw->nport >= EC_EOEMAXPORTS) || (slave == 0) || (slave > *(context->slavecount)) ||
+       !(context->slavelist[slave].mbx_proto & ECT_MBXPROT_EOE) ||
+       (context->slavelist[slave].mbx_l <= 0x0A))
+   {
+      return NULL;
+   }
+   eport = &(sw->port[sw->nport++]);
+   memset(eport, 0x00, sizeof(ec_EOEportt));
+   eport->slave = slave;
+   eport->port = port;
+   eport->hosthandle = hosthandle;
+   eport->sw = sw;
+   ecx_EOErx_init(&(eport->rx), slave, port);
+   eport->ratetime = osal_current_time();
+
+   return eport;
+}
+
+/* Find port of switch by slave and EoE port */
+static ec_EOEportt *ecx_EOEswitch_find(ec_EOEswitcht *sw, uint16 slave, int port)
+{
+   int lp;
+
+   for (lp = 0; lp < sw->nport; lp++)
+   {
+      if ((sw->port[lp].slave == slave) && (sw->port[lp].port == port))
+      {
+         return &(sw->port[lp]);
+      }
+   }
+   return NULL;
+}
+
+/* Build next fragment of frame in transmission and submit it */
+static void ecx_EOEswitch_fragment(ecx_contextt *context, ec_EOEportt *eport)
+{
+   ec_EOEt *EOEp;
+   uint16 frameinfo1, frameinfo2;
+   uint8 cnt;
+   int maxdata;
+
+   ec_clearmbx(&(eport->txmbx));
+   EOEp = (ec_EOEt *)&(eport->txmbx);
+   /* data section=mailbox size - 6 mbx - 4 EoEh */
+   maxdata = context->slavelist[eport->slave].mbx_l - 0x0A;
+   eport->txfragsize = eport->txsize - eport->txoffset;
+   frameinfo1 = EOE_HDR_FRAME_PORT_SET(eport->port);
+   if (eport->txfragsize > maxdata)
+   {
+      /* Adjust to even 32-octect blocks */
+      eport->txfragsize = ((maxdata >> 5) << 5);
+   }
+   else
+   {
+      frameinfo1 |= EOE_HDR_LAST_FRAGMENT_SET(1);
+   }
+   frameinfo2 = EOE_HDR_FRAG_NO_SET(eport->txfragmentno);
+   if (eport->txfragmentno > 0)
+   {
+      frameinfo2 |= EOE_HDR_FRAME_OFFSET_SET((eport->txoffset >> 5));
+   }
+   else
+   {
+      frameinfo2 |= EOE_HDR_FRAME_OFFSET_SET(((eport->txsize + 31) >> 5));
+   }
+   frameinfo2 |= EOE_HDR_FRAME_NO_SET(eport->txframeno);
+   cnt = ec_nextmbxcnt(context->slavelist[eport->slave].mbx_cnt);
+   context->slavelist[eport->slave].mbx_cnt = cnt;
+   EOEp->mbxheader.length = htoes((uint16)(4 + eport->txfragsize)); /* no timestamp */
+   EOEp->mbxheader.address = htoes(0x0000);
+   EOEp->mbxheader.priority = 0x00;
+   EOEp->mbxheader.mbxtype = ECT_MBXT_EOE + MBX_HDR_SET_CNT(cnt); /* EoE */
+   EOEp->frameinfo1 = htoes(frameinfo1);
+   EOEp->frameinfo2 = htoes(frameinfo2);
+   memcpy(EOEp->data, &(eport->txframe[eport->txoffset]), eport->txfragsize);
+   eport->txtrans.slave = eport->slave;
+   eport->txtrans.txmbx = &(eport->txmbx);
+   eport->txtrans.rxmbx = NULL;
+   eport->txtrans.timeout = eport->sw->timeout;
+   eport->txtrans.complete = ecx_EOEswitch_txcomplete;
+   eport->txtrans.userdata = eport;
+   if (!ecx_mbxsubmit(context, &(eport->txtrans)))
+   {
+      eport->txbusy = FALSE;
+      eport->txdrops++;
+   }
+}
+
+/* Fragment written, continue with next fragment or finish frame */
+static void ecx_EOEswitch_txcomplete(ecx_contextt *context, ec_mbxtranst *trans)
+{
+   ec_EOEportt *eport;
+
+   eport = (ec_EOEportt *)trans->userdata;
+   if (trans->state != EC_MBXTRANS_DONE)
+   {
+      eport->txbusy = FALSE;
+      eport->txdrops++;
+      return;
+   }
+   eport->txoffset += eport->txfragsize;
+   eport->txfragmentno++;
+   if (eport->txoffset < eport->txsize)
+   {
+      ecx_EOEswitch_fragment(context, eport);
+      return;
+   }
+   eport->txbusy = FALSE;
+   eport->txframes++;
+   eport->txbytes += eport->txsize;
+   ecx_EOElatency(&(eport->txlatency), &(eport->txlatencymax), ec_elapsed(&(eport->txtime)));
+}
+
+/* Mailbox poll finished, reassemble fragment read from slave */
+static void ecx_EOEswitch_rxcomplete(ecx_contextt *context, ec_mbxtranst *trans)
+{
+   ec_EOEportt *eport, *target;
+   ec_EOErxframet *frame;
+   ec_EOEt *aEOEp;
+   int wkc;
+
+   eport = (ec_EOEportt *)trans->userdata;
+   if (trans->state != EC_MBXTRANS_DONE)
+   {
+      return;
+   }
+   aEOEp = (ec_EOEt *)&(eport->rxmbx);
+   target = NULL;
+   if (((aEOEp->mbxheader.mbxtype & 0x0f) == ECT_MBXT_EOE) &&
+       (EOE_HDR_FRAME_TYPE_GET(etohs(aEOEp->frameinfo1)) == EOE_FRAG_DATA))
+   {
+      /* fragment may belong to another port of the slave */
+      target = ecx_EOEswitch_find(eport->sw, eport->slave,
+                                  EOE_HDR_FRAME_PORT_GET(etohs(aEOEp->frameinfo1)));
+   }
+   if (!target)
+   {
+      /* message for another mailbox user, read by the switch poll */
+      eport->sw->other++;
+      if (eport->sw->otherhook)
+      {
+         eport->sw->otherhook(context, eport->slave, &(eport->rxmbx));
+      }
+      else
+      {
+         ecx_packeterror(context, eport->slave, 0, 0, 1); /* Unexpected frame returned */
+      }
+      return;
+   }
+   eport = target;
+   wkc = ecx_EOErx_fragment(&(eport->rx), (ec_mbxbuft *)aEOEp, &frame);
+   if (wkc < 0)
+   {
+      eport->rxerrors++;
+   }
+   else if (wkc > 0)
+   {
+      eport->rxframes++;
+      eport->rxbytes += frame->size;
+      ecx_EOElatency(&(eport->rxlatency), &(eport->rxlatencymax), ec_elapsed(&(frame->start)));
+      if (eport->sw->hostwrite)
+      {
+         eport->sw->hostwrite(context, eport, frame->data, frame->size);
+      }
+      ecx_EOErx_release(&(eport->rx), frame);
+   }
+}
+
+/* Update transfer rates of port once per EC_EOERATEWINDOW */
+static void ecx_EOEswitch_rate(ec_EOEportt *eport)
+{
+   uint32 elapsed;
+
+   elapsed = ec_elapsed(&(eport->ratetime));
+   if (elapsed < EC_EOERATEWINDOW)
+   {
+      return;
+   }
+   eport->txrate = (uint32)(((uint64)(eport->txbytes - eport->ratetxbytes) * 1000000) / elapsed);
+   eport->rxrate = (uint32)(((uint64)(eport->rxbytes - eport->raterxbytes) * 1000000) / elapsed);
+   eport->ratetxbytes = eport->txbytes;
+   eport->raterxbytes = eport->rxbytes;
+   eport->ratetime = osal_current_time();
+}
+
+/** EoE switch poll step, non blocking.
+*
+* Takes new frames from the host interfaces, writes the next fragment of
+* every port and reads pending fragments of all slaves, then drives the
+* mailbox engine one step. Mailbox status, fragment writes and fragment
+* reads of all slaves are packed in as few frames as possible. Call
+* cyclically, f.e. every 1 ms, from the thread that owns the mailbox
+* engine.
+*
+* @param[in]  context = context struct
+* @param[in]  sw      = EoE switch
+* @return number of mailbox transactions not finished, -1 without mailbox engine
+*/
+int ecx_EOEswitch_poll(ecx_contextt *context, ec_EOEswitcht *sw)
+{
+   ec_EOEportt *eport;
+   int lp;
+
+   if (!context->mbxengine)
+   {
+      return -1;
+   }
+   for (lp = 0; lp < sw->nport; lp++)
+   {
+      eport = &(sw->port[lp]);
+      if (!eport->txbusy && sw->hostread)
+      {
+         eport->txsize = sw->hostread(context, eport, eport->txframe, EC_EOEMAXFRAME);
+         if (eport->txsize > 0)
+         {
+            eport->txbusy = TRUE;
+            eport->txtime = osal_current_time();
+            eport->txoffset = 0;
+            eport->txfragmentno = 0;
+            eport->txframeno = (eport->txframeno + 1) & 0x0f;
+            ecx_EOEswitch_fragment(context, eport);
+         }
+      }
+      /* one mailbox poll per port, a poll with timeout 0 reads the
+       * mailbox status once. A fragment read by the poll of one port is
+       * passed to the port it is addressed to. */
+      if ((eport->rxtrans.state == EC_MBXTRANS_IDLE) || (eport->rxtrans.state >= EC_MBXTRANS_DONE))
+      {
+         ec_clearmbx(&(eport->rxmbx));
+         eport->rxtrans.slave = eport->slave;
+         eport->rxtrans.txmbx = NULL;
+         eport->rxtrans.rxmbx = &(eport->rxmbx);
+         eport->rxtrans.timeout = 0;
+         eport->rxtrans.complete = ecx_EOEswitch_rxcomplete;
+         eport->rxtrans.userdata = eport;
+         ecx_mbxsubmit(context, &(eport->rxtrans));
+      }
+   }
+
+   for (lp = 0; lp < sw->nport; lp++)
+   {
+      ecx_EOEswitch_rate(&(sw->port[lp]));
+   }
+
+   return ecx_mbxpoll(context);
+}
@@ -174,6 +174,170 @@ typedef struct PACKED
 } ec_EOEt;
 PACKED_END
 
+/** max. number of ports of the EoE switch */
+#define EC_EOEMAXPORTS  32
+/** max. Ethernet frame size handled by the EoE switch, incl. VLAN tag */
+#define EC_EOEMAXFRAME  1536
+/** interval in us over which the EoE switch port rates are measured */
+#define EC_EOERATEWINDOW 1000000
+
+/** number of frame buffers of an EoE reassembly context */
+#define EC_EOERXFRAMES  4
+
+/** EoE reassembly frame buffer states */
+typedef enum
+{
+   /** buffer is free */
+   EC_EOERX_FREE        = 0,
+   /** fragments are being collected */
+   EC_EOERX_ASSEMBLING,
+   /** complete frame handed to consumer, until ecx_EOErx_release() */
+   EC_EOERX_READY
+} ec_EOErxstatet;
+
+/** Frame buffer of an EoE reassembly context */
+typedef struct
+{
+   /** buffer state, see ec_EOErxstatet */
+   uint8 state;
+   /** EoE frame number */
+   uint8 frameno;
+   /** next expected fragment number */
+   uint8 fragmentno;
+   /** size of frame, announced size while assembling, final size when ready */
+   uint16 size;
+   /** bytes collected */
+   uint16 offset;
+   /** internal, order of first fragment, used to evict the oldest frame */
+   uint32 seq;
+   /** time first fragment was received */
+   ec_timet start;
+   /** frame data */
+   uint8 data[EC_EOEMAXFRAME];
+} ec_EOErxframet;
+
+/** EoE reassembly context of one slave port. Fragments are collected in a
+* pool of frame buffers keyed by frame number, so a fragment that does not
+* fit only drops its own frame. Finished frames are handed out in place
+* and return to the pool with ecx_EOErx_release().
+*/
+typedef struct
+{
+   /** slave number */
+   uint16 slave;
+   /** EoE port of slave */
+   uint8 port;
+   /** complete frames */
+   uint32 frames;
+   /** fragments dropped because of wrong sequence or size */
+   uint32 errors;
+   /** frames dropped because no buffer was free */
+   uint32 dropped;
+   /** internal, sequence counter of first fragments */
+   uint32 seq;
+   /** frame buffers */
+   ec_EOErxframet frame[EC_EOERXFRAMES];
+} ec_EOErxt;
+
+typedef struct ec_EOEswitch ec_EOEswitcht;
+
+/** Port of the EoE switch, one EoE port of a slave bridged to a host
+ * interface.
+ */
+typedef struct ec_EOEport
+{
+   /** slave number */
+   uint16 slave;
+   /** EoE port of slave */
+   uint8 port;
+   /** host interface handle, f.e. file descriptor of a TAP device */
+   int hosthandle;
+   /** frames sent to slave */
+   uint32 txframes;
+   /** bytes sent to slave */
+   uint32 txbytes;
+   /** frames from host dropped because the slave did not take them */
+   uint32 txdrops;
+   /** frames received from slave */
+   uint32 rxframes;
+   /** bytes received from slave */
+   uint32 rxbytes;
+   /** fragments received from slave that could not be reassembled */
+   uint32 rxerrors;
+   /** average time in us from host frame to last fragment written */
+   uint32 txlatency;
+   /** longest time in us from host frame to last fragment written */
+   uint32 txlatencymax;
+   /** average time in us from first to last fragment received */
+   uint32 rxlatency;
+   /** longest time in us from first to last fragment received */
+   uint32 rxlatencymax;
+   /** bytes per second sent to slave, over the last EC_EOERATEWINDOW */
+   uint32 txrate;
+   /** bytes per second received from slave, over the last EC_EOERATEWINDOW */
+   uint32 rxrate;
+   /** internal, start of rate window */
+   ec_timet ratetime;
+   /** internal, txbytes at start of rate window */
+   uint32 ratetxbytes;
+   /** internal, rxbytes at start of rate window */
+   uint32 raterxbytes;
+   /** internal, switch of port */
+   ec_EOEswitcht *sw;
+   /** internal, frame from host in transmission */
+   boolean txbusy;
+   /** internal, size of frame in transmission */
+   int txsize;
+   /** internal, bytes of frame written */
+   int txoffset;
+   /** internal, size of fragment in transmission */
+   int txfragsize;
+   /** internal, next fragment number */
+   uint8 txfragmentno;
+   /** internal, frame number */
+   uint8 txframeno;
+   /** internal, time frame was taken from host */
+   ec_timet txtime;
+   /** internal, reassembly of frames from slave */
+   ec_EOErxt rx;
+   /** internal, fragment write transaction */
+   ec_mbxtranst txtrans;
+   /** internal, mailbox poll transaction */
+   ec_mbxtranst rxtrans;
+   /** internal, fragment to write */
+   ec_mbxbuft txmbx;
+   /** internal, fragment read */
+   ec_mbxbuft rxmbx;
+   /** internal, frame from host */
+   uint8 txframe[EC_EOEMAXFRAME];
+} ec_EOEportt;
+
+/** EoE switch. Bridges EoE ports of slaves to host interfaces, f.e. TAP
+* devices, using the asynchronous mailbox engine. All slaves are polled
+* in the same frames and the fragments of different slaves are in flight
+* at the same time.
+*/
+struct ec_EOEswitch
+{
+   /** number of ports */
+   int nport;
+   /** ports */
+   ec_EOEportt port[EC_EOEMAXPORTS];
+   /** timeout in us of a fragment write */
+   int timeout;
+   /** get next frame of host interface for port, returns size, 0 = none.
+    * Must not block. */
+   int (*hostread)(ecx_contextt *context, ec_EOEportt *port, uint8 *frame, int size);
+   /** pass frame received from port to host interface */
+   void (*hostwrite)(ecx_contextt *context, ec_EOEportt *port, const uint8 *frame, int size);
+   /** mailbox messages read by the switch polls that are no EoE fragments,
+    * emergencies and mailbox errors are already on the error stack */
+   uint32 other;
+   /** pass such a message to the application, NULL = report it as packet
+    * error on the error stack */
+   void (*otherhook)(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx);
+};
+
 int ecx_EOEdefinehook(ecx_contextt *context, void *hook);
 int ecx_EOEsetIp(ecx_contextt *context, 
    uint16 slave, 
@@ -205,6 +369,19 @@ int ecx_EOEreadfragment(
    uint16 * rxframeno,
    int * psize,
    void *p);
+void ecx_EOErx_init(ec_EOErxt *rx, uint16 slave, uint8 port);
+int ecx_EOErx_fragment(ec_EOErxt *rx, ec_mbxbuft *MbxIn, ec_EOErxframet **frame);
+void ecx_EOErx_release(ec_EOErxt *rx, ec_EOErxframet *frame);
+void ecx_EOEswitch_init(ec_EOEswitcht *sw,
+   int (*hostread)(ecx_contextt *context, ec_EOEportt *port, uint8 *frame, int size),
+   void (*hostwrite)(ecx_contextt *context, ec_EOEportt *port, const uint8 *frame, int size),
+   int timeout);
+ec_EOEportt *ecx_EOEswitch_add(ecx_contextt *context,
+   ec_EOEswitcht *sw,
+   uint16 slave,
+   uint8 port,
+   int hosthandle);
+int ecx_EOEswitch_poll(ecx_contextt *context, ec_EOEswitcht *sw);
 
 #ifdef __cplusplus
 }
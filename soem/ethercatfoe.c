@@ -17,9 +17,16 @@
 #include "ethercattype.h"
 #include "ethercatbase.h"
 #include "ethercatmain.h"
+#include "ethercatmbx.h"
 #include "ethercatfoe.h"
 
 #define EC_MAXFOEDATA 512
+/** delay in us before a packet is resent after a BUSY response */
+#define EC_FOEBUSYDELAY   10000
+/** FoE error code sent to the slave when a stream callback stops the transfer */
+#define EC_FOESTREAMABORT 0x8000
+/** delay in us between polls when all targets wait after BUSY */
+#define EC_FOEMULTIDELAY  500
 
 /** FOE structure.
  * Used for Read, Write, Data, Ack and Error mailbox packets.
@@ -352,6 +359,547 @@ int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 pas
    return wkc;
 }
 
+/* Set mailbox header of FoE request in stream with a new mailbox counter */
+static void ecx_FOEstream_header(ecx_contextt *context, uint16 slave, ec_FOEstreamt *stream,
+                                 uint16 length)
+{
+   ec_FOEt *FOEp;
+   uint8 cnt;
+
+   FOEp = (ec_FOEt *)&(stream->txmbx);
+   FOEp->MbxHeader.length = htoes(length);
+   FOEp->MbxHeader.address = htoes(0x0000);
+   FOEp->MbxHeader.priority = 0x00;
+   cnt = ec_nextmbxcnt(context->slavelist[slave].mbx_cnt);
+   context->slavelist[slave].mbx_cnt = cnt;
+   FOEp->MbxHeader.mbxtype = ECT_MBXT_FOE + MBX_HDR_SET_CNT(cnt); /* FoE */
+}
+
+/* Send FoE read or write request of a stream */
+static int ecx_FOEstream_request(ecx_contextt *context, uint16 slave, ec_FOEstreamt *stream,
+                                 uint8 opcode, char *filename, uint32 password, int maxdata)
+{
+   ec_FOEt *FOEp;
+   uint16 fnsize;
+
+   ec_clearmbx(&(stream->rxmbx));
+   /* Empty slave out mailbox if something is in. Timeout set to 0 */
+   ecx_mbxreceive(context, slave, &(stream->rxmbx), 0);
+   ec_clearmbx(&(stream->txmbx));
+   FOEp = (ec_FOEt *)&(stream->txmbx);
+   fnsize = (uint16)strlen(filename);
+   if (fnsize > maxdata)
+   {
+      fnsize = (uint16)maxdata;
+   }
+   ecx_FOEstream_header(context, slave, stream, (uint16)(0x0006 + fnsize));
+   FOEp->OpCode = opcode;
+   FOEp->Password = htoel(password);
+   memcpy(&FOEp->FileName[0], filename, fnsize);
+
+   return ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+}
+
+/* Send FoE error request to slave, stops a running transfer */
+static void ecx_FOEstream_abort(ecx_contextt *context, uint16 slave, ec_FOEstreamt *stream)
+{
+   ec_FOEt *FOEp;
+
+   ec_clearmbx(&(stream->txmbx));
+   FOEp = (ec_FOEt *)&(stream->txmbx);
+   ecx_FOEstream_header(context, slave, stream, 0x0006);
+   FOEp->OpCode = ECT_FOE_ERROR;
+   FOEp->ErrorCode = htoel(EC_FOESTREAMABORT);
+   ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+}
+
+/** FoE read with streaming of the data, blocking.
+ *
+ * Same transfer as ecx_FOEread(), but the file is not collected in a
+ * caller buffer. Every data packet is passed to the chunk callback of the
+ * stream straight from the response mailbox, so files of any size can be
+ * written to storage while they arrive. The end of the file is a packet
+ * shorter than the read mailbox allows. The FoE hook is called with the
+ * bytes read so far.
+ *
+ * @param[in]     context    = context struct
+ * @param[in]     slave      = Slave number.
+ * @param[in]     filename   = Filename of file to read.
+ * @param[in]     password   = password.
+ * @param[in,out] stream     = stream with chunk callback, done is returned
+ * @param[in]     timeout    = Timeout per mailbox cycle in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response, negative FoE error type on error
+ */
+int ecx_FOEread_stream(ecx_contextt *context, uint16 slave, char *filename, uint32 password,
+                       ec_FOEstreamt *stream, int timeout)
+{
+   ec_FOEt *FOEp, *aFOEp;
+   int wkc, maxdata, segmentdata;
+   int32 packetnumber, prevpacket;
+   boolean worktodo;
+
+   stream->done = 0;
+   maxdata = context->slavelist[slave].mbx_rl - 12;
+   wkc = ecx_FOEstream_request(context, slave, stream, ECT_FOE_READ, filename, password,
+                               context->slavelist[slave].mbx_l - 12);
+   FOEp = (ec_FOEt *)&(stream->txmbx);
+   aFOEp = (ec_FOEt *)&(stream->rxmbx);
+   prevpacket = 0;
+   worktodo = (wkc > 0);
+   while (worktodo)
+   {
+      worktodo = FALSE;
+      ec_clearmbx(&(stream->rxmbx));
+      wkc = ecx_mbxreceive(context, slave, &(stream->rxmbx), timeout);
+      if (wkc <= 0)
+      {
+         break;
+      }
+      if (((aFOEp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_FOE) ||
+          ((aFOEp->OpCode != ECT_FOE_DATA) && (aFOEp->OpCode != ECT_FOE_ERROR)))
+      {
+         /* unexpected mailbox received */
+         wkc = -EC_ERR_TYPE_PACKET_ERROR;
+         break;
+      }
+      if (aFOEp->OpCode == ECT_FOE_ERROR)
+      {
+         wkc = -EC_ERR_TYPE_FOE_ERROR;
+         break;
+      }
+      segmentdata = etohs(aFOEp->MbxHeader.length) - 0x0006;
+      packetnumber = etohl(aFOEp->PacketNumber);
+      if ((packetnumber != ++prevpacket) || (segmentdata < 0) || (segmentdata > maxdata))
+      {
+         wkc = -EC_ERR_TYPE_FOE_PACKETNUMBER;
+         break;
+      }
+      if (stream->chunk(context, slave, stream, &aFOEp->Data[0], segmentdata) < 0)
+      {
+         ecx_FOEstream_abort(context, slave, stream);
+         wkc = -EC_ERR_TYPE_FOE_ERROR;
+         break;
+      }
+      stream->done += segmentdata;
+      ec_clearmbx(&(stream->txmbx));
+      ecx_FOEstream_header(context, slave, stream, 0x0006);
+      FOEp->OpCode = ECT_FOE_ACK;
+      FOEp->PacketNumber = htoel(packetnumber);
+      /* send FoE ack to slave */
+      wkc = ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+      if (context->FOEhook)
+      {
+         context->FOEhook(slave, packetnumber, stream->done);
+      }
+      worktodo = ((wkc > 0) && (segmentdata == maxdata));
+   }
+
+   return wkc;
+}
+
+/** FoE write with streaming of the data, blocking.
+ *
+ * Same transfer as ecx_FOEwrite(), but the file is not taken from a caller
+ * buffer. Every data packet is filled by the chunk callback of the stream
+ * straight in the request mailbox, using the full write mailbox of the
+ * slave. The file ends when the callback returns less than requested. A
+ * BUSY response makes the last packet be resent. As with ecx_FOEwrite()
+ * the FoE hook is called with the bytes remaining, computed from the size
+ * set in the stream, or 0 if it is unknown.
+ *
+ * @param[in]     context    = context struct
+ * @param[in]     slave      = Slave number.
+ * @param[in]     filename   = Filename of file to write.
+ * @param[in]     password   = password.
+ * @param[in,out] stream     = stream with chunk callback, done is returned
+ * @param[in]     timeout    = Timeout per mailbox cycle in us, standard is EC_TIMEOUTRXM
+ * @return Workcounter from last slave response, negative FoE error type on error
+ */
+int ecx_FOEwrite_stream(ecx_contextt *context, uint16 slave, char *filename, uint32 password,
+                        ec_FOEstreamt *stream, int timeout)
+{
+   ec_FOEt *FOEp, *aFOEp;
+   int wkc, maxdata, segmentdata;
+   int32 packetnumber, sendpacket;
+   boolean worktodo, eof;
+
+   stream->done = 0;
+   maxdata = context->slavelist[slave].mbx_l - 12;
+   wkc = ecx_FOEstream_request(context, slave, stream, ECT_FOE_WRITE, filename, password, maxdata);
+   FOEp = (ec_FOEt *)&(stream->txmbx);
+   aFOEp = (ec_FOEt *)&(stream->rxmbx);
+   sendpacket = 0;
+   segmentdata = 0;
+   eof = FALSE;
+   worktodo = (wkc > 0);
+   while (worktodo)
+   {
+      worktodo = FALSE;
+      ec_clearmbx(&(stream->rxmbx));
+      wkc = ecx_mbxreceive(context, slave, &(stream->rxmbx), timeout);
+      if (wkc <= 0)
+      {
+         break;
+      }
+      if ((aFOEp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_FOE)
+      {
+         /* unexpected mailbox received */
+         wkc = -EC_ERR_TYPE_PACKET_ERROR;
+         break;
+      }
+      switch (aFOEp->OpCode)
+      {
+         case ECT_FOE_ACK:
+         {
+            packetnumber = etohl(aFOEp->PacketNumber);
+            if (packetnumber != sendpacket)
+            {
+               wkc = -EC_ERR_TYPE_FOE_PACKETNUMBER;
+               break;
+            }
+            stream->done += segmentdata;
+            if (context->FOEhook)
+            {
+               context->FOEhook(slave, packetnumber,
+                  (stream->size > stream->done) ? (stream->size - stream->done) : 0);
+            }
+            if (eof)
+            {
+               break;
+            }
+            segmentdata = stream->chunk(context, slave, stream, &FOEp->Data[0], maxdata);
+            if (segmentdata < 0)
+            {
+               ecx_FOEstream_abort(context, slave, stream);
+               wkc = -EC_ERR_TYPE_FOE_ERROR;
+               break;
+            }
+            if (segmentdata > maxdata)
+            {
+               segmentdata = maxdata;
+            }
+            /* EOF is a packet shorter than maxdata */
+            eof = (segmentdata < maxdata);
+            ecx_FOEstream_header(context, slave, stream, (uint16)(0x0006 + segmentdata));
+            FOEp->OpCode = ECT_FOE_DATA;
+            sendpacket++;
+            FOEp->PacketNumber = htoel(sendpacket);
+            /* send FoE data to slave */
+            wkc = ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+            worktodo = (wkc > 0);
+            break;
+         }
+         case ECT_FOE_BUSY:
+         {
+            /* resend last request */
+            osal_usleep(EC_FOEBUSYDELAY);
+            ecx_FOEstream_header(context, slave, stream, etohs(FOEp->MbxHeader.length));
+            wkc = ecx_mbxsend(context, slave, &(stream->txmbx), EC_TIMEOUTTXM);
+            worktodo = (wkc > 0);
+            break;
+         }
+         case ECT_FOE_ERROR:
+         {
+            /* FoE error */
+            wkc = (etohl(aFOEp->ErrorCode) == 0x8001) ?
+                  -EC_ERR_TYPE_FOE_FILE_NOTFOUND : -EC_ERR_TYPE_FOE_ERROR;
+            break;
+         }
+         default:
+         {
+            /* unexpected mailbox received */
+            wkc = -EC_ERR_TYPE_PACKET_ERROR;
+            break;
+         }
+      }
+   }
+
+   return wkc;
+}
+
+/* Set mailbox header of FoE request of a target with a new mailbox counter */
+static void ecx_FOEmulti_header(ecx_contextt *context, ec_FOEtargett *target, uint16 length)
+{
+   ec_FOEt *FOEp;
+   uint8 cnt;
+
+   FOEp = (ec_FOEt *)&(target->txmbx);
+   FOEp->MbxHeader.length = htoes(length);
+   FOEp->MbxHeader.address = htoes(0x0000);
+   FOEp->MbxHeader.priority = 0x00;
+   cnt = ec_nextmbxcnt(context->slavelist[target->slave].mbx_cnt);
+   context->slavelist[target->slave].mbx_cnt = cnt;
+   FOEp->MbxHeader.mbxtype = ECT_MBXT_FOE + MBX_HDR_SET_CNT(cnt); /* FoE */
+}
+
+static void ecx_FOEmulti_complete(ecx_contextt *context, ec_mbxtranst *trans);
+
+/* Submit request in txmbx of a target to the mailbox engine */
+static boolean ecx_FOEmulti_submit(ecx_contextt *context, ec_FOEtargett *target)
+{
+   ec_clearmbx(&(target->rxmbx));
+   target->trans.slave = target->slave;
+   target->trans.txmbx = &(target->txmbx);
+   target->trans.rxmbx = &(target->rxmbx);
+   target->trans.timeout = target->timeout;
+   target->trans.complete = ecx_FOEmulti_complete;
+   target->trans.userdata = target;
+
+   return (ecx_mbxsubmit(context, &(target->trans)) > 0);
+}
+
+/* Finish a target */
+static void ecx_FOEmulti_finish(ec_FOEtargett *target, int wkc)
+{
+   target->wkc = wkc;
+   target->busy = FALSE;
+}
+
+/* Build next data packet of a target after an acknowledge.
+ * Returns FALSE when the whole file is acknowledged.
+ */
+static boolean ecx_FOEmulti_data(ecx_contextt *context, ec_FOEtargett *target)
+{
+   ec_FOEt *FOEp;
+   int segment;
+
+   segment = target->size - target->pos;
+   if (segment > target->maxdata)
+   {
+      segment = target->maxdata;
+   }
+   if (!segment && !target->finalzero)
+   {
+      return FALSE;
+   }
+   /* EOF is a packet shorter than maxdata, a full last packet is followed
+    * by a zero size packet */
+   target->finalzero = ((target->pos + segment) == target->size) && (segment == target->maxdata);
+   FOEp = (ec_FOEt *)&(target->txmbx);
+   ecx_FOEmulti_header(context, target, (uint16)(0x0006 + segment));
+   FOEp->OpCode = ECT_FOE_DATA;
+   target->sendpacket++;
+   FOEp->PacketNumber = htoel(target->sendpacket);
+   memcpy(&FOEp->Data[0], (const uint8 *)target->data + target->pos, segment);
+   target->pos += segment;
+
+   return TRUE;
+}
+
+/* Mailbox engine completion of a target transaction */
+static void ecx_FOEmulti_complete(ecx_contextt *context, ec_mbxtranst *trans)
+{
+   ec_FOEtargett *target;
+   ec_FOEt *aFOEp;
+   int32 packetnumber;
+
+   target = (ec_FOEtargett *)trans->userdata;
+   if (trans->state != EC_MBXTRANS_DONE)
+   {
+      ecx_FOEmulti_finish(target, (trans->wkc < 0) ? trans->wkc : EC_ERROR);
+      return;
+   }
+   aFOEp = (ec_FOEt *)&(target->rxmbx);
+   if ((aFOEp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_FOE)
+   {
+      /* unexpected mailbox received */
+      ecx_FOEmulti_finish(target, -EC_ERR_TYPE_PACKET_ERROR);
+      return;
+   }
+   switch (aFOEp->OpCode)
+   {
+      case ECT_FOE_ACK:
+      {
+         packetnumber = etohl(aFOEp->PacketNumber);
+         if (packetnumber != target->sendpacket)
+         {
+            ecx_FOEmulti_finish(target, -EC_ERR_TYPE_FOE_PACKETNUMBER);
+            break;
+         }
+         target->done = target->pos;
+         target->time = ec_elapsed(&(target->starttime));
+         if (target->time)
+         {
+            target->rate = (uint32)(((uint64)target->done * 1000000) / target->time);
+         }
+         if (context->FOEhook)
+         {
+            context->FOEhook(target->slave, packetnumber, target->size - target->done);
+         }
+         if (!ecx_FOEmulti_data(context, target))
+         {
+            ecx_FOEmulti_finish(target, trans->wkc);
+         }
+         else if (!ecx_FOEmulti_submit(context, target))
+         {
+            ecx_FOEmulti_finish(target, EC_ERROR);
+         }
+         break;
+      }
+      case ECT_FOE_BUSY:
+      {
+         /* resend last request after hold off */
+         target->busycnt++;
+         target->holdoff = TRUE;
+         osal_timer_start(&(target->timer), EC_FOEBUSYDELAY);
+         break;
+      }
+      case ECT_FOE_ERROR:
+      {
+         target->errorcode = etohl(aFOEp->ErrorCode);
+         ecx_FOEmulti_finish(target, (target->errorcode == 0x8001) ?
+                             -EC_ERR_TYPE_FOE_FILE_NOTFOUND : -EC_ERR_TYPE_FOE_ERROR);
+         break;
+      }
+      default:
+      {
+         /* unexpected mailbox received */
+         ecx_FOEmulti_finish(target, -EC_ERR_TYPE_PACKET_ERROR);
+         break;
+      }
+   }
+}
+
+/* Build and submit FoE write request of a target */
+static void ecx_FOEmulti_start(ecx_contextt *context, ec_FOEtargett *target)
+{
+   ec_FOEt *FOEp;
+   uint16 fnsize;
+
+   ec_clearmbx(&(target->txmbx));
+   FOEp = (ec_FOEt *)&(target->txmbx);
+   fnsize = (uint16)strlen(target->filename);
+   if (fnsize > target->maxdata)
+   {
+      fnsize = (uint16)target->maxdata;
+   }
+   ecx_FOEmulti_header(context, target, (uint16)(0x0006 + fnsize));
+   FOEp->OpCode = ECT_FOE_WRITE;
+   FOEp->Password = htoel(target->password);
+   memcpy(&FOEp->FileName[0], target->filename, fnsize);
+   if (!ecx_FOEmulti_submit(context, target))
+   {
+      ecx_FOEmulti_finish(target, EC_ERROR);
+   }
+}
+
+/** FoE write of files to many slaves in parallel, blocking.
+ *
+ * All targets are served at the same time by the mailbox engine, every
+ * slave acknowledges its packets independently. A BUSY response makes
+ * only that slave wait EC_FOEBUSYDELAY before its last packet is resent.
+ * Targets may share the same file buffer but not the same slave, two
+ * sessions on one mailbox would corrupt each other. Progress is reported
+ * in the targets and by the FoE hook. Without mailbox engine the targets
+ * are written one by one with ecx_FOEwrite().
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     n        = number of targets
+ * @param[in,out] list     = targets, slave, filename, password, size and data
+ *                           must be set, result and progress are returned
+ * @param[in]     timeout  = Timeout per mailbox cycle in us, standard is EC_TIMEOUTRXM
+ * @return number of targets written successfully, EC_ERROR if a slave is
+ *         listed more than once, no target is written then
+ */
+int ecx_FOEwrite_multi(ecx_contextt *context, int n, ec_FOEtargett *list, int timeout)
+{
+   ec_FOEtargett *target;
+   int lp, lp2, pending, cnt;
+
+   /* one FoE session per slave mailbox */
+   for (lp = 0; lp < n; lp++)
+   {
+      for (lp2 = lp + 1; lp2 < n; lp2++)
+      {
+         if (list[lp].slave == list[lp2].slave)
+         {
+            for (lp = 0; lp < n; lp++)
+            {
+               list[lp].wkc = EC_ERROR;
+               list[lp].busy = FALSE;
+            }
+            return EC_ERROR;
+         }
+      }
+   }
+   for (lp = 0; lp < n; lp++)
+   {
+      target = &list[lp];
+      target->wkc = 0;
+      target->errorcode = 0;
+      target->done = 0;
+      target->time = 0;
+      target->rate = 0;
+      target->busycnt = 0;
+      target->pos = 0;
+      target->sendpacket = 0;
+      target->finalzero = FALSE;
+      target->holdoff = FALSE;
+      target->timeout = timeout;
+      target->starttime = osal_current_time();
+      if ((target->slave == 0) || (target->slave > *(context->slavecount)) ||
+          (target->slave >= EC_MAXSLAVE) || (context->slavelist[target->slave].mbx_l <= 12))
+      {
+         target->wkc = EC_ERROR;
+         target->busy = FALSE;
+         continue;
+      }
+      target->maxdata = context->slavelist[target->slave].mbx_l - 12;
+      /* without engine write one by one */
+      if (!context->mbxengine)
+      {
+         target->wkc = ecx_FOEwrite(context, target->slave, target->filename, target->password,
+                                    target->size, (void *)target->data, timeout);
+         target->time = ec_elapsed(&(target->starttime));
+         if (target->wkc > 0)
+         {
+            target->done = target->size;
+         }
+         target->busy = FALSE;
+         continue;
+      }
+      target->busy = TRUE;
+      ecx_FOEmulti_start(context, target);
+   }
+   do
+   {
+      pending = 0;
+      for (lp = 0; lp < n; lp++)
+      {
+         target = &list[lp];
+         if (!target->busy)
+         {
+            continue;
+         }
+         pending++;
+         if (target->holdoff && osal_timer_is_expired(&(target->timer)))
+         {
+            target->holdoff = FALSE;
+            ecx_FOEmulti_header(context, target, etohs(((ec_FOEt *)&(target->txmbx))->MbxHeader.length));
+            if (!ecx_FOEmulti_submit(context, target))
+            {
+               ecx_FOEmulti_finish(target, EC_ERROR);
+            }
+         }
+      }
+      if (pending && (ecx_mbxpoll(context) == 0))
+      {
+         /* only targets in hold off left */
+         osal_usleep(EC_FOEMULTIDELAY);
+      }
+   } while (pending);
+   cnt = 0;
+   for (lp = 0; lp < n; lp++)
+   {
+      if (list[lp].wkc > 0)
+      {
+         cnt++;
+      }
+   }
+
+   return cnt;
+}
+
 #ifdef EC_VER1
 int ec_FOEdefinehook(void *hook)
 {
@@ -367,4 +915,19 @@ int ec_FOEwrite(uint16 slave, char *filename, uint32 password, int psize, void *
 {
    return ecx_FOEwrite(&ecx_context, slave, filename, password, psize, p, timeout);
 }
+
+int ec_FOEread_stream(uint16 slave, char *filename, uint32 password, ec_FOEstreamt *stream, int timeout)
+{
+   return ecx_FOEread_stream(&ecx_context, slave, filename, password, stream, timeout);
+}
+
+int ec_FOEwrite_stream(uint16 slave, char *filename, uint32 password, ec_FOEstreamt *stream, int timeout)
+{
+   return ecx_FOEwrite_stream(&ecx_context, slave, filename, password, stream, timeout);
+}
+
+int ec_FOEwrite_multi(int n, ec_FOEtargett *list, int timeout)
+{
+   return ecx_FOEwrite_multi(&ecx_context, n, list, timeout);
+}
 #endif
@@ -16,15 +16,102 @@ extern "C"
 {
 #endif
 
+typedef struct ec_FOEstream ec_FOEstreamt;
+
+/** Streaming FoE transfer, see ecx_FOEread_stream() and ecx_FOEwrite_stream().
+ * The mailbox buffers are reused for every packet.
+ */
+struct ec_FOEstream
+{
+   /** called per packet, return <0 to abort. On read data points to the
+    * received packet. On write fill up to length bytes at data and return
+    * the number of bytes, less than length marks the end of the file. */
+   int             (*chunk)(ecx_contextt *context, uint16 slave, ec_FOEstreamt *stream,
+                            uint8 *data, int length);
+   /** free for use by caller */
+   void            *userdata;
+   /** on write size in bytes of file if known, the FoE hook is called with
+    * the bytes remaining, 0 = unknown */
+   int32           size;
+   /** bytes transferred */
+   int32           done;
+   /** request mailbox */
+   ec_mbxbuft      txmbx;
+   /** response mailbox */
+   ec_mbxbuft      rxmbx;
+};
+
+typedef struct ec_FOEtarget ec_FOEtargett;
+
+/** Target of a parallel FoE write, see ecx_FOEwrite_multi() */
+struct ec_FOEtarget
+{
+   /** slave number */
+   uint16          slave;
+   /** filename of file to write */
+   char            *filename;
+   /** password */
+   uint32          password;
+   /** size in bytes of file */
+   int             size;
+   /** file data, may be shared by several targets */
+   const void      *data;
+   /** result, workcounter >0 is success, -EC_ERR_TYPE_xxx on FoE error,
+    * EC_TIMEOUT or EC_ERROR on mailbox failure */
+   int             wkc;
+   /** FoE error code of slave, 0 if none */
+   uint32          errorcode;
+   /** bytes acknowledged by slave */
+   int             done;
+   /** time in us since start of write */
+   uint32          time;
+   /** throughput in bytes/s */
+   uint32          rate;
+   /** number of BUSY responses */
+   uint32          busycnt;
+   /** internal, target is not finished */
+   boolean         busy;
+   /** internal, waiting to resend after BUSY */
+   boolean         holdoff;
+   /** internal, a zero size packet must follow */
+   boolean         finalzero;
+   /** internal, max. data per packet */
+   int             maxdata;
+   /** internal, bytes sent */
+   int             pos;
+   /** internal, number of last packet sent */
+   int32           sendpacket;
+   /** internal, timeout per mailbox transaction in us */
+   int             timeout;
+   /** internal, start time */
+   ec_timet        starttime;
+   /** internal, hold off timer */
+   osal_timert     timer;
+   /** internal, mailbox transaction */
+   ec_mbxtranst    trans;
+   /** internal, request */
+   ec_mbxbuft      txmbx;
+   /** internal, response */
+   ec_mbxbuft      rxmbx;
+};
+
 #ifdef EC_VER1
 int ec_FOEdefinehook(void *hook);
 int ec_FOEread(uint16 slave, char *filename, uint32 password, int *psize, void *p, int timeout);
 int ec_FOEwrite(uint16 slave, char *filename, uint32 password, int psize, void *p, int timeout);
+int ec_FOEread_stream(uint16 slave, char *filename, uint32 password, ec_FOEstreamt *stream, int timeout);
+int ec_FOEwrite_stream(uint16 slave, char *filename, uint32 password, ec_FOEstreamt *stream, int timeout);
+int ec_FOEwrite_multi(int n, ec_FOEtargett *list, int timeout);
 #endif
 
 int ecx_FOEdefinehook(ecx_contextt *context, void *hook);
 int ecx_FOEread(ecx_contextt *context, uint16 slave, char *filename, uint32 password, int *psize, void *p, int timeout);
 int ecx_FOEwrite(ecx_contextt *context, uint16 slave, char *filename, uint32 password, int psize, void *p, int timeout);
+int ecx_FOEread_stream(ecx_contextt *context, uint16 slave, char *filename, uint32 password,
+                       ec_FOEstreamt *stream, int timeout);
+int ecx_FOEwrite_stream(ecx_contextt *context, uint16 slave, char *filename, uint32 password,
+                        ec_FOEstreamt *stream, int timeout);
+int ecx_FOEwrite_multi(ecx_contextt *context, int n, ec_FOEtargett *list, int timeout);
 
 #ifdef __cplusplus
 }
@@ -24,6 +24,12 @@
 
 /** delay in us for eeprom ready loop */
 #define EC_LOCALDELAY  200
+/** max. age in us of processdata before mapped mailbox status is not used */
+#define EC_MBXSTATUSAGE  10000
+/** shortest delay in us between mailbox status polls */
+#define EC_MBXPOLLMIN  25
+/** longest delay in us between mailbox status polls */
+#define EC_MBXPOLLMAX  (EC_LOCALDELAY * 5)
 
 /** record for ethercat eeprom communications */
 PACKED_BEGIN
@@ -74,6 +80,17 @@ ec_groupt               ec_group[EC_MAXGROUP];
 static uint8            ec_esibuf[EC_MAXEEPBUF];
 /** bitmap for filled cache buffer bytes */
 static uint32           ec_esimap[EC_MAXEEPBITMAP];
+/** SII category index per slave */
+static ec_siiindext     ec_siicat[EC_MAXSLAVE];
+/** SII cache for all slaves */
+static ec_siicachet     ec_siicache;
+/** asynchronous mailbox engine */
+static ec_mbxenginet    ec_mbxengine;
+/** mailbox datagrams carried by processdata frames, EC_MAXSLAVE mailboxes,
+ * 300 kB with the default EC_MAXSLAVE and EC_MAXMBX */
+static ec_mbxdgqueuet   ec_mbxdgqueue;
+/** mailbox service for application threads */
+static ec_mbxservicet   ec_mbxservice;
 /** current slave for EEPROM cache buffer */
 static ec_eringt        ec_elist;
 static ec_idxstackT     ec_idxstack;
@@ -89,6 +106,10 @@ static ec_PDOdesct      ec_PDOdesc[EC_MAX_MAPT];
 static ec_eepromSMt     ec_SM;
 /** buffer for EEPROM FMMU data */
 static ec_eepromFMMUt   ec_FMMU;
+/** ENI configuration */
+static ec_enit          ec_eni;
+/** work area of DC configuration */
+static ec_dcworkt       ec_dcwork;
 /** Global variable TRUE if error available in error stack */
 boolean                 EcatError = FALSE;
 
@@ -120,6 +141,18 @@ ecx_contextt  ecx_context = {
     NULL,               // .EOEhook()
     0,                  // .manualstatechange
     NULL,               // .userdata
+    &ec_eni,            // .eni
+    NULL,               // .profile
+    &ec_siicat[0],      // .siiindex
+    &ec_siicache,       // .siicache
+    &ec_mbxengine,      // .mbxengine
+    &ec_mbxdgqueue,     // .mbxdgqueue
+    &ec_mbxservice,     // .mbxservice
+    NULL,               // .eventstream
+    NULL,               // .idncache
+    NULL,               // .dcmaster
+    NULL,               // .dcmonitor
+    &ec_dcwork,         // .dcwork
 };
 #endif
 
@@ -145,6 +178,37 @@ void ec_free_adapters (ec_adaptert * adapter)
    oshw_free_adapters (adapter);
 }
 
+/* Put event in stream, drop it when the stream is full */
+static void ecx_event_push(ec_eventstreamt *stream, const ec_errort *Ec)
+{
+   uint32 head;
+
+   if (stream->mutex)
+   {
+      osal_mutex_lock(stream->mutex);
+   }
+   head = stream->head;
+   if (!stream->event || ((head - stream->tail) >= stream->size))
+   {
+      stream->dropped++;
+      if ((Ec->Etype >= 0) && (Ec->Etype < EC_EVENTTYPES))
+      {
+         stream->droppedtype[Ec->Etype]++;
+      }
+   }
+   else
+   {
+      stream->event[head & (stream->size - 1)] = *Ec;
+      stream->event[head & (stream->size - 1)].Signal = TRUE;
+      stream->head = head + 1;
+      stream->count++;
+   }
+   if (stream->mutex)
+   {
+      osal_mutex_unlock(stream->mutex);
+   }
+}
+
 /** Pushes an error on the error list.
  *
  * @param[in] context        = context struct
@@ -167,6 +231,10 @@ void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec)
    {
       context->elist->tail = 0;
    }
+   if (context->eventstream)
+   {
+      ecx_event_push(context->eventstream, Ec);
+   }
    *(context->ecaterror) = TRUE;
 }
 
@@ -207,6 +275,114 @@ boolean ecx_iserror(ecx_contextt *context)
    return (context->elist->head != context->elist->tail);
 }
 
+/** Set up the event stream of a context. Errors pushed from now on are
+ * also put in the stream.
+ *
+ * @param[in]  context   = context struct
+ * @param[out] stream    = event stream
+ * @param[in]  buffer    = event buffer of size entries
+ * @param[in]  size      = number of entries, must be a power of 2
+ * @param[in]  callback  = called by ecx_event_dispatch(), NULL = none
+ * @return 1 if stream is set up, 0 if size is invalid
+ */
+int ecx_event_init(ecx_contextt *context, ec_eventstreamt *stream, ec_errort *buffer, uint32 size,
+                   void (*callback)(ecx_contextt *context, const ec_errort *event))
+{
+   if (!buffer || !size || (size & (size - 1)))
+   {
+      return 0;
+   }
+   memset(stream, 0x00, sizeof(ec_eventstreamt));
+   /* NULL on ports without mutex, errors must then come from one thread */
+   stream->mutex = osal_mutex_create();
+   stream->event = buffer;
+   stream->size = size;
+   stream->callback = callback;
+   context->eventstream = stream;
+
+   return 1;
+}
+
+/** Detach the event stream from a context and release its mutex. No error
+ * may be pushed concurrently.
+ *
+ * @param[in]  context   = context struct
+ */
+void ecx_event_close(ecx_contextt *context)
+{
+   ec_eventstreamt *stream;
+
+   stream = context->eventstream;
+   if (stream)
+   {
+      context->eventstream = NULL;
+      if (stream->mutex)
+      {
+         osal_mutex_destroy(stream->mutex);
+         stream->mutex = NULL;
+      }
+   }
+}
+
+/** Pop the oldest event from the event stream.
+ *
+ * @param[in]  context   = context struct
+ * @param[out] event     = event
+ * @return TRUE if an event was popped
+ */
+boolean ecx_event_pop(ecx_contextt *context, ec_errort *event)
+{
+   ec_eventstreamt *stream;
+   boolean popped;
+
+   stream = context->eventstream;
+   if (!stream)
+   {
+      return FALSE;
+   }
+   popped = FALSE;
+   if (stream->mutex)
+   {
+      osal_mutex_lock(stream->mutex);
+   }
+   if (stream->tail != stream->head)
+   {
+      *event = stream->event[stream->tail & (stream->size - 1)];
+      stream->tail++;
+      popped = TRUE;
+   }
+   if (stream->mutex)
+   {
+      osal_mutex_unlock(stream->mutex);
+   }
+
+   return popped;
+}
+
+/** Pop all events from the event stream and pass them to the callback.
+ * Call from the application thread that consumes the events.
+ *
+ * @param[in]  context   = context struct
+ * @return number of events dispatched
+ */
+int ecx_event_dispatch(ecx_contextt *context)
+{
+   ec_errort event;
+   int cnt;
+
+   cnt = 0;
+   while (ecx_event_pop(context, &event))
+   {
+      if (context->eventstream->callback)
+      {
+         context->eventstream->callback(context, &event);
+      }
+      cnt++;
+   }
+
+   return cnt;
+}
+
 /** Report packet error
  *
  * @param[in]  context        = context struct
@@ -322,6 +498,129 @@ void ecx_close(ecx_contextt *context)
    ecx_closenic(context->port);
 };
 
+/* Find cache page of slave holding address. When create is TRUE a missing
+ * page is allocated, replacing the least recently used page if the pool is full.
+ */
+static ec_siipaget *ecx_siicache_page(ecx_contextt *context, uint16 slave, uint16 address, boolean create)
+{
+   ec_siicachet *cache;
+   ec_siipaget *page;
+   uint16 pn;
+   int lp, lru;
+
+   cache = context->siicache;
+   pn = address / EC_SIIPAGESIZE;
+   page = &(cache->page[cache->last]);
+   if ((page->slave != slave) || (page->page != pn))
+   {
+      page = NULL;
+      lru = 0;
+      for (lp = 0; lp < EC_MAXSIIPAGE; lp++)
+      {
+         if ((cache->page[lp].slave == slave) && (cache->page[lp].page == pn))
+         {
+            page = &(cache->page[lp]);
+            break;
+         }
+         /* free page or oldest page is replacement candidate */
+         if (cache->page[lru].slave &&
+             (!cache->page[lp].slave || (cache->page[lp].lru < cache->page[lru].lru)))
+         {
+            lru = lp;
+         }
+      }
+      if (!page)
+      {
+         if (!create)
+         {
+            return NULL;
+         }
+         lp = lru;
+         page = &(cache->page[lp]);
+         page->slave = slave;
+         page->page = pn;
+         page->map = 0;
+      }
+      cache->last = (uint16)lp;
+   }
+   page->lru = ++(cache->stamp);
+   return page;
+}
+
+/** Put bytes read from slave EEPROM in SII cache.
+ *  @param[in] context = context struct
+ *  @param[in] slave   = slave number
+ *  @param[in] address = eeprom address in bytes of first byte
+ *  @param[in] data    = bytes to put in cache
+ *  @param[in] length  = number of bytes
+ */
+void ecx_siicache_put(ecx_contextt *context, uint16 slave, uint16 address, uint8 *data, int length)
+{
+   ec_siipaget *page;
+   int lp;
+   uint16 mapw, mapb;
+
+   if (slave == 0)
+   {
+      return;
+   }
+   for (lp = 0; (lp < length) && (address < EC_MAXEEPBUF); lp++, address++)
+   {
+      if (context->siicache)
+      {
+         page = ecx_siicache_page(context, slave, address, TRUE);
+         page->data[address % EC_SIIPAGESIZE] = data[lp];
+         page->map |= (uint64)1 << (address % EC_SIIPAGESIZE);
+      }
+      else if (slave == context->esislave)
+      {
+         mapw = address >> 5;
+         mapb = (uint16)(address - (mapw << 5));
+         context->esibuf[address] = data[lp];
+         context->esimap[mapw] |= (1U << mapb);
+      }
+   }
+}
+
+/** Read an area of the SII of all slaves in parallel into the SII cache.
+ *  The EEPROM reads of all slaves are started before the first result is
+ *  collected, so EEPROM access times of the slaves overlap.
+ *  @param[in] context = context struct
+ *  @param[in] address = eeprom address in bytes of area
+ *  @param[in] length  = length of area in bytes
+ *  @return number of slaves read
+ */
+int ecx_siicache_warm(ecx_contextt *context, uint16 address, uint16 length)
+{
+   uint16 slave, eadr;
+   uint32 edat, end;
+   uint8 bdat[4];
+
+   if (!context->siicache)
+   {
+      return 0;
+   }
+   end = (uint32)address + length;
+   if (end > EC_MAXEEPBUF)
+   {
+      end = EC_MAXEEPBUF;
+   }
+   for (eadr = address >> 1; ((uint32)eadr << 1) < end; eadr += 2)
+   {
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         ecx_readeeprom1(context, slave, eadr);
+      }
+      for (slave = 1; slave <= *(context->slavecount); slave++)
+      {
+         edat = ecx_readeeprom2(context, slave, EC_TIMEOUTEEP);
+         put_unaligned32(edat, &bdat[0]);
+         ecx_siicache_put(context, slave, (uint16)(eadr << 1), &bdat[0], 4);
+      }
+   }
+   return *(context->slavecount);
+}
+
 /** Read one byte from slave EEPROM via cache.
  *  If the cache location is empty then a read request is made to the slave.
  *  Depending on the slave capabilities the request is 4 or 8 bytes.
@@ -338,8 +637,43 @@ uint8 ecx_siigetbyte(ecx_contextt *context, uint16 slave, uint16 address)
    uint16 mapw, mapb;
    int lp,cnt;
    uint8 retval;
+   uint8 edat[8];
+   ec_siipaget *page;
 
    retval = 0xff;
+   if (context->siicache)
+   {
+      if ((slave == 0) || (address >= EC_MAXEEPBUF))
+      {
+         return retval;
+      }
+      page = ecx_siicache_page(context, slave, address, FALSE);
+      if (page && (page->map & ((uint64)1 << (address % EC_SIIPAGESIZE))))
+      {
+         /* byte is already in cache */
+         return page->data[address % EC_SIIPAGESIZE];
+      }
+      /* byte is not in cache, put it there */
+      configadr = context->slavelist[slave].configadr;
+      ecx_eeprom2master(context, slave); /* set eeprom control to master */
+      eadr = address >> 1;
+      edat64 = ecx_readeepromFP (context, configadr, eadr, EC_TIMEOUTEEP);
+      /* 8 byte response */
+      if (context->slavelist[slave].eep_8byte)
+      {
+         put_unaligned64(edat64, &edat[0]);
+         cnt = 8;
+      }
+      /* 4 byte response */
+      else
+      {
+         edat32 = (uint32)edat64;
+         put_unaligned32(edat32, &edat[0]);
+         cnt = 4;
+      }
+      ecx_siicache_put(context, slave, (uint16)(eadr << 1), &edat[0], cnt);
+      return edat[address - (eadr << 1)];
+   }
    if (slave != context->esislave) /* not the same slave? */
    {
       memset(context->esimap, 0x00, EC_MAXEEPBITMAP * sizeof(uint32)); /* clear esibuf cache map */
@@ -395,6 +729,95 @@ uint8 ecx_siigetbyte(ecx_contextt *context, uint16 slave, uint16 address)
    return retval;
 }
 
+/** Build SII category index of slave in one pass over the category chain.
+ *  Following ecx_siifind() calls of this slave are served from the index.
+ *  The index is dropped by ecx_siiinvalidate().
+ *  @param[in]  context = context struct
+ *  @param[in]  slave   = slave number
+ *  @return number of categories found
+ */
+int ecx_siiindex(ecx_contextt *context, uint16 slave)
+{
+   ec_siiindext *sii;
+   int a;
+   uint16 p, l;
+   uint8 eectl = context->slavelist[slave].eep_pdi;
+
+   if (!context->siiindex || (slave >= context->maxslave))
+   {
+      return 0;
+   }
+   sii = &(context->siiindex[slave]);
+   sii->ncat = 0;
+   a = ECT_SII_START << 1;
+   /* read first SII section category */
+   p = ecx_siigetbyte(context, slave, (uint16)a++);
+   p += (ecx_siigetbyte(context, slave, (uint16)a++) << 8);
+   /* traverse SII until EOF and record every category */
+   while ((p != 0xffff) && (sii->ncat < EC_MAXSIICAT))
+   {
+      sii->cat[sii->ncat] = p;
+      sii->addr[sii->ncat] = (uint16)a;
+      sii->ncat++;
+      /* read section length */
+      l = ecx_siigetbyte(context, slave, (uint16)a++);
+      l += (ecx_siigetbyte(context, slave, (uint16)a++) << 8);
+      /* locate next section category */
+      a += l << 1;
+      if (a >= EC_MAXEEPBUF)
+      {
+         break;
+      }
+      /* read section category */
+      p = ecx_siigetbyte(context, slave, (uint16)a++);
+      p += (ecx_siigetbyte(context, slave, (uint16)a++) << 8);
+   }
+   sii->valid = TRUE;
+   if (eectl)
+   {
+      ecx_eeprom2pdi(context, slave); /* if eeprom control was previously pdi then restore */
+   }
+
+   return sii->ncat;
+}
+
+/** Drop SII category index and cached SII bytes of slave, f.e. after EEPROM write.
+ *  @param[in]  context = context struct
+ *  @param[in]  slave   = slave number, 0 = all slaves
+ */
+void ecx_siiinvalidate(ecx_contextt *context, uint16 slave)
+{
+   int lp;
+
+   if (context->siiindex)
+   {
+      if (slave == 0)
+      {
+         memset(context->siiindex, 0x00, sizeof(ec_siiindext) * context->maxslave);
+      }
+      else if (slave < context->maxslave)
+      {
+         context->siiindex[slave].valid = FALSE;
+         context->siiindex[slave].ncat = 0;
+      }
+   }
+   if (context->siicache)
+   {
+      for (lp = 0; lp < EC_MAXSIIPAGE; lp++)
+      {
+         if ((slave == 0) || (context->siicache->page[lp].slave == slave))
+         {
+            context->siicache->page[lp].slave = 0;
+            context->siicache->page[lp].map = 0;
+         }
+      }
+   }
+   if ((slave == 0) || (slave == context->esislave))
+   {
+      memset(context->esimap, 0x00, EC_MAXEEPBITMAP * sizeof(uint32)); /* clear esibuf cache map */
+   }
+}
+
 /** Find SII section header in slave EEPROM.
  *  @param[in]  context        = context struct
  *  @param[in] slave   = slave number
@@ -406,7 +829,30 @@ int16 ecx_siifind(ecx_contextt *context, uint16 slave, uint16 cat)
    int16 a;
    uint16 p;
    uint8 eectl = context->slavelist[slave].eep_pdi;
+   ec_siiindext *sii;
+   int lp;
 
+   /* use category index when available */
+   if (context->siiindex && (slave < context->maxslave))
+   {
+      sii = &(context->siiindex[slave]);
+      if (!sii->valid)
+      {
+         ecx_siiindex(context, slave);
+      }
+      for (lp = 0; lp < sii->ncat; lp++)
+      {
+         if (sii->cat[lp] == cat)
+         {
+            return (int16)sii->addr[lp];
+         }
+      }
+      /* complete index and category not found */
+      if (sii->ncat < EC_MAXSIICAT)
+      {
+         return 0;
+      }
+   }
    a = ECT_SII_START << 1;
    /* read first SII section category */
    p = ecx_siigetbyte(context, slave, a++);
@@ -869,11 +1315,13 @@ uint16 ecx_statecheck(ecx_contextt *context, uint16 slave, uint16 reqstate, int
    uint16 configadr, state, rval;
    ec_alstatust slstat;
    osal_timert timer;
+   ec_profmarkt mark;
 
    if ( slave > *(context->slavecount) )
    {
       return 0;
    }
+   ecx_profile_start(context, &mark);
    osal_timer_start(&timer, timeout);
    configadr = context->slavelist[slave].configadr;
    do
@@ -900,10 +1348,156 @@ uint16 ecx_statecheck(ecx_contextt *context, uint16 slave, uint16 reqstate, int
    }
    while ((state != reqstate) && (osal_timer_is_expired(&timer) == FALSE));
    context->slavelist[slave].state = rval;
+   ecx_profile_stop(context, EC_PROF_STATECHECK, slave, &mark);
 
    return state;
 }
 
+/** Write the same requested state to a list of slaves.
+ * The AL control writes are packed in as few frames as possible, up to
+ * MAX_FPRD_MULTI datagrams per frame. The function does not check if the
+ * actual state is changed, use ecx_statecheck_multi() for that.
+ * @param[in] context  = context struct
+ * @param[in] n        = number of slaves in slavelst
+ * @param[in] slavelst = list of slave numbers
+ * @param[in] reqstate = requested state
+ * @param[in] timeout  = Timeout value in us per frame, f.e. EC_TIMEOUTRET3
+ * @return number of slaves that acknowledged the write
+ */
+int ecx_writestate_multi(ecx_contextt *context, int n, uint16 *slavelst, uint16 reqstate, int timeout)
+{
+   uint8 idx;
+   ecx_portt *port;
+   uint16 sldatapos[MAX_FPRD_MULTI];
+   uint16 slstate[MAX_FPRD_MULTI];
+   uint16 le_wkc;
+   int fslave, slcnt, nchunk, wkc, acked;
+
+   port = context->port;
+   acked = 0;
+   for (fslave = 0; fslave < n; fslave += MAX_FPRD_MULTI)
+   {
+      nchunk = n - fslave;
+      if (nchunk > MAX_FPRD_MULTI)
+      {
+         nchunk = MAX_FPRD_MULTI;
+      }
+      idx = ecx_getindex(port);
+      for (slcnt = 0; slcnt < nchunk; slcnt++)
+      {
+         slstate[slcnt] = htoes(reqstate);
+         if (slcnt == 0)
+         {
+            ecx_setupdatagram(port, &(port->txbuf[idx]), EC_CMD_FPWR, idx,
+               context->slavelist[slavelst[fslave]].configadr, ECT_REG_ALCTL,
+               sizeof(slstate[0]), &slstate[0]);
+            sldatapos[0] = EC_HEADERSIZE;
+         }
+         else
+         {
+            sldatapos[slcnt] = ecx_adddatagram(port, &(port->txbuf[idx]), EC_CMD_FPWR, idx,
+               (slcnt < (nchunk - 1)), context->slavelist[slavelst[fslave + slcnt]].configadr,
+               ECT_REG_ALCTL, sizeof(slstate[slcnt]), &slstate[slcnt]);
+         }
+      }
+      wkc = ecx_srconfirm(port, idx, timeout);
+      if (wkc >= 0)
+      {
+         for (slcnt = 0; slcnt < nchunk; slcnt++)
+         {
+            /* every datagram carries its own workcounter behind its data */
+            memcpy(&le_wkc, &(port->rxbuf[idx][sldatapos[slcnt] + sizeof(slstate[0])]), EC_WKCSIZE);
+            if (etohs(le_wkc) > 0)
+            {
+               acked++;
+            }
+         }
+      }
+      ecx_setbufstat(port, idx, EC_BUF_EMPTY);
+   }
+
+   return acked;
+}
+
+/** Check actual state of a list of slaves.
+ * This is a blocking function. All slaves that did not reach the requested state
+ * yet are polled together with multi datagram frames, one round per ms, until
+ * all slaves reached the requested state or the timeout expired.
+ * The state and AL status code of each slave in the list is refreshed.
+ * @param[in] context  = context struct
+ * @param[in] n        = number of slaves in slavelst
+ * @param[in] slavelst = list of slave numbers
+ * @param[in] reqstate = requested state
+ * @param[in] timeout  = Timeout value in us
+ * @return number of slaves that are in the requested state
+ */
+int ecx_statecheck_multi(ecx_contextt *context, int n, uint16 *slavelst, uint16 reqstate, int timeout)
+{
+   ec_alstatust sl[MAX_FPRD_MULTI];
+   uint16 slca[MAX_FPRD_MULTI];
+   uint16 sllst[MAX_FPRD_MULTI];
+   uint16 slave, rval;
+   int lp, slcnt, nchunk, inreq;
+   boolean firstround;
+   osal_timert timer;
+   ec_profmarkt mark;
+
+   ecx_profile_start(context, &mark);
+   osal_timer_start(&timer, timeout);
+   firstround = TRUE;
+   do
+   {
+      inreq = 0;
+      lp = 0;
+      while (lp < n)
+      {
+         /* collect next chunk of slaves that are not yet in requested state */
+         nchunk = 0;
+         while ((lp < n) && (nchunk < MAX_FPRD_MULTI))
+         {
+            slave = slavelst[lp++];
+            /* first round reads all slaves, later rounds only the ones still pending */
+            if (!firstround && ((context->slavelist[slave].state & 0x0f) == reqstate))
+            {
+               inreq++;
+            }
+            else
+            {
+               const ec_alstatust zero = { 0, 0, 0 };
+
+               sllst[nchunk] = slave;
+               slca[nchunk] = context->slavelist[slave].configadr;
+               sl[nchunk] = zero;
+               nchunk++;
+            }
+         }
+         if (nchunk > 0)
+         {
+            ecx_FPRD_multi(context, nchunk, &(slca[0]), &(sl[0]), EC_TIMEOUTRET3);
+            for (slcnt = 0; slcnt < nchunk; slcnt++)
+            {
+               rval = etohs(sl[slcnt].alstatus);
+               context->slavelist[sllst[slcnt]].state = rval;
+               context->slavelist[sllst[slcnt]].ALstatuscode = etohs(sl[slcnt].alstatuscode);
+               if ((rval & 0x0f) == reqstate)
+               {
+                  inreq++;
+               }
+            }
+         }
+      }
+      firstround = FALSE;
+      if (inreq < n)
+      {
+         osal_usleep(1000);
+      }
+   }
+   while ((inreq < n) && (osal_timer_is_expired(&timer) == FALSE));
+   ecx_profile_stop(context, EC_PROF_STATECHECK, 0, &mark);
+
+   return inreq;
+}
+
 /** Get index of next mailbox counter value.
  * Used for Mailbox Link Layer.
  * @param[in] cnt     = Mailbox counter value [0..7]
@@ -920,6 +1514,58 @@ uint8 ec_nextmbxcnt(uint8 cnt)
    return cnt;
 }
 
+/** Put little endian value of len bytes in a byte image and advance pos.
+ * Used for the binary cache and configuration images.
+ *
+ * @param[out]    image    = image buffer
+ * @param[in]     size     = size of image buffer in bytes
+ * @param[in,out] pos      = write position in image
+ * @param[in]     len      = number of bytes, 1 to 4
+ * @param[in]     val      = value to put
+ * @return 1 on success, 0 when image buffer is too small
+ */
+int ec_image_put(uint8 *image, int size, int *pos, int len, uint32 val)
+{
+   int lp;
+
+   if ((*pos + len) > size)
+   {
+      return 0;
+   }
+   for (lp = 0; lp < len; lp++)
+   {
+      image[(*pos)++] = (uint8)(val & 0xff);
+      val >>= 8;
+   }
+   return 1;
+}
+
+/** Get little endian value of len bytes from a byte image and advance pos.
+ *
+ * @param[in]     image    = image buffer
+ * @param[in]     size     = size of image in bytes
+ * @param[in,out] pos      = read position in image
+ * @param[in]     len      = number of bytes, 1 to 4
+ * @param[out]    val      = value read, untouched when image is exhausted
+ * @return 1 on success, 0 when image is exhausted
+ */
+int ec_image_get(const uint8 *image, int size, int *pos, int len, uint32 *val)
+{
+   int lp;
+
+   if ((*pos + len) > size)
+   {
+      return 0;
+   }
+   *val = 0;
+   for (lp = len - 1; lp >= 0; lp--)
+   {
+      *val = (*val << 8) | image[*pos + lp];
+   }
+   *pos += len;
+   return 1;
+}
+
 /** Clear mailbox buffer.
  * @param[out] Mbx     = Mailbox buffer to clear
  */
@@ -928,6 +1574,107 @@ void ec_clearmbx(ec_mbxbuft *Mbx)
     memset(Mbx, 0x00, EC_MAXMBX);
 }
 
+/** Time in us since start.
+ *
+ * @param[in] start    = start time, f.e. from osal_current_time()
+ * @return elapsed time in us
+ */
+uint32 ec_elapsed(ec_timet *start)
+{
+   ec_timet now, diff;
+
+   now = osal_current_time();
+   osal_time_diff(start, &now, &diff);
+
+   return diff.sec * 1000000 + diff.usec;
+}
+
+/* Wait before first read mailbox poll until the learned turnaround of the
+ * slave is almost over. Returns delay before next poll.
+ */
+static int ecx_mbxpollstart(ec_mbxstatt *stat, int timeout)
+{
+   uint32 elapsed, wait;
+
+   if (!stat->avgtime)
+   {
+      return EC_MBXPOLLMIN;
+   }
+   if (stat->pending && (timeout > (int)stat->avgtime))
+   {
+      elapsed = ec_elapsed(&(stat->sendtime));
+      wait = (stat->avgtime * 3) / 4;
+      if (wait > elapsed)
+      {
+         osal_usleep(wait - elapsed);
+      }
+   }
+   if ((stat->avgtime / 8) > EC_MBXPOLLMAX)
+   {
+      return EC_MBXPOLLMAX;
+   }
+   if ((stat->avgtime / 8) > EC_MBXPOLLMIN)
+   {
+      return (int)(stat->avgtime / 8);
+   }
+   return EC_MBXPOLLMIN;
+}
+
+/* Sleep delay and return the doubled delay for the next poll */
+static int ecx_mbxbackoff(int delay)
+{
+   osal_usleep(delay);
+   delay *= 2;
+   if (delay > EC_MBXPOLLMAX)
+   {
+      delay = EC_MBXPOLLMAX;
+   }
+   return delay;
+}
+
+/* Learn turnaround of request written by ecx_mbxsend(). Samples longer
+ * than the receive timeout belong to an earlier, timed out request.
+ */
+static void ecx_mbxlearn(ec_mbxstatt *stat, int timeout)
+{
+   uint32 time;
+
+   if (!stat->pending)
+   {
+      return;
+   }
+   stat->pending = FALSE;
+   time = ec_elapsed(&(stat->sendtime));
+   if ((timeout > 0) && (time > (uint32)timeout))
+   {
+      return;
+   }
+   if (!stat->count)
+   {
+      stat->avgtime = time;
+      stat->mintime = time;
+      stat->maxtime = time;
+   }
+   else
+   {
+      /* moving average over about 8 responses */
+      stat->avgtime = (stat->avgtime * 7 + time) / 8;
+      if (time < stat->mintime)
+      {
+         stat->mintime = time;
+      }
+      if (time > stat->maxtime)
+      {
+         stat->maxtime = time;
+      }
+   }
+   if (!stat->avgtime)
+   {
+      stat->avgtime = 1;
+   }
+   stat->count++;
+}
+
 /** Check if IN mailbox of slave is empty.
  * @param[in] context  = context struct
  * @param[in] slave    = Slave number
@@ -936,21 +1683,21 @@ void ec_clearmbx(ec_mbxbuft *Mbx)
  */
 int ecx_mbxempty(ecx_contextt *context, uint16 slave, int timeout)
 {
-   uint16 configadr;
    uint8 SMstat;
-   int wkc;
+   int wkc, delay;
    osal_timert timer;
 
    osal_timer_start(&timer, timeout);
-   configadr = context->slavelist[slave].configadr;
+   delay = EC_MBXPOLLMIN;
    do
    {
       SMstat = 0;
-      wkc = ecx_FPRD(context->port, configadr, ECT_REG_SM0STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+      wkc = ecx_mbxdgram(context, slave, EC_CMD_FPRD, ECT_REG_SM0STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
       SMstat = etohs(SMstat);
-      if (((SMstat & 0x08) != 0) && (timeout > EC_LOCALDELAY))
+      context->slavelist[slave].mbxstat.polls++;
+      if (((SMstat & 0x08) != 0) && (timeout > delay))
       {
-         osal_usleep(EC_LOCALDELAY);
+         delay = ecx_mbxbackoff(delay);
       }
    }
    while (((wkc <= 0) || ((SMstat & 0x08) != 0)) && (osal_timer_is_expired(&timer) == FALSE));
@@ -968,15 +1715,16 @@ int ecx_mbxempty(ecx_contextt *context, uint16 slave, int timeout)
  * @param[in]  slave      = Slave number
  * @param[out] mbx        = Mailbox data
  * @param[in]  timeout    = Timeout in us
- * @return Work counter (>0 is success)
+ * @return Work counter (>0 is success), EC_UNCERTAIN if the write may have
+ * reached the slave, it must not be sent again then
  */
 int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout)
 {
-   uint16 mbxwo,mbxl,configadr;
+   uint16 mbxwo,mbxl;
+   uint8 SMstat;
    int wkc;
 
    wkc = 0;
-   configadr = context->slavelist[slave].configadr;
    mbxl = context->slavelist[slave].mbx_l;
    if ((mbxl > 0) && (mbxl <= EC_MAXMBX))
    {
@@ -984,7 +1732,22 @@ int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout
       {
          mbxwo = context->slavelist[slave].mbx_wo;
          /* write slave in mailbox */
-         wkc = ecx_FPWR(context->port, configadr, mbxwo, mbxl, mbx, EC_TIMEOUTRET3);
+         wkc = ecx_mbxdgram(context, slave, EC_CMD_FPWR, mbxwo, mbxl, mbx, EC_TIMEOUTRET3);
+         if (wkc == EC_UNCERTAIN)
+         {
+            /* a full mailbox was empty before, so the write arrived */
+            SMstat = 0;
+            if ((ecx_mbxdgram(context, slave, EC_CMD_FPRD, ECT_REG_SM0STAT, sizeof(SMstat), &SMstat,
+                              EC_TIMEOUTRET) > 0) && (SMstat & 0x08))
+            {
+               wkc = 1;
+            }
+         }
+         if (wkc > 0)
+         {
+            context->slavelist[slave].mbxstat.sendtime = osal_current_time();
+            context->slavelist[slave].mbxstat.pending = TRUE;
+         }
       }
       else
       {
@@ -995,8 +1758,94 @@ int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout
    return wkc;
 }
 
+/** Handle mailbox responses that are not addressed to the mailbox user.
+ * Mailbox errors and CoE emergencies are put on the error stack, EoE
+ * fragments are passed to the EoE hook.
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @param[in]  mbx        = Mailbox data read from slave
+ * @return 1 if response is handled here, 0 if it belongs to the mailbox user
+ */
+int ecx_mbxhandler(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx)
+{
+   ec_mbxheadert *mbxh;
+   ec_emcyt *EMp;
+   ec_mbxerrort *MBXEp;
+
+   mbxh = (ec_mbxheadert *)mbx;
+   if ((mbxh->mbxtype & 0x0f) == 0x00) /* Mailbox error response? */
+   {
+      MBXEp = (ec_mbxerrort *)mbx;
+      ecx_mbxerror(context, slave, etohs(MBXEp->Detail));
+      return 1;
+   }
+   else if ((mbxh->mbxtype & 0x0f) == ECT_MBXT_COE) /* CoE response? */
+   {
+      EMp = (ec_emcyt *)mbx;
+      if ((etohs(EMp->CANOpen) >> 12) == 0x01) /* Emergency request? */
+      {
+         ecx_mbxemergencyerror(context, slave, etohs(EMp->ErrorCode), EMp->ErrorReg,
+                 EMp->bData, etohs(EMp->w1), etohs(EMp->w2));
+         return 1;
+      }
+   }
+   else if ((mbxh->mbxtype & 0x0f) == ECT_MBXT_EOE) /* EoE response? */
+   {
+      ec_EOEt * eoembx = (ec_EOEt *)mbx;
+      uint16 frameinfo1 = etohs(eoembx->frameinfo1);
+      /* All non fragment data frame types are expected to be handled by
+      * slave send/receive API if the EoE hook is set
+      */
+      if (EOE_HDR_FRAME_TYPE_GET(frameinfo1) == EOE_FRAG_DATA)
+      {
+         if (context->EOEhook)
+         {
+            if (context->EOEhook(context, slave, eoembx) > 0)
+            {
+               /* Fragment handled by EoE hook */
+               return 1;
+            }
+         }
+      }
+   }
+
+   return 0;
+}
+
+/** Check mailbox full flag of slave SM1 status mapped in processdata.
+ * The flag is only up to date while processdata is exchanged cyclically.
+ * @param[in]  context    = context struct
+ * @param[in]  slave      = Slave number
+ * @return 1 = read mailbox full, 0 = empty, -1 = status not mapped
+ */
+int ecx_mbxstatus(ecx_contextt *context, uint16 slave)
+{
+   ec_slavet *csl;
+
+   csl = &(context->slavelist[slave]);
+   if (!csl->mbxstatus)
+   {
+      return -1;
+   }
+
+   return (*(csl->mbxstatus) >> csl->mbxstatusbit) & 0x01;
+}
+
+/* Mapped mailbox status of group is refreshed by cyclic processdata */
+static boolean ecx_mbxstatus_recent(ec_groupt *grp)
+{
+   ec_timet now, diff;
+
+   now = osal_current_time();
+   osal_time_diff(&(grp->mbxstatustime), &now, &diff);
+
+   return ((diff.sec == 0) && (diff.usec < EC_MBXSTATUSAGE));
+}
+
 /** Read OUT mailbox from slave.
  * Supports Mailbox Link Layer with repeat requests.
+ * When the SM1 status is mapped in processdata and processdata is exchanged
+ * the mapped mailbox full flag is used instead of reading the SM1 status.
  * @param[in]  context    = context struct
  * @param[in]  slave      = Slave number
  * @param[out] mbx        = Mailbox data
@@ -1005,92 +1854,89 @@ int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout
  */
 int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int timeout)
 {
-   uint16 mbxro,mbxl,configadr;
+   uint16 mbxro,mbxl;
    int wkc=0;
    int wkc2;
    uint16 SMstat;
    uint8 SMcontr;
-   ec_mbxheadert *mbxh;
-   ec_emcyt *EMp;
-   ec_mbxerrort *MBXEp;
+   ec_groupt *grp;
+   uint32 cnt;
+   boolean mapped;
+   ec_mbxstatt *stat;
+   int delay;
 
-   configadr = context->slavelist[slave].configadr;
    mbxl = context->slavelist[slave].mbx_rl;
    if ((mbxl > 0) && (mbxl <= EC_MAXMBX))
    {
       osal_timert timer;
 
       osal_timer_start(&timer, timeout);
+      grp = &(context->grouplist[context->slavelist[slave].group]);
+      cnt = grp->mbxstatuscnt;
+      stat = &(context->slavelist[slave].mbxstat);
+      delay = ecx_mbxpollstart(stat, timeout);
       wkc = 0;
       do /* wait for read mailbox available */
       {
          SMstat = 0;
-         wkc = ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
-         SMstat = etohs(SMstat);
-         if (((SMstat & 0x08) == 0) && (timeout > EC_LOCALDELAY))
+         mapped = context->slavelist[slave].mbxstatus && ecx_mbxstatus_recent(grp);
+         if (mapped)
          {
-            osal_usleep(EC_LOCALDELAY);
+            /* only status of a cycle sent after entry is valid */
+            wkc = ((grp->mbxstatuscnt - cnt) >= 2) ? 1 : 0;
+            if ((wkc > 0) && (ecx_mbxstatus(context, slave) > 0))
+            {
+               SMstat = 0x08;
+            }
+         }
+         else
+         {
+            wkc = ecx_mbxdgram(context, slave, EC_CMD_FPRD, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+            SMstat = etohs(SMstat);
+            stat->polls++;
+         }
+         if (((SMstat & 0x08) == 0) && (timeout > delay))
+         {
+            delay = ecx_mbxbackoff(delay);
          }
       }
       while (((wkc <= 0) || ((SMstat & 0x08) == 0)) && (osal_timer_is_expired(&timer) == FALSE));
 
       if ((wkc > 0) && ((SMstat & 0x08) > 0)) /* read mailbox available ? */
       {
+         ecx_mbxlearn(stat, timeout);
          mbxro = context->slavelist[slave].mbx_ro;
-         mbxh = (ec_mbxheadert *)mbx;
          do
          {
-            wkc = ecx_FPRD(context->port, configadr, mbxro, mbxl, mbx, EC_TIMEOUTRET); /* get mailbox */
-            if ((wkc > 0) && ((mbxh->mbxtype & 0x0f) == 0x00)) /* Mailbox error response? */
+            wkc = ecx_mbxdgram(context, slave, EC_CMD_FPRD, mbxro, mbxl, mbx, EC_TIMEOUTRET); /* get mailbox */
+            if (wkc > 0)
             {
-               MBXEp = (ec_mbxerrort *)mbx;
-               ecx_mbxerror(context, slave, etohs(MBXEp->Detail));
-               wkc = 0; /* prevent emergency to cascade up, it is already handled. */
-            }
-            else if ((wkc > 0) && ((mbxh->mbxtype & 0x0f) == ECT_MBXT_COE)) /* CoE response? */
-            {
-               EMp = (ec_emcyt *)mbx;
-               if ((etohs(EMp->CANOpen) >> 12) == 0x01) /* Emergency request? */
+               if (ecx_mbxhandler(context, slave, mbx))
                {
-                  ecx_mbxemergencyerror(context, slave, etohs(EMp->ErrorCode), EMp->ErrorReg,
-                          EMp->bData, etohs(EMp->w1), etohs(EMp->w2));
                   wkc = 0; /* prevent emergency to cascade up, it is already handled. */
                }
             }
-            else if ((wkc > 0) && ((mbxh->mbxtype & 0x0f) == ECT_MBXT_EOE)) /* EoE response? */
-            {
-               ec_EOEt * eoembx = (ec_EOEt *)mbx;
-               uint16 frameinfo1 = etohs(eoembx->frameinfo1);
-               /* All non fragment data frame types are expected to be handled by
-               * slave send/receive API if the EoE hook is set
-               */
-               if (EOE_HDR_FRAME_TYPE_GET(frameinfo1) == EOE_FRAG_DATA)
-               {
-                  if (context->EOEhook)
-                  {
-                     if (context->EOEhook(context, slave, eoembx) > 0)
-                     {
-                        /* Fragment handled by EoE hook */
-                        wkc = 0;
-                     }
-                  }
-               }
-            }
             else
             {
                if (wkc <= 0) /* read mailbox lost */
                {
+                  if (mapped) /* repeat request needs the real SM1 status */
+                  {
+                     ecx_mbxdgram(context, slave, EC_CMD_FPRD, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+                     SMstat = etohs(SMstat);
+                     mapped = FALSE;
+                  }
                   SMstat ^= 0x0200; /* toggle repeat request */
                   SMstat = htoes(SMstat);
-                  wkc2 = ecx_FPWR(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+                  wkc2 = ecx_mbxdgram(context, slave, EC_CMD_FPWR, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
                   SMstat = etohs(SMstat);
                   do /* wait for toggle ack */
                   {
-                     wkc2 = ecx_FPRD(context->port, configadr, ECT_REG_SM1CONTR, sizeof(SMcontr), &SMcontr, EC_TIMEOUTRET);
+                     wkc2 = ecx_mbxdgram(context, slave, EC_CMD_FPRD, ECT_REG_SM1CONTR, sizeof(SMcontr), &SMcontr, EC_TIMEOUTRET);
                    } while (((wkc2 <= 0) || ((SMcontr & 0x02) != (HI_BYTE(SMstat) & 0x02))) && (osal_timer_is_expired(&timer) == FALSE));
                   do /* wait for read mailbox available */
                   {
-                     wkc2 = ecx_FPRD(context->port, configadr, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+                     wkc2 = ecx_mbxdgram(context, slave, EC_CMD_FPRD, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
                      SMstat = etohs(SMstat);
                      if (((SMstat & 0x08) == 0) && (timeout > EC_LOCALDELAY))
                      {
@@ -1103,6 +1949,8 @@ int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int tim
       }
       else /* no read mailbox available */
       {
+         /* turnaround of this request is unknown, do not learn it later */
+         stat->pending = FALSE;
          if (wkc > 0)
             wkc = EC_TIMEOUT;
       }
@@ -1182,6 +2030,7 @@ int ecx_writeeeprom(ecx_contextt *context, uint16 slave, uint16 eeproma, uint16
 
    ecx_eeprom2master(context, slave); /* set eeprom control to master */
    configadr = context->slavelist[slave].configadr;
+   ecx_siiinvalidate(context, slave); /* cached SII of slave is outdated */
    return (ecx_writeeepromFP(context, configadr, eeproma, data, timeout));
 }
 
@@ -1689,6 +2538,46 @@ static void ecx_clearindex(ecx_contextt *context)  {
 
 }
 
+/** Add the DC datagrams to a processdata frame. The FRMW distributes the
+ * system time of the reference slave, with a master clock as time base it
+ * is preceded by a FPWR of the master time to the reference slave. The DC
+ * health monitor appends its samples after the FRMW.
+ * @param[in]  context        = context struct
+ * @param[in]  idx            = index of frame
+ * @param[in]  group          = group number
+ * @return Offset of FRMW data in frame.
+ */
+static uint16 ecx_adddcdatagrams(ecx_contextt *context, uint8 idx, uint8 group)
+{
+   uint16 configadr, DCO;
+   int64 le_mastertime;
+
+   configadr = context->slavelist[context->grouplist[group].DCnext].configadr;
+   /* master time is only written if the FPWR and FRMW both fit in the frame */
+   if (context->dcmaster &&
+       ((context->port->txbuflength[idx] + 2 * EC_FIRSTDCDATAGRAM) > EC_MAXFRAMELENGTH))
+   {
+      context->dcmaster->nospace++;
+      context->dcmaster->carried = FALSE;
+   }
+   else if (context->dcmaster)
+   {
+      context->dcmaster->mastertime = ecx_dcmaster_time(context);
+      le_mastertime = htoell(context->dcmaster->mastertime + context->dcmaster->delay);
+      (void)ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FPWR, idx, TRUE,
+                            configadr, ECT_REG_DCSYSTIME, sizeof(int64), &le_mastertime);
+      context->dcmaster->writes++;
+      context->dcmaster->idx = idx;
+      context->dcmaster->carried = TRUE;
+   }
+   DCO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
+                         configadr, ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+   /* DC health monitor samples ride along with the DC datagram */
+   ecx_dcmonitor_append(context, idx);
+
+   return DCO;
+}
+
 /** Transmit processdata to slaves.
  * Uses LRW, or LRD/LWR if LRW is not allowed (blockLRW).
  * Both the input and output processdata are transmitted.
@@ -1772,11 +2661,11 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
                if(first)
                {
                   /* FPRMW in second datagram */
-                  DCO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
-                                           context->slavelist[context->grouplist[group].DCnext].configadr,
-                                           ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+                  DCO = ecx_adddcdatagrams(context, idx, group);
                   first = FALSE;
                }
+               /* queued mailbox datagrams use free space in frame */
+               ecx_mbxdgq_append(context, idx);
                /* send frame */
                ecx_outframe_red(context->port, idx);
                /* push index and data pointer on stack */
@@ -1810,11 +2699,11 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
                if(first)
                {
                   /* FPRMW in second datagram */
-                  DCO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
-                                           context->slavelist[context->grouplist[group].DCnext].configadr,
-                                           ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+                  DCO = ecx_adddcdatagrams(context, idx, group);
                   first = FALSE;
                }
+               /* queued mailbox datagrams use free space in frame */
+               ecx_mbxdgq_append(context, idx);
                /* send frame */
                ecx_outframe_red(context->port, idx);
                /* push index and data pointer on stack */
@@ -1851,11 +2740,11 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
             if(first)
             {
                /* FPRMW in second datagram */
-               DCO = ecx_adddatagram(context->port, &(context->port->txbuf[idx]), EC_CMD_FRMW, idx, FALSE,
-                                        context->slavelist[context->grouplist[group].DCnext].configadr,
-                                        ECT_REG_DCSYSTIME, sizeof(int64), context->DCtime);
+               DCO = ecx_adddcdatagrams(context, idx, group);
                first = FALSE;
             }
+            /* queued mailbox datagrams use free space in frame */
+            ecx_mbxdgq_append(context, idx);
             /* send frame */
             ecx_outframe_red(context->port, idx);
             /* push index and data pointer on stack.
@@ -1869,6 +2758,7 @@ static int ecx_main_send_processdata(ecx_contextt *context, uint8 group, boolean
             data += sublength;
          } while (length && (currentsegment < context->grouplist[group].nsegments));
       }
+      ecx_mbxdgq_flush(context);
    }
 
    return wkc;
@@ -1908,6 +2798,21 @@ int ecx_send_processdata_group(ecx_contextt *context, uint8 group)
    return ecx_main_send_processdata(context, group, FALSE);
 }
 
+/* Deviation of the reference slave from the master time, only for the
+ * frame that carried the master time write.
+ */
+static void ecx_dcmaster_receive(ecx_contextt *context, uint8 idx)
+{
+   ec_dcmastert *dcmaster;
+
+   dcmaster = context->dcmaster;
+   if (dcmaster && dcmaster->carried && (dcmaster->idx == idx))
+   {
+      dcmaster->deviation = *(context->DCtime) - (dcmaster->mastertime + dcmaster->delay);
+      dcmaster->carried = FALSE;
+   }
+}
+
 /** Receive processdata from slaves.
  * Second part from ec_send_processdata().
  * Received datagrams are recombined with the processdata with help from the stack.
@@ -1952,12 +2857,15 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
                wkc = etohs(le_wkc);
                memcpy(&le_DCtime, &(rxbuf[idx][idxstack->dcoffset[pos]]), sizeof(le_DCtime));
                *(context->DCtime) = etohll(le_DCtime);
+               ecx_dcmaster_receive(context, idx);
             }
             else
             {
                /* copy input data back to process data buffer */
                memcpy(idxstack->data[pos], &(rxbuf[idx][EC_HEADERSIZE]), idxstack->length[pos]);
-               wkc += wkc2;
+               /* frame may carry mailbox datagrams, use WKC of processdata datagram */
+               memcpy(&le_wkc, &(rxbuf[idx][EC_HEADERSIZE + idxstack->length[pos]]), EC_WKCSIZE);
+               wkc += etohs(le_wkc);
             }
             valid_wkc = 1;
          }
@@ -1970,15 +2878,21 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
                wkc = etohs(le_wkc) * 2;
                memcpy(&le_DCtime, &(rxbuf[idx][idxstack->dcoffset[pos]]), sizeof(le_DCtime));
                *(context->DCtime) = etohll(le_DCtime);
+               ecx_dcmaster_receive(context, idx);
             }
             else
             {
+               memcpy(&le_wkc, &(rxbuf[idx][EC_HEADERSIZE + idxstack->length[pos]]), EC_WKCSIZE);
                /* output WKC counts 2 times when using LRW, emulate the same for LWR */
-               wkc += wkc2 * 2;
+               wkc += etohs(le_wkc) * 2;
             }
             valid_wkc = 1;
          }
       }
+      /* return results of mailbox datagrams carried by frame */
+      ecx_mbxdgq_receive(context, idx, wkc2);
+      /* return DC health monitor samples carried by frame */
+      ecx_dcmonitor_receive(context, idx, wkc2);
       /* release buffer */
       ecx_setbufstat(context->port, idx, EC_BUF_EMPTY);
       /* get next index */
@@ -1992,6 +2906,12 @@ int ecx_receive_processdata_group(ecx_contextt *context, uint8 group, int timeou
    {
       return EC_NOFRAME;
    }
+   /* mark mapped mailbox status as up to date */
+   if (context->grouplist[group].mbxstatusmap)
+   {
+      context->grouplist[group].mbxstatuscnt++;
+      context->grouplist[group].mbxstatustime = osal_current_time();
+   }
    return wkc;
 }
 
@@ -2085,6 +3005,36 @@ int16 ec_siifind(uint16 slave, uint16 cat)
    return ecx_siifind (&ecx_context, slave, cat);
 }
 
+/** Build SII category index of slave.
+ *  @param[in] slave   = slave number
+ *  @return number of categories found
+ *  @see ecx_siiindex
+ */
+int ec_siiindex(uint16 slave)
+{
+   return ecx_siiindex (&ecx_context, slave);
+}
+
+/** Drop SII category index and cached SII bytes of slave.
+ *  @param[in] slave   = slave number, 0 = all slaves
+ *  @see ecx_siiinvalidate
+ */
+void ec_siiinvalidate(uint16 slave)
+{
+   ecx_siiinvalidate (&ecx_context, slave);
+}
+
+/** Read an area of the SII of all slaves in parallel into the SII cache.
+ *  @param[in] address = eeprom address in bytes of area
+ *  @param[in] length  = length of area in bytes
+ *  @return number of slaves read
+ *  @see ecx_siicache_warm
+ */
+int ec_siicache_warm(uint16 address, uint16 length)
+{
+   return ecx_siicache_warm (&ecx_context, address, length);
+}
+
 /** Get string from SII string section in slave EEPROM.
  *  @param[out] str    = requested string, 0x00 if not found
  *  @param[in]  slave  = slave number
@@ -2182,6 +3132,31 @@ uint16 ec_statecheck(uint16 slave, uint16 reqstate, int timeout)
    return ecx_statecheck (&ecx_context, slave, reqstate, timeout);
 }
 
+/** Write the same requested state to a list of slaves.
+ * @param[in] n        = number of slaves in slavelst
+ * @param[in] slavelst = list of slave numbers
+ * @param[in] reqstate = requested state
+ * @return number of slaves that acknowledged the write
+ * @see ecx_writestate_multi
+ */
+int ec_writestate_multi(int n, uint16 *slavelst, uint16 reqstate, int timeout)
+{
+   return ecx_writestate_multi(&ecx_context, n, slavelst, reqstate, timeout);
+}
+
+/** Check actual state of a list of slaves.
+ * @param[in] n        = number of slaves in slavelst
+ * @param[in] slavelst = list of slave numbers
+ * @param[in] reqstate = requested state
+ * @param[in] timeout  = Timeout value in us
+ * @return number of slaves that are in the requested state
+ * @see ecx_statecheck_multi
+ */
+int ec_statecheck_multi(int n, uint16 *slavelst, uint16 reqstate, int timeout)
+{
+   return ecx_statecheck_multi(&ecx_context, n, slavelst, reqstate, timeout);
+}
+
 /** Check if IN mailbox of slave is empty.
  * @param[in] slave    = Slave number
  * @param[in] timeout  = Timeout in us
@@ -2218,6 +3193,16 @@ int ec_mbxreceive(uint16 slave, ec_mbxbuft *mbx, int timeout)
    return ecx_mbxreceive (&ecx_context, slave, mbx, timeout);
 }
 
+/** Check mailbox full flag of slave SM1 status mapped in processdata.
+ * @param[in]  slave      = Slave number
+ * @return 1 = read mailbox full, 0 = empty, -1 = status not mapped
+ * @see ecx_mbxstatus
+ */
+int ec_mbxstatus(uint16 slave)
+{
+   return ecx_mbxstatus(&ecx_context, slave);
+}
+
 /** Dump complete EEPROM data from slave in buffer.
  * @param[in]  slave    = Slave number
  * @param[out] esibuf   = EEPROM data buffer, make sure it is big enough.
@@ -35,10 +35,18 @@ extern "C"
 #define EC_MAXSM          8
 /** max. FMMU used */
 #define EC_MAXFMMU        4
+/** max. SII categories in SII category index */
+#define EC_MAXSIICAT      32
+/** size in bytes of one page in the SII cache */
+#define EC_SIIPAGESIZE    64
+/** max. pages in the SII cache, shared by all slaves */
+#define EC_MAXSIIPAGE     256
 /** max. Adapter */
 #define EC_MAXLEN_ADAPTERNAME    128
 /** define maximum number of concurrent threads in mapping */
 #define EC_MAX_MAPT           1
+/** define maximum number of concurrent threads running PO2SO hooks, 1 = serialised */
+#define EC_MAX_HOOKT          1
 
 typedef struct ec_adapter ec_adaptert;
 struct ec_adapter
@@ -101,6 +109,37 @@ PACKED_END
 #define EC_SMENABLEMASK      0xfffeffff
 
 typedef struct ecx_context ecx_contextt;
+typedef struct ec_eni ec_enit;
+typedef struct ec_profile ec_profilet;
+typedef struct ec_mbxengine ec_mbxenginet;
+typedef struct ec_mbxdgqueue ec_mbxdgqueuet;
+typedef struct ec_mbxservice ec_mbxservicet;
+typedef struct ec_eventstream ec_eventstreamt;
+typedef struct ec_IDNcache ec_IDNcachet;
+typedef struct ec_dcmaster ec_dcmastert;
+typedef struct ec_dcmonitor ec_dcmonitort;
+typedef struct ec_dcwork ec_dcworkt;
+
+/** Mailbox turnaround statistics of a slave, learned by ecx_mbxsend() and
+ * ecx_mbxreceive() and used to schedule the read mailbox polls.
+ */
+typedef struct
+{
+   /** learned typical turnaround in us, 0 = not learned yet */
+   uint32           avgtime;
+   /** shortest turnaround in us */
+   uint32           mintime;
+   /** longest turnaround in us */
+   uint32           maxtime;
+   /** number of measured turnarounds */
+   uint32           count;
+   /** number of mailbox status polls */
+   uint32           polls;
+   /** internal, request written and response not yet received */
+   boolean          pending;
+   /** internal, time the last request was written */
+   ec_timet         sendtime;
+} ec_mbxstatt;
 
 /** for list of ethercat slaves detected */
 typedef struct ec_slave
@@ -203,6 +242,8 @@ typedef struct ec_slave
    uint8            DCactive;
    /** link to config table */
    uint16           configindex;
+   /** 1 = configured from ENI image, mapping is not read from slave */
+   uint8            eniconfig;
    /** link to SII config */
    uint16           SIIindex;
    /** 1 = 8 bytes per read, 0 = 4 bytes per read */
@@ -225,6 +266,16 @@ typedef struct ec_slave
    uint8            group;
    /** first unused FMMU */
    uint8            FMMUunused;
+   /** SM1 status mapped in IOmap, NULL = not mapped */
+   uint8            *mbxstatus;
+   /** bit of SM1 mailbox full flag in mbxstatus */
+   uint8            mbxstatusbit;
+   /** mailbox turnaround statistics */
+   ec_mbxstatt      mbxstat;
+   /** mailbox is configured as bootstrap mailbox, see ecx_config_bootmbx() */
+   boolean          bootmbx;
+   /** last AoE invoke ID of slave, only changed with osal_atomic_cas() */
+   volatile int32   AoEinvokeid;
    /** Boolean for tracking whether the slave is (not) responding, not used/set by the SOEM library */
    boolean          islost;
    /** registered configuration function PO->SO, (DEPRECATED)*/
@@ -268,6 +319,12 @@ typedef struct ec_group
    uint16           inputsWKC;
    /** check slave states */
    boolean          docheckstate;
+   /** map SM1 status of mailbox slaves in IOmap, set before ecx_config_map_group() */
+   boolean          mbxstatusmap;
+   /** number of processdata receives with mapped mailbox status */
+   uint32           mbxstatuscnt;
+   /** time of last processdata receive with mapped mailbox status */
+   ec_timet         mbxstatustime;
    /** IO segmentation list. Datagrams must not break SM in two. */
    uint32           IOsegment[EC_MAXIOSEGMENTS];
 } ec_groupt;
@@ -308,6 +365,45 @@ typedef struct ec_eepromPDO
    uint16  SMbitsize[EC_MAXSM];
 } ec_eepromPDOt;
 
+/** SII category index of one slave, built in one pass over the category chain */
+typedef struct ec_siiindex
+{
+   /** TRUE if index is built */
+   boolean valid;
+   /** number of categories in index */
+   uint8   ncat;
+   /** category type */
+   uint16  cat[EC_MAXSIICAT];
+   /** byte address of category at section length entry */
+   uint16  addr[EC_MAXSIICAT];
+} ec_siiindext;
+
+/** one page of cached SII bytes of a slave */
+typedef struct ec_siipage
+{
+   /** owner slave, 0 = page is free */
+   uint16  slave;
+   /** page number, byte address / EC_SIIPAGESIZE */
+   uint16  page;
+   /** last use stamp for LRU replacement */
+   uint32  lru;
+   /** bitmap of valid bytes in data */
+   uint64  map;
+   /** cached SII bytes */
+   uint8   data[EC_SIIPAGESIZE];
+} ec_siipaget;
+
+/** SII cache for multiple slaves, sparse pages with LRU replacement */
+typedef struct ec_siicache
+{
+   /** use stamp counter */
+   uint32      stamp;
+   /** index of last used page, lookup hint */
+   uint16      last;
+   /** page pool */
+   ec_siipaget page[EC_MAXSIIPAGE];
+} ec_siicachet;
+
 /** mailbox buffer array */
 typedef uint8 ec_mbxbuft[EC_MAXMBX + 1];
 
@@ -351,6 +447,39 @@ typedef struct ec_ering
    ec_errort Error[EC_MAXELIST + 1];
 } ec_eringt;
 
+/** number of error types counted by the event stream */
+#define EC_EVENTTYPES     (EC_ERR_TYPE_DC_ALARM + 1)
+
+/** Event stream, a ring of errors sized by the application. All errors
+ * pushed by ecx_pusherror() are also put in the stream. When the ring is
+ * full new events are dropped and counted, so the first events of a burst
+ * are kept. Errors are pushed from any thread, f.e. application SDO
+ * threads, the mailbox service and the processdata thread, so access to
+ * the ring is serialised by a mutex. On ports without mutex errors must
+ * come from one thread. Events are popped by one thread.
+ */
+struct ec_eventstream
+{
+   /** event buffer, size entries */
+   ec_errort         *event;
+   /** number of entries, must be a power of 2 */
+   uint32            size;
+   /** next free entry */
+   uint32            head;
+   /** next entry to pop */
+   uint32            tail;
+   /** number of events put in the stream */
+   uint32            count;
+   /** number of events dropped because the stream was full */
+   uint32            dropped;
+   /** dropped events per error type */
+   uint32            droppedtype[EC_EVENTTYPES];
+   /** called by ecx_event_dispatch() for every event, NULL = none */
+   void              (*callback)(ecx_contextt *context, const ec_errort *event);
+   /** internal, serialises access to the ring, NULL on ports without mutex */
+   void              *mutex;
+};
+
 /** SyncManager Communication Type structure for CA */
 PACKED_BEGIN
 typedef struct PACKED ec_SMcommtype
@@ -429,6 +558,30 @@ struct ecx_context
    /** userdata, promotes application configuration esp. in EC_VER2 with multiple 
     * ec_context instances. Note: userdata memory is managed by application, not SOEM */
    void           *userdata;
+   /** internal, ENI configuration storage for ecx_config_from_eni() */
+   ec_enit        *eni;
+   /** startup profile report, NULL = profiling disabled */
+   ec_profilet    *profile;
+   /** internal, SII category index per slave, maxslave entries, NULL = no index */
+   ec_siiindext   *siiindex;
+   /** internal, SII cache for multiple slaves, NULL = use single slave esibuf */
+   ec_siicachet   *siicache;
+   /** internal, asynchronous mailbox engine, NULL = not available */
+   ec_mbxenginet  *mbxengine;
+   /** internal, mailbox datagrams carried by processdata frames, NULL = not available */
+   ec_mbxdgqueuet *mbxdgqueue;
+   /** internal, mailbox service for application threads, NULL = not available */
+   ec_mbxservicet *mbxservice;
+   /** event stream, see ecx_event_init(), NULL (default) = errors only in elist */
+   ec_eventstreamt *eventstream;
+   /** SoE AT / MDT mapping cache used by ecx_readIDNmap(), NULL (default) = no cache */
+   ec_IDNcachet   *idncache;
+   /** master clock as DC time base, see ecx_dcmaster_init(), NULL (default) = reference slave is time base */
+   ec_dcmastert   *dcmaster;
+   /** DC health monitor, see ecx_dcmonitor_init(), NULL (default) = no monitor */
+   ec_dcmonitort  *dcmonitor;
+   /** internal, work area of ecx_configdc_avg(), NULL = on the stack, about 7 kB */
+   ec_dcworkt     *dcwork;
 };
 
 #ifdef EC_VER1
@@ -452,6 +605,9 @@ int ec_init_redundant(const char *ifname, char *if2name);
 void ec_close(void);
 uint8 ec_siigetbyte(uint16 slave, uint16 address);
 int16 ec_siifind(uint16 slave, uint16 cat);
+int ec_siiindex(uint16 slave);
+void ec_siiinvalidate(uint16 slave);
+int ec_siicache_warm(uint16 address, uint16 length);
 void ec_siistring(char *str, uint16 slave, uint16 Sn);
 uint16 ec_siiFMMU(uint16 slave, ec_eepromFMMUt* FMMU);
 uint16 ec_siiSM(uint16 slave, ec_eepromSMt* SM);
@@ -460,9 +616,12 @@ uint32 ec_siiPDO(uint16 slave, ec_eepromPDOt* PDO, uint8 t);
 int ec_readstate(void);
 int ec_writestate(uint16 slave);
 uint16 ec_statecheck(uint16 slave, uint16 reqstate, int timeout);
+int ec_writestate_multi(int n, uint16 *slavelst, uint16 reqstate, int timeout);
+int ec_statecheck_multi(int n, uint16 *slavelst, uint16 reqstate, int timeout);
 int ec_mbxempty(uint16 slave, int timeout);
 int ec_mbxsend(uint16 slave,ec_mbxbuft *mbx, int timeout);
 int ec_mbxreceive(uint16 slave, ec_mbxbuft *mbx, int timeout);
+int ec_mbxstatus(uint16 slave);
 void ec_esidump(uint16 slave, uint8 *esibuf);
 uint32 ec_readeeprom(uint16 slave, uint16 eeproma, int timeout);
 int ec_writeeeprom(uint16 slave, uint16 eeproma, uint16 data, int timeout);
@@ -486,15 +645,27 @@ ec_adaptert * ec_find_adapters(void);
 void ec_free_adapters(ec_adaptert * adapter);
 uint8 ec_nextmbxcnt(uint8 cnt);
 void ec_clearmbx(ec_mbxbuft *Mbx);
+int ec_image_put(uint8 *image, int size, int *pos, int len, uint32 val);
+int ec_image_get(const uint8 *image, int size, int *pos, int len, uint32 *val);
+uint32 ec_elapsed(ec_timet *start);
 void ecx_pusherror(ecx_contextt *context, const ec_errort *Ec);
 boolean ecx_poperror(ecx_contextt *context, ec_errort *Ec);
 boolean ecx_iserror(ecx_contextt *context);
+int ecx_event_init(ecx_contextt *context, ec_eventstreamt *stream, ec_errort *buffer, uint32 size,
+                   void (*callback)(ecx_contextt *context, const ec_errort *event));
+void ecx_event_close(ecx_contextt *context);
+boolean ecx_event_pop(ecx_contextt *context, ec_errort *event);
+int ecx_event_dispatch(ecx_contextt *context);
 void ecx_packeterror(ecx_contextt *context, uint16 Slave, uint16 Index, uint8 SubIdx, uint16 ErrorCode);
 int ecx_init(ecx_contextt *context, const char * ifname);
 int ecx_init_redundant(ecx_contextt *context, ecx_redportt *redport, const char *ifname, char *if2name);
 void ecx_close(ecx_contextt *context);
 uint8 ecx_siigetbyte(ecx_contextt *context, uint16 slave, uint16 address);
 int16 ecx_siifind(ecx_contextt *context, uint16 slave, uint16 cat);
+int ecx_siiindex(ecx_contextt *context, uint16 slave);
+void ecx_siiinvalidate(ecx_contextt *context, uint16 slave);
+void ecx_siicache_put(ecx_contextt *context, uint16 slave, uint16 address, uint8 *data, int length);
+int ecx_siicache_warm(ecx_contextt *context, uint16 address, uint16 length);
 void ecx_siistring(ecx_contextt *context, char *str, uint16 slave, uint16 Sn);
 uint16 ecx_siiFMMU(ecx_contextt *context, uint16 slave, ec_eepromFMMUt* FMMU);
 uint16 ecx_siiSM(ecx_contextt *context, uint16 slave, ec_eepromSMt* SM);
@@ -503,9 +674,13 @@ uint32 ecx_siiPDO(ecx_contextt *context, uint16 slave, ec_eepromPDOt* PDO, uint8
 int ecx_readstate(ecx_contextt *context);
 int ecx_writestate(ecx_contextt *context, uint16 slave);
 uint16 ecx_statecheck(ecx_contextt *context, uint16 slave, uint16 reqstate, int timeout);
+int ecx_writestate_multi(ecx_contextt *context, int n, uint16 *slavelst, uint16 reqstate, int timeout);
+int ecx_statecheck_multi(ecx_contextt *context, int n, uint16 *slavelst, uint16 reqstate, int timeout);
 int ecx_mbxempty(ecx_contextt *context, uint16 slave, int timeout);
 int ecx_mbxsend(ecx_contextt *context, uint16 slave,ec_mbxbuft *mbx, int timeout);
 int ecx_mbxreceive(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx, int timeout);
+int ecx_mbxhandler(ecx_contextt *context, uint16 slave, ec_mbxbuft *mbx);
+int ecx_mbxstatus(ecx_contextt *context, uint16 slave);
 void ecx_esidump(ecx_contextt *context, uint16 slave, uint8 *esibuf);
 uint32 ecx_readeeprom(ecx_contextt *context, uint16 slave, uint16 eeproma, int timeout);
 int ecx_writeeeprom(ecx_contextt *context, uint16 slave, uint16 eeproma, uint16 data, int timeout);
@@ -0,0 +1,933 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Asynchronous mailbox engine.
+ *
+ * Mailbox transactions of many slaves are kept in flight together. A single
+ * poll step reads the mailbox status of all slaves with an active transaction
+ * in multi datagram frames, then writes requests and reads responses of all
+ * slaves that are ready, again packed in as few frames as possible.
+ * Any mailbox protocol (CoE, FoE, SoE, EoE) can be run on top of it by
+ * submitting the protocol request and evaluating the response.
+ */
+
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatmbx.h"
+#include "ethercatcoe.h"
+
+/** delay in us between polls in ecx_mbxwait() */
+#define EC_MBXPOLLDELAY   200
+/** delay in us between checks for a cyclic mailbox datagram result */
+#define EC_MBXDGQDELAY    50
+/** max. age in us of last processdata send to use the cyclic queue */
+#define EC_MBXDGQAGE      10000
+/** max. time in us to wait for a cyclic mailbox datagram */
+#define EC_MBXDGQTIMEOUT  EC_TIMEOUTRET3
+/** delay in us of the service thread when no request is queued */
+#define EC_MBXSRVIDLE     500
+/** stack size of the service thread */
+#define EC_MBXSRVSTACK    128000
+
+/** Submit a mailbox transaction. The transaction is started by ecx_mbxpoll()
+ * as soon as all earlier transactions of the same slave are finished.
+ *
+ * @param[in]     context  = context struct
+ * @param[in,out] trans    = transaction, slave, mailboxes and timeout must be set
+ * @return 1 if submitted, 0 if slave has no mailbox or engine is not available
+ */
+int ecx_mbxsubmit(ecx_contextt *context, ec_mbxtranst *trans)
+{
+   ec_mbxenginet *eng;
+   ec_slavet *csl;
+   uint16 slave;
+
+   eng = context->mbxengine;
+   slave = trans->slave;
+   if (!eng || (slave == 0) || (slave > *(context->slavecount)) || (slave >= EC_MAXSLAVE))
+   {
+      return 0;
+   }
+   csl = &(context->slavelist[slave]);
+   if ((!trans->txmbx && !trans->rxmbx) ||
+       (trans->txmbx && ((csl->mbx_l == 0) || (csl->mbx_l > EC_MAXMBX))) ||
+       (trans->rxmbx && ((csl->mbx_rl == 0) || (csl->mbx_rl > EC_MAXMBX))))
+   {
+      return 0;
+   }
+   trans->state = EC_MBXTRANS_QUEUED;
+   trans->wkc = 0;
+   trans->next = NULL;
+   if (eng->tail[slave])
+   {
+      eng->tail[slave]->next = trans;
+   }
+   else
+   {
+      eng->head[slave] = trans;
+   }
+   eng->tail[slave] = trans;
+   eng->pending++;
+
+   return 1;
+}
+
+/* Finish active transaction of slave and call its completion callback */
+static void ecx_mbxfinish(ecx_contextt *context, uint16 slave, int state, int wkc)
+{
+   ec_mbxenginet *eng;
+   ec_mbxtranst *trans;
+
+   eng = context->mbxengine;
+   trans = eng->head[slave];
+   eng->head[slave] = trans->next;
+   if (!eng->head[slave])
+   {
+      eng->tail[slave] = NULL;
+   }
+   trans->next = NULL;
+   trans->state = state;
+   trans->wkc = wkc;
+   eng->pending--;
+   if (trans->complete)
+   {
+      trans->complete(context, trans);
+   }
+}
+
+/** Drive all outstanding mailbox transactions one step. Reads the mailbox
+ * status of all slaves with an active transaction, then writes requests to
+ * empty write mailboxes and reads responses from full read mailboxes.
+ * Stale responses found before a request is written are discarded, mailbox
+ * errors, emergencies and EoE fragments are handled as in ecx_mbxreceive().
+ * Must be called from one thread only.
+ *
+ * @param[in]  context  = context struct
+ * @return number of transactions not finished
+ */
+int ecx_mbxpoll(ecx_contextt *context)
+{
+   ec_mbxenginet *eng;
+   ec_mbxtranst *trans;
+   ec_slavet *csl;
+   ec_dgramt *dg;
+   uint16 slave, SMstat;
+   int n, na, lp, la;
+   uint8 *stat;
+
+   eng = context->mbxengine;
+   if (!eng || !eng->pending)
+   {
+      return 0;
+   }
+   /* start queued transactions and expire timed out ones */
+   n = 0;
+   for (slave = 1; (slave <= *(context->slavecount)) && (slave < EC_MAXSLAVE); slave++)
+   {
+      trans = eng->head[slave];
+      if (!trans)
+      {
+         continue;
+      }
+      if (trans->state == EC_MBXTRANS_QUEUED)
+      {
+         trans->state = trans->txmbx ? EC_MBXTRANS_SEND : EC_MBXTRANS_RECEIVE;
+         osal_timer_start(&trans->timer, trans->timeout);
+      }
+      else if (osal_timer_is_expired(&trans->timer))
+      {
+         ecx_mbxfinish(context, slave, EC_MBXTRANS_TIMEOUT, EC_TIMEOUT);
+         continue;
+      }
+      dg = &(eng->statdg[n]);
+      dg->cmd = EC_CMD_FPRD;
+      dg->ADP = context->slavelist[slave].configadr;
+      dg->ADO = ECT_REG_SM0STAT;
+      dg->length = EC_MBXSTATSIZE;
+      dg->data = &(eng->stat[n][0]);
+      eng->slavelst[n++] = slave;
+   }
+   if (n == 0)
+   {
+      return eng->pending;
+   }
+   /* read mailbox status of all slaves in one go */
+   ecx_dgrams(context->port, n, eng->statdg, EC_TIMEOUTRET);
+   /* mailbox write or read for every slave that is ready */
+   na = 0;
+   for (lp = 0; lp < n; lp++)
+   {
+      if (eng->statdg[lp].wkc <= 0)
+      {
+         continue;
+      }
+      slave = eng->slavelst[lp];
+      trans = eng->head[slave];
+      csl = &(context->slavelist[slave]);
+      stat = &(eng->stat[lp][0]);
+      dg = &(eng->mbxdg[na]);
+      dg->ADP = csl->configadr;
+      /* read mailbox full, stale response before request or response to request */
+      if ((stat[ECT_REG_SM1STAT - ECT_REG_SM0STAT] & 0x08) && trans->rxmbx)
+      {
+         dg->cmd = EC_CMD_FPRD;
+         dg->ADO = csl->mbx_ro;
+         dg->length = csl->mbx_rl;
+         dg->data = trans->rxmbx;
+         eng->mbxlst[na++] = (uint16)lp;
+      }
+      /* write mailbox empty */
+      else if ((trans->state == EC_MBXTRANS_SEND) && !(stat[0] & 0x08))
+      {
+         dg->cmd = EC_CMD_FPWR;
+         dg->ADO = csl->mbx_wo;
+         dg->length = csl->mbx_l;
+         dg->data = trans->txmbx;
+         eng->mbxlst[na++] = (uint16)lp;
+      }
+   }
+   if (na == 0)
+   {
+      return eng->pending;
+   }
+   ecx_dgrams(context->port, na, eng->mbxdg, EC_TIMEOUTRET3);
+   for (la = 0; la < na; la++)
+   {
+      lp = eng->mbxlst[la];
+      slave = eng->slavelst[lp];
+      trans = eng->head[slave];
+      dg = &(eng->mbxdg[la]);
+      if (dg->cmd == EC_CMD_FPWR)
+      {
+         if (dg->wkc > 0)
+         {
+            if (trans->rxmbx)
+            {
+               trans->state = EC_MBXTRANS_RECEIVE;
+            }
+            else
+            {
+               ecx_mbxfinish(context, slave, EC_MBXTRANS_DONE, dg->wkc);
+            }
+         }
+      }
+      else if (dg->wkc > 0)
+      {
+         /* mailbox error, emergency or EoE fragment is handled here */
+         if (ecx_mbxhandler(context, slave, trans->rxmbx))
+         {
+            continue;
+         }
+         /* response read before request is written is stale */
+         if (trans->state == EC_MBXTRANS_RECEIVE)
+         {
+            ecx_mbxfinish(context, slave, EC_MBXTRANS_DONE, dg->wkc);
+         }
+      }
+      else if (trans->state == EC_MBXTRANS_RECEIVE) /* read mailbox lost */
+      {
+         stat = &(eng->stat[lp][0]);
+         SMstat = stat[ECT_REG_SM1STAT - ECT_REG_SM0STAT] +
+                  (stat[ECT_REG_SM1ACT - ECT_REG_SM0STAT] << 8);
+         SMstat ^= 0x0200; /* toggle repeat request */
+         SMstat = htoes(SMstat);
+         ecx_FPWR(context->port, dg->ADP, ECT_REG_SM1STAT, sizeof(SMstat), &SMstat, EC_TIMEOUTRET);
+      }
+   }
+
+   return eng->pending;
+}
+
+/** Poll the mailbox engine until a transaction is finished.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  trans    = transaction to wait for, NULL = wait for all
+ * @param[in]  timeout  = timeout in us
+ * @return wkc of transaction, 0 if not finished. With trans = NULL
+ * the number of transactions not finished.
+ */
+int ecx_mbxwait(ecx_contextt *context, ec_mbxtranst *trans, int timeout)
+{
+   osal_timert timer;
+   int pending;
+
+   osal_timer_start(&timer, timeout);
+   do
+   {
+      pending = ecx_mbxpoll(context);
+      if (trans ? (trans->state >= EC_MBXTRANS_DONE) : (pending == 0))
+      {
+         break;
+      }
+      osal_usleep(EC_MBXPOLLDELAY);
+   }
+   while (osal_timer_is_expired(&timer) == FALSE);
+   if (trans)
+   {
+      return (trans->state >= EC_MBXTRANS_DONE) ? trans->wkc : 0;
+   }
+
+   return pending;
+}
+
+/** Run a batch of protocol entries on the mailbox engine, one entry per
+ * slave at a time and all slaves in parallel. Blocks until all entries
+ * are finished. Every engine transaction ends within its own timeout, an
+ * entry that is still busy when no transaction is left for timeout us is
+ * cancelled with EC_TIMEOUT.
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     ops      = protocol callbacks
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries, ops->entrysize bytes each
+ * @param[in]     arg      = protocol argument passed to ops->prepare
+ * @param[in]     timeout  = timeout per mailbox transaction in us
+ * @return number of entries done successfully
+ */
+int ecx_mbxbatch(ecx_contextt *context, const ec_mbxbatchopst *ops, int n, void *list, void *arg, int timeout)
+{
+   void *first[EC_MAXSLAVE];
+   void *tail[EC_MAXSLAVE];
+   uint8 *entry;
+   uint16 slave;
+   int lp, cnt;
+   osal_timert timer;
+
+   memset(first, 0x00, sizeof(first));
+   memset(tail, 0x00, sizeof(tail));
+   for (lp = 0; lp < n; lp++)
+   {
+      entry = (uint8 *)list + (lp * ops->entrysize);
+      slave = ops->prepare(context, entry, arg, timeout);
+      if (!slave || (slave >= EC_MAXSLAVE))
+      {
+         continue;
+      }
+      ops->chain(tail[slave], entry);
+      if (!first[slave])
+      {
+         first[slave] = entry;
+      }
+      tail[slave] = entry;
+   }
+   /* start first entry of every slave, next entries follow on completion */
+   for (slave = 1; slave < EC_MAXSLAVE; slave++)
+   {
+      if (first[slave])
+      {
+         ops->start(context, first[slave]);
+      }
+   }
+   cnt = 0;
+   osal_timer_start(&timer, timeout);
+   for (lp = 0; lp < n; lp++)
+   {
+      entry = (uint8 *)list + (lp * ops->entrysize);
+      while (ops->busy(entry))
+      {
+         if (context->mbxengine && context->mbxengine->pending)
+         {
+            ecx_mbxwait(context, NULL, timeout);
+            osal_timer_start(&timer, timeout);
+         }
+         /* nothing in flight that could finish the entry */
+         else if (osal_timer_is_expired(&timer))
+         {
+            ops->cancel(entry, EC_TIMEOUT);
+         }
+         else
+         {
+            osal_usleep(EC_MBXPOLLDELAY);
+         }
+      }
+      if (ops->success(entry))
+      {
+         cnt++;
+      }
+   }
+
+   return cnt;
+}
+
+/* Processdata of the queue is sent cyclically */
+static boolean ecx_mbxdgq_recent(ec_mbxdgqueuet *q)
+{
+   ec_timet now, diff;
+
+   now = osal_current_time();
+   osal_time_diff(&(q->sendtime), &now, &diff);
+
+   return ((diff.sec == 0) && (diff.usec < EC_MBXDGQAGE));
+}
+
+/** Mailbox register or mailbox data access of a slave. If the cyclic queue
+ * is enabled and processdata is sent, the datagram is carried by the next
+ * processdata frame with free space. Otherwise, or if it does not fit,
+ * it is sent in a frame of its own.
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     slave    = slave number
+ * @param[in]     cmd      = EC_CMD_FPRD or EC_CMD_FPWR
+ * @param[in]     ADO      = register or mailbox address
+ * @param[in]     length   = data length
+ * @param[in,out] data     = data to write or buffer for data read
+ * @param[in]     timeout  = timeout in us when sent on its own
+ * @return workcounter or EC_NOFRAME, EC_UNCERTAIN if a write was carried
+ * by a processdata frame that did not return
+ */
+int ecx_mbxdgram(ecx_contextt *context, uint16 slave, uint8 cmd, uint16 ADO, uint16 length, void *data, int timeout)
+{
+   ec_mbxdgqueuet *q;
+   ec_mbxdgslott *dg;
+   osal_timert timer;
+   uint16 configadr;
+   int32 state;
+
+   q = context->mbxdgqueue;
+   configadr = context->slavelist[slave].configadr;
+   if (q && q->enable && (slave < EC_MAXSLAVE) && (length <= EC_MAXMBX) && ecx_mbxdgq_recent(q))
+   {
+      dg = &(q->slot[slave]);
+      state = dg->state;
+      /* a datagram of an earlier timed out access is still on its way */
+      if ((state != EC_MBXDG_QUEUED) && (state != EC_MBXDG_SENT))
+      {
+         dg->cmd = cmd;
+         dg->ADO = ADO;
+         dg->length = length;
+         dg->wkc = 0;
+         if (!ec_dgram_isread(cmd))
+         {
+            memcpy(dg->data, data, length);
+         }
+         /* publish slot, from here on the processdata thread may take it */
+         if (osal_atomic_cas(&(dg->state), state, EC_MBXDG_QUEUED))
+         {
+            q->pending = TRUE;
+            osal_timer_start(&timer, EC_MBXDGQTIMEOUT);
+            while (((dg->state == EC_MBXDG_QUEUED) || (dg->state == EC_MBXDG_SENT)) &&
+                   (osal_timer_is_expired(&timer) == FALSE))
+            {
+               osal_usleep(EC_MBXDGQDELAY);
+            }
+            if (osal_atomic_cas(&(dg->state), EC_MBXDG_DONE, EC_MBXDG_FREE))
+            {
+               if ((dg->wkc > 0) && ec_dgram_isread(cmd))
+               {
+                  memcpy(data, dg->data, length);
+               }
+               return dg->wkc;
+            }
+            /* withdraw slot, fails if the processdata thread took it meanwhile */
+            if (!osal_atomic_cas(&(dg->state), EC_MBXDG_QUEUED, EC_MBXDG_FREE) &&
+                !osal_atomic_cas(&(dg->state), EC_MBXDG_NOSPACE, EC_MBXDG_FREE))
+            {
+               /* on the wire, result comes with a later frame */
+               return ec_dgram_isread(cmd) ? EC_NOFRAME : EC_UNCERTAIN;
+            }
+            /* not picked up in time or no space, slot can no longer be sent */
+         }
+      }
+   }
+   if (cmd == EC_CMD_FPWR)
+   {
+      return ecx_FPWR(context->port, configadr, ADO, length, data, timeout);
+   }
+
+   return ecx_FPRD(context->port, configadr, ADO, length, data, timeout);
+}
+
+/** Append queued mailbox datagrams to a processdata frame before it is
+ * sent. For use by the processdata send functions.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  idx      = index of processdata frame
+ */
+void ecx_mbxdgq_append(ecx_contextt *context, uint8 idx)
+{
+   ec_mbxdgqueuet *q;
+   ec_mbxdgslott *dg;
+   ecx_portt *port;
+   ec_comt *datagramP;
+   uint8 *frameP;
+   int last, next;
+   uint16 slave;
+
+   q = context->mbxdgqueue;
+   if (!q || !q->enable)
+   {
+      return;
+   }
+   q->sendtime = osal_current_time();
+   /* pending stays set until ecx_mbxdgq_flush(), every frame of the cycle
+    * takes queued slots */
+   if (!q->pending)
+   {
+      return;
+   }
+   port = context->port;
+   frameP = (uint8 *)&(port->txbuf[idx]);
+   /* find header of last datagram in frame */
+   last = ETH_HEADERSIZE;
+   datagramP = (ec_comt *)&frameP[last];
+   while (etohs(datagramP->dlength) & EC_DATAGRAMFOLLOWS)
+   {
+      last += EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + (etohs(datagramP->dlength) & 0x07ff);
+      datagramP = (ec_comt *)&frameP[last];
+   }
+   for (slave = 1; (slave <= *(context->slavecount)) && (slave < EC_MAXSLAVE); slave++)
+   {
+      dg = &(q->slot[slave]);
+      if (dg->state != EC_MBXDG_QUEUED)
+      {
+         continue;
+      }
+      next = port->txbuflength[idx] + EC_HEADERSIZE - EC_ELENGTHSIZE + EC_WKCSIZE + dg->length;
+      if ((next > EC_MAXFRAMELENGTH) || (q->nsent >= EC_MAXSLAVE))
+      {
+         if (!dg->nospace && (q->nnospace < EC_MAXSLAVE))
+         {
+            dg->nospace = TRUE;
+            q->nospace[q->nnospace++] = slave;
+         }
+         continue;
+      }
+      /* take slot, fails if the mailbox thread withdrew it */
+      if (!osal_atomic_cas(&(dg->state), EC_MBXDG_QUEUED, EC_MBXDG_SENT))
+      {
+         continue;
+      }
+      /* datagram follows the last one */
+      datagramP = (ec_comt *)&frameP[last];
+      datagramP->dlength = htoes(etohs(datagramP->dlength) | EC_DATAGRAMFOLLOWS);
+      dg->datapos = ecx_adddatagram(port, frameP, dg->cmd, idx, FALSE,
+         context->slavelist[slave].configadr, dg->ADO, dg->length, dg->data);
+      last = dg->datapos + ETH_HEADERSIZE - EC_HEADERSIZE;
+      dg->idx = idx;
+      q->sent[q->nsent++] = slave;
+   }
+}
+
+/** Hand queued mailbox datagrams that did not fit in any processdata frame
+ * of the cycle back to the mailbox user. For use by the processdata send
+ * functions after all frames are sent.
+ *
+ * @param[in]  context  = context struct
+ */
+void ecx_mbxdgq_flush(ecx_contextt *context)
+{
+   ec_mbxdgqueuet *q;
+   ec_mbxdgslott *dg;
+   int lp;
+   uint16 slave;
+
+   q = context->mbxdgqueue;
+   if (!q)
+   {
+      return;
+   }
+   for (lp = 0; lp < q->nnospace; lp++)
+   {
+      dg = &(q->slot[q->nospace[lp]]);
+      dg->nospace = FALSE;
+      /* fails if a later frame of the cycle took the slot */
+      (void)osal_atomic_cas(&(dg->state), EC_MBXDG_QUEUED, EC_MBXDG_NOSPACE);
+   }
+   q->nnospace = 0;
+   /* queue is drained, a slot queued after the last frame keeps it pending */
+   if (osal_atomic_cas(&(q->pending), TRUE, FALSE))
+   {
+      for (slave = 1; (slave <= *(context->slavecount)) && (slave < EC_MAXSLAVE); slave++)
+      {
+         if (q->slot[slave].state == EC_MBXDG_QUEUED)
+         {
+            q->pending = TRUE;
+            break;
+         }
+      }
+   }
+}
+
+/** Return results of mailbox datagrams carried by a received processdata
+ * frame. For use by the processdata receive functions before the frame
+ * buffer is released.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  idx      = index of processdata frame
+ * @param[in]  wkc      = result of frame receive, EC_NOFRAME if lost
+ */
+void ecx_mbxdgq_receive(ecx_contextt *context, uint8 idx, int wkc)
+{
+   ec_mbxdgqueuet *q;
+   ec_mbxdgslott *dg;
+   uint8 *rxframe;
+   uint16 le_wkc;
+   int lp, n;
+
+   q = context->mbxdgqueue;
+   if (!q || !q->nsent)
+   {
+      return;
+   }
+   rxframe = (uint8 *)&(context->port->rxbuf[idx]);
+   n = 0;
+   for (lp = 0; lp < q->nsent; lp++)
+   {
+      dg = &(q->slot[q->sent[lp]]);
+      if (dg->idx != idx)
+      {
+         q->sent[n++] = q->sent[lp];
+         continue;
+      }
+      if (wkc > EC_NOFRAME)
+      {
+         memcpy(&le_wkc, &rxframe[dg->datapos + dg->length], EC_WKCSIZE);
+         dg->wkc = etohs(le_wkc);
+         if ((dg->wkc > 0) && ec_dgram_isread(dg->cmd))
+         {
+            memcpy(dg->data, &rxframe[dg->datapos], dg->length);
+         }
+      }
+      else
+      {
+         /* a lost write may still have reached the slave */
+         dg->wkc = ec_dgram_isread(dg->cmd) ? EC_NOFRAME : EC_UNCERTAIN;
+      }
+      /* hand result to the mailbox thread */
+      (void)osal_atomic_cas(&(dg->state), EC_MBXDG_SENT, EC_MBXDG_DONE);
+   }
+   q->nsent = n;
+}
+
+/* Read a value shared between threads, later accesses are not moved
+ * before the read */
+static int32 ec_atomic_get(volatile int32 *ptr)
+{
+   int32 val;
+
+   do
+   {
+      val = *ptr;
+   } while (!osal_atomic_cas(ptr, val, val));
+
+   return val;
+}
+
+/* Write a value shared between threads, earlier accesses are not moved
+ * behind the write */
+static void ec_atomic_set(volatile int32 *ptr, int32 val)
+{
+   int32 old;
+
+   do
+   {
+      old = *ptr;
+   } while (!osal_atomic_cas(ptr, old, val));
+}
+
+/** Post a request to the mailbox service.
+ *
+ * Any number of application threads can post at the same time. A poster
+ * claims the next free position of the queue with compare and swap, then
+ * stores the request and publishes it by advancing the lap of the
+ * position. The request is executed by ecx_mbxservice_poll(), completion
+ * is signalled by the done flag and the complete callback.
+ *
+ * @param[in]     context  = context struct
+ * @param[in,out] req      = request
+ * @return 1 if posted, 0 if queue is full or not available
+ */
+int ecx_mbxpost(ecx_contextt *context, ec_mbxrequestt *req)
+{
+   ec_mbxservicet *srv;
+   ec_mbxsrvcellt *cell;
+   uint32 pos, lap;
+   int32 diff;
+
+   srv = context->mbxservice;
+   if (!srv)
+   {
+      return 0;
+   }
+   req->wkc = 0;
+   req->done = FALSE;
+   do
+   {
+      pos = (uint32)ec_atomic_get(&(srv->head));
+      cell = &(srv->cell[pos & (EC_MBXSRVQSIZE - 1)]);
+      lap = pos & ~(uint32)(EC_MBXSRVQSIZE - 1);
+      diff = (int32)((uint32)ec_atomic_get(&(cell->seq)) - lap);
+      /* request of the previous lap is not yet taken by the service */
+      if (diff < 0)
+      {
+         return 0;
+      }
+      /* diff > 0, another poster claimed the position meanwhile */
+   } while ((diff != 0) || !osal_atomic_cas(&(srv->head), (int32)pos, (int32)(pos + 1)));
+   cell->req = req;
+   /* publish request after it is stored */
+   ec_atomic_set(&(cell->seq), (int32)(lap + 1));
+
+   return 1;
+}
+
+/** Wait for a request posted to the mailbox service.
+ *
+ * @param[in]  req      = request
+ * @param[in]  timeout  = timeout in us
+ * @return wkc of request, 0 if not finished
+ */
+int ec_mbxrequest_wait(ec_mbxrequestt *req, int timeout)
+{
+   osal_timert timer;
+
+   osal_timer_start(&timer, timeout);
+   while (!ec_atomic_get(&(req->done)) && !osal_timer_is_expired(&timer))
+   {
+      osal_usleep(EC_MBXPOLLDELAY);
+   }
+   /* result is written before done */
+   if (!ec_atomic_get(&(req->done)))
+   {
+      return 0;
+   }
+
+   return req->wkc;
+}
+
+/* Execute one request in the service */
+static void ecx_mbxservice_exec(ecx_contextt *context, ec_mbxrequestt *req)
+{
+   switch (req->type)
+   {
+      case EC_MBXREQ_SDOREAD:
+         req->wkc = ecx_SDOread(context, req->slave, req->index, req->subindex,
+                                req->CA, &(req->size), req->data, req->timeout);
+         break;
+      case EC_MBXREQ_SDOWRITE:
+         req->wkc = ecx_SDOwrite(context, req->slave, req->index, req->subindex,
+                                 req->CA, req->size, req->data, req->timeout);
+         break;
+      case EC_MBXREQ_CALL:
+         req->wkc = req->call ? req->call(context, req) : EC_ERROR;
+         break;
+      default:
+         req->wkc = EC_ERROR;
+         break;
+   }
+   if (req->complete)
+   {
+      req->complete(context, req);
+   }
+   /* hand result to the poster */
+   ec_atomic_set(&(req->done), TRUE);
+}
+
+/** Execute requests posted to the mailbox service.
+ *
+ * Requests are executed in the order they are posted. Call from the
+ * service thread or from a time slot of the cyclic thread, never from
+ * both. A request is only started while budget is left and runs to its
+ * end, so the slot can overrun by the duration of one request. When
+ * mailbox datagrams are carried by processdata frames this must not be
+ * called from the thread that sends the processdata.
+ *
+ * @param[in]  context  = context struct
+ * @param[in]  budget   = time budget in us, 0 = all queued requests
+ * @return number of executed requests
+ */
+int ecx_mbxservice_poll(ecx_contextt *context, int budget)
+{
+   ec_mbxservicet *srv;
+   ec_mbxsrvcellt *cell;
+   ec_mbxrequestt *req;
+   osal_timert timer;
+   uint32 lap;
+   int cnt;
+
+   srv = context->mbxservice;
+   if (!srv)
+   {
+      return 0;
+   }
+   osal_timer_start(&timer, budget);
+   cnt = 0;
+   while (!budget || !osal_timer_is_expired(&timer))
+   {
+      cell = &(srv->cell[srv->tail & (EC_MBXSRVQSIZE - 1)]);
+      lap = srv->tail & ~(uint32)(EC_MBXSRVQSIZE - 1);
+      /* claimed positions are taken in order once they are published */
+      if ((uint32)ec_atomic_get(&(cell->seq)) != (lap + 1))
+      {
+         break;
+      }
+      req = cell->req;
+      /* free position for the next lap */
+      ec_atomic_set(&(cell->seq), (int32)(lap + EC_MBXSRVQSIZE));
+      srv->tail++;
+      ecx_mbxservice_exec(context, req);
+      srv->executed++;
+      cnt++;
+   }
+
+   return cnt;
+}
+
+/* Mailbox service thread */
+static OSAL_THREAD_FUNC ecx_mbxservice_thread(void *param)
+{
+   ecx_contextt *context;
+   ec_mbxservicet *srv;
+
+   context = param;
+   srv = context->mbxservice;
+   while (ec_atomic_get(&(srv->run)))
+   {
+      if (ecx_mbxservice_poll(context, 0) == 0)
+      {
+         osal_usleep(EC_MBXSRVIDLE);
+      }
+   }
+   ec_atomic_set(&(srv->exited), TRUE);
+}
+
+/** Start the mailbox service thread. All mailbox access of the application
+ * should then go through ecx_mbxpost().
+ *
+ * @param[in]  context  = context struct
+ * @return 1 if thread is running
+ */
+int ecx_mbxservice_start(ecx_contextt *context)
+{
+   ec_mbxservicet *srv;
+
+   srv = context->mbxservice;
+   if (!srv)
+   {
+      return 0;
+   }
+   if (srv->running)
+   {
+      return 1;
+   }
+   ec_atomic_set(&(srv->exited), FALSE);
+   ec_atomic_set(&(srv->run), TRUE);
+   if (!osal_thread_create(&(srv->thread), EC_MBXSRVSTACK, &ecx_mbxservice_thread, context))
+   {
+      srv->run = FALSE;
+      return 0;
+   }
+   srv->running = TRUE;
+
+   return 1;
+}
+
+/** Stop the mailbox service thread. Returns after the thread has ended,
+ * requests still queued stay in the queue.
+ *
+ * @param[in]  context  = context struct
+ */
+void ecx_mbxservice_stop(ecx_contextt *context)
+{
+   ec_mbxservicet *srv;
+
+   srv = context->mbxservice;
+   if (!srv || !srv->running)
+   {
+      return;
+   }
+   ec_atomic_set(&(srv->run), FALSE);
+   if (!osal_thread_join(&(srv->thread)))
+   {
+      /* port cannot join threads, wait for the thread to report its end */
+      while (!ec_atomic_get(&(srv->exited)))
+      {
+         osal_usleep(EC_MBXSRVIDLE);
+      }
+   }
+   srv->running = FALSE;
+}
+
+#ifdef EC_VER1
+/** Submit a mailbox transaction.
+ *
+ * @param[in,out] trans    = transaction
+ * @return 1 if submitted
+ * @see ecx_mbxsubmit
+ */
+int ec_mbxsubmit(ec_mbxtranst *trans)
+{
+   return ecx_mbxsubmit(&ecx_context, trans);
+}
+
+/** Drive all outstanding mailbox transactions one step.
+ *
+ * @return number of transactions not finished
+ * @see ecx_mbxpoll
+ */
+int ec_mbxpoll(void)
+{
+   return ecx_mbxpoll(&ecx_context);
+}
+
+/** Poll the mailbox engine until a transaction is finished.
+ *
+ * @param[in]  trans    = transaction to wait for, NULL = wait for all
+ * @param[in]  timeout  = timeout in us
+ * @return wkc of transaction, 0 if not finished
+ * @see ecx_mbxwait
+ */
+int ec_mbxwait(ec_mbxtranst *trans, int timeout)
+{
+   return ecx_mbxwait(&ecx_context, trans, timeout);
+}
+
+/** Post a request to the mailbox service.
+ *
+ * @param[in,out] req      = request
+ * @return 1 if posted, 0 if queue is full
+ * @see ecx_mbxpost
+ */
+int ec_mbxpost(ec_mbxrequestt *req)
+{
+   return ecx_mbxpost(&ecx_context, req);
+}
+
+/** Execute requests posted to the mailbox service.
+ *
+ * @param[in]  budget   = time budget in us, 0 = all queued requests
+ * @return number of executed requests
+ * @see ecx_mbxservice_poll
+ */
+int ec_mbxservice_poll(int budget)
+{
+   return ecx_mbxservice_poll(&ecx_context, budget);
+}
+
+/** Start the mailbox service thread.
+ *
+ * @return 1 if thread is running
+ * @see ecx_mbxservice_start
+ */
+int ec_mbxservice_start(void)
+{
+   return ecx_mbxservice_start(&ecx_context);
+}
+
+/** Stop the mailbox service thread.
+ *
+ * @see ecx_mbxservice_stop
+ */
+void ec_mbxservice_stop(void)
+{
+   ecx_mbxservice_stop(&ecx_context);
+}
+#endif
@@ -0,0 +1,296 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercatmbx.c
+ */
+
+#ifndef _EC_MBX_H
+#define _EC_MBX_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Mailbox transaction states */
+typedef enum
+{
+   /** not submitted */
+   EC_MBXTRANS_IDLE      = 0,
+   /** waiting behind other transactions of the same slave */
+   EC_MBXTRANS_QUEUED,
+   /** waiting for empty write mailbox */
+   EC_MBXTRANS_SEND,
+   /** request written, waiting for response in read mailbox */
+   EC_MBXTRANS_RECEIVE,
+   /** finished, wkc > 0 */
+   EC_MBXTRANS_DONE,
+   /** finished with error */
+   EC_MBXTRANS_ERROR,
+   /** finished with timeout, wkc = EC_TIMEOUT */
+   EC_MBXTRANS_TIMEOUT
+} ec_mbxtransstatet;
+
+typedef struct ec_mbxtrans ec_mbxtranst;
+
+/** Asynchronous mailbox transaction. Memory is owned by the submitter and
+ * must stay valid until the transaction is finished.
+ */
+struct ec_mbxtrans
+{
+   /** slave number */
+   uint16            slave;
+   /** transaction state, see ec_mbxtransstatet */
+   int               state;
+   /** result, workcounter of mailbox read or write, EC_TIMEOUT on timeout */
+   int               wkc;
+   /** request to write, NULL = receive only */
+   ec_mbxbuft        *txmbx;
+   /** buffer for response, NULL = send only */
+   ec_mbxbuft        *rxmbx;
+   /** timeout in us, started when the transaction becomes active */
+   int               timeout;
+   /** internal, timeout timer */
+   osal_timert       timer;
+   /** called when finished, may submit new transactions, NULL = none */
+   void              (*complete)(ecx_contextt *context, ec_mbxtranst *trans);
+   /** free for use by submitter */
+   void              *userdata;
+   /** internal, next transaction of the same slave */
+   ec_mbxtranst      *next;
+};
+
+/** Protocol part of a batch run by ecx_mbxbatch(). Entries are queued per
+ * slave and the entries of one slave are started one after the other by
+ * the completion callback of the protocol.
+ */
+typedef struct
+{
+   /** size in bytes of one entry of the list */
+   int               entrysize;
+   /** reset entry for the batch, returns slave to queue the entry on, or 0
+    *  if the entry is skipped or already done without mailbox engine */
+   uint16            (*prepare)(ecx_contextt *context, void *entry, void *arg, int timeout);
+   /** link entry behind last queued entry of the same slave, prev is NULL
+    *  for the first entry of a slave */
+   void              (*chain)(void *prev, void *entry);
+   /** start first entry of a slave */
+   void              (*start)(ecx_contextt *context, void *entry);
+   /** entry is not finished */
+   boolean           (*busy)(void *entry);
+   /** entry is part of this batch and finished successfully */
+   boolean           (*success)(void *entry);
+   /** finish entry with result wkc, entry has no transaction in flight */
+   void              (*cancel)(void *entry, int wkc);
+} ec_mbxbatchopst;
+
+/** SM0 status register up to SM1 activate register, read as one block */
+#define EC_MBXSTATSIZE    (ECT_REG_SM1ACT - ECT_REG_SM0STAT + 1)
+
+/** Asynchronous mailbox engine, one queue of transactions per slave */
+struct ec_mbxengine
+{
+   /** first transaction per slave, this one is active */
+   ec_mbxtranst      *head[EC_MAXSLAVE];
+   /** last transaction per slave */
+   ec_mbxtranst      *tail[EC_MAXSLAVE];
+   /** number of transactions not finished */
+   int               pending;
+   /** internal, slaves with active transaction in current poll */
+   uint16            slavelst[EC_MAXSLAVE];
+   /** internal, mailbox status of slaves in current poll */
+   uint8             stat[EC_MAXSLAVE][EC_MBXSTATSIZE];
+   /** internal, status datagrams of current poll */
+   ec_dgramt         statdg[EC_MAXSLAVE];
+   /** internal, mailbox read and write datagrams of current poll */
+   ec_dgramt         mbxdg[EC_MAXSLAVE];
+   /** internal, index in slavelst of mailbox datagrams */
+   uint16            mbxlst[EC_MAXSLAVE];
+};
+
+/** States of a mailbox datagram slot in the cyclic queue */
+typedef enum
+{
+   /** slot is free */
+   EC_MBXDG_FREE         = 0,
+   /** waiting for a processdata frame with free space */
+   EC_MBXDG_QUEUED,
+   /** appended to a processdata frame */
+   EC_MBXDG_SENT,
+   /** frame received, wkc and data are valid */
+   EC_MBXDG_DONE,
+   /** did not fit in the processdata frames, send on its own */
+   EC_MBXDG_NOSPACE
+} ec_mbxdgstatet;
+
+/** Mailbox datagram of one slave in the cyclic queue. The slot state is
+ * only changed with osal_atomic_cas(), the thread that moves a slot out of
+ * EC_MBXDG_QUEUED owns it.
+ */
+typedef struct
+{
+   /** slot state, see ec_mbxdgstatet */
+   volatile int32    state;
+   /** command, EC_CMD_FPRD or EC_CMD_FPWR */
+   uint8             cmd;
+   /** register or mailbox address */
+   uint16            ADO;
+   /** data length */
+   uint16            length;
+   /** workcounter of datagram, EC_NOFRAME if frame is lost */
+   int               wkc;
+   /** index of processdata frame */
+   uint8             idx;
+   /** offset of data in received frame */
+   uint16            datapos;
+   /** internal, slave is in the nospace list of the current cycle */
+   boolean           nospace;
+   /** data to write or data read */
+   uint8             data[EC_MAXMBX];
+} ec_mbxdgslott;
+
+/** Queue of mailbox datagrams carried by the cyclic processdata frames.
+ * Each slave has one slot, mailbox access of one slave is sequential.
+ * Slots are filled by the mailbox functions and appended to the frames
+ * by ecx_send_processdata(), results are returned by
+ * ecx_receive_processdata(). A slot holds a full mailbox, the queue takes
+ * about EC_MAXSLAVE * EC_MAXMBX bytes, 300 kB with the default sizes.
+ */
+struct ec_mbxdgqueue
+{
+   /** set to TRUE to route mailbox datagrams via processdata frames,
+    * mailbox functions must then run in another thread than processdata */
+   boolean           enable;
+   /** at least one slot is queued, cleared when the frames of a cycle are sent */
+   volatile int32    pending;
+   /** time of last processdata send */
+   ec_timet          sendtime;
+   /** slot per slave */
+   ec_mbxdgslott     slot[EC_MAXSLAVE];
+   /** internal, slaves with datagram in frames not yet received */
+   uint16            sent[EC_MAXSLAVE];
+   /** internal, number of slaves in sent */
+   int               nsent;
+   /** internal, slaves that did not fit in a frame of the current cycle */
+   uint16            nospace[EC_MAXSLAVE];
+   /** internal, number of slaves in nospace */
+   int               nnospace;
+};
+
+/** requests in the queue of the mailbox service, must be a power of 2 */
+#define EC_MBXSRVQSIZE     64
+
+/** Mailbox service request types */
+typedef enum
+{
+   /** ecx_SDOread() */
+   EC_MBXREQ_SDOREAD     = 0,
+   /** ecx_SDOwrite() */
+   EC_MBXREQ_SDOWRITE,
+   /** call of user function */
+   EC_MBXREQ_CALL
+} ec_mbxreqtypet;
+
+typedef struct ec_mbxrequest ec_mbxrequestt;
+
+/** Request to the mailbox service. Memory is owned by the poster and must
+ * stay valid until done is set, see ec_mbxrequest_wait().
+ */
+struct ec_mbxrequest
+{
+   /** request type, see ec_mbxreqtypet */
+   int               type;
+   /** slave number */
+   uint16            slave;
+   /** SDO index */
+   uint16            index;
+   /** SDO subindex */
+   uint8             subindex;
+   /** SDO Complete Access */
+   boolean           CA;
+   /** size in bytes of data, on SDO read returns size read */
+   int               size;
+   /** data buffer */
+   void              *data;
+   /** timeout in us */
+   int               timeout;
+   /** function for EC_MBXREQ_CALL, runs in the service, returns wkc */
+   int               (*call)(ecx_contextt *context, ec_mbxrequestt *req);
+   /** called by the service when finished, NULL = none */
+   void              (*complete)(ecx_contextt *context, ec_mbxrequestt *req);
+   /** free for use by poster */
+   void              *userdata;
+   /** result, workcounter of the request */
+   int               wkc;
+   /** set when finished, after wkc and data */
+   volatile int32    done;
+};
+
+/** Position in the queue of the mailbox service */
+typedef struct
+{
+   /** lap of the position, equal to the lap when free and lap + 1 when
+    *  the request is stored, see ecx_mbxpost() */
+   volatile int32    seq;
+   /** request */
+   ec_mbxrequestt    *req;
+} ec_mbxsrvcellt;
+
+/** Mailbox service. Application threads post requests to one queue, one
+ * service thread or a time slot of the cyclic thread executes them. Any
+ * number of threads can post without locking, mailbox access is then
+ * done by a single thread.
+ */
+struct ec_mbxservice
+{
+   /** internal, service thread should run */
+   volatile int32    run;
+   /** internal, service thread has ended */
+   volatile int32    exited;
+   /** service thread is started */
+   boolean           running;
+   /** number of executed requests */
+   uint32            executed;
+   /** internal, next free position, claimed by the posters with compare and swap */
+   volatile int32    head;
+   /** internal, next request to execute, used by the service only */
+   uint32            tail;
+   /** internal, request queue */
+   ec_mbxsrvcellt    cell[EC_MBXSRVQSIZE];
+   /** internal, service thread */
+   OSAL_THREAD_HANDLE thread;
+};
+
+#ifdef EC_VER1
+int ec_mbxsubmit(ec_mbxtranst *trans);
+int ec_mbxpoll(void);
+int ec_mbxwait(ec_mbxtranst *trans, int timeout);
+int ec_mbxpost(ec_mbxrequestt *req);
+int ec_mbxservice_poll(int budget);
+int ec_mbxservice_start(void);
+void ec_mbxservice_stop(void);
+#endif
+
+int ecx_mbxsubmit(ecx_contextt *context, ec_mbxtranst *trans);
+int ecx_mbxpoll(ecx_contextt *context);
+int ecx_mbxwait(ecx_contextt *context, ec_mbxtranst *trans, int timeout);
+int ecx_mbxbatch(ecx_contextt *context, const ec_mbxbatchopst *ops, int n, void *list, void *arg, int timeout);
+int ecx_mbxdgram(ecx_contextt *context, uint16 slave, uint8 cmd, uint16 ADO, uint16 length, void *data, int timeout);
+void ecx_mbxdgq_append(ecx_contextt *context, uint8 idx);
+void ecx_mbxdgq_flush(ecx_contextt *context);
+void ecx_mbxdgq_receive(ecx_contextt *context, uint8 idx, int wkc);
+int ecx_mbxpost(ecx_contextt *context, ec_mbxrequestt *req);
+int ec_mbxrequest_wait(ec_mbxrequestt *req, int timeout);
+int ecx_mbxservice_poll(ecx_contextt *context, int budget);
+int ecx_mbxservice_start(ecx_contextt *context);
+void ecx_mbxservice_stop(ecx_contextt *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EC_MBX_H */
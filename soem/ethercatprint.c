@@ -338,6 +338,18 @@ char* ecx_err2string(const ec_errort Ec)
                  timestr, Ec.Slave, Ec.ErrorCode, ec_mbxerror2string(Ec.ErrorCode));
          break;
       }
+      case EC_ERR_TYPE_AOE_ERROR:
+      {
+         sprintf(estring, "%s AoE slave:%d group:%4.4x error:%8.8x\n",
+                 timestr, Ec.Slave, Ec.Index, (unsigned)Ec.AbortCode);
+         break;
+      }
+      case EC_ERR_TYPE_DC_ALARM:
+      {
+         sprintf(estring, "%s DC alarm slave:%d alarm:%2.2x deviation:%d ns\n",
+                 timestr, Ec.Slave, Ec.Index, (int)Ec.AbortCode);
+         break;
+      }
       default:
       {
          sprintf(estring, "%s error:%8.8x\n",
@@ -0,0 +1,128 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Startup profiler.
+ *
+ * Records wall time, frames, datagrams and resends per startup phase and
+ * per slave in the profile report referenced by the context.
+ */
+
+#include <string.h>
+#include "osal.h"
+#include "oshw.h"
+#include "ethercattype.h"
+#include "ethercatbase.h"
+#include "ethercatmain.h"
+#include "ethercatprofile.h"
+
+static const char *ec_profphasenames[EC_PROF_MAX] =
+{
+   "detect slaves",
+   "config init",
+   "slave init",
+   "mapping",
+   "CoE/SoE mapping",
+   "SII mapping",
+   "SM programming",
+   "DC config",
+   "state check"
+};
+
+/** Clear profile report of context.
+ *
+ * @param[in]  context        = context struct
+ */
+void ecx_profile_clear(ecx_contextt *context)
+{
+   if (context->profile)
+   {
+      memset(context->profile, 0x00, sizeof(ec_profilet));
+   }
+}
+
+/** Start a measurement. Does nothing when profiling is disabled.
+ *
+ * @param[in]  context        = context struct
+ * @param[out] mark           = start point of measurement
+ */
+void ecx_profile_start(ecx_contextt *context, ec_profmarkt *mark)
+{
+   if (context->profile)
+   {
+      mark->start = osal_current_time();
+      mark->txcnt = context->port->txcnt;
+      mark->retrycnt = context->port->retrycnt;
+      mark->dgramcnt = context->port->dgramcnt;
+   }
+}
+
+/** Stop a measurement and add it to the phase totals and, for slave > 0,
+ * to the slave record.
+ *
+ * @param[in]  context        = context struct
+ * @param[in]  phase          = startup phase
+ * @param[in]  slave          = slave number, 0 = not slave specific
+ * @param[in]  mark           = start point from ecx_profile_start()
+ */
+void ecx_profile_stop(ecx_contextt *context, ec_profphaset phase, uint16 slave, ec_profmarkt *mark)
+{
+   ec_profentryt *entry[2];
+   ec_timet now, diff;
+   uint32 time;
+   int lp;
+
+   if (!context->profile || (phase >= EC_PROF_MAX))
+   {
+      return;
+   }
+   now = osal_current_time();
+   osal_time_diff(&mark->start, &now, &diff);
+   time = diff.sec * 1000000 + diff.usec;
+   entry[0] = &context->profile->phase[phase];
+   entry[1] = NULL;
+   if (slave && (slave < EC_MAXSLAVE))
+   {
+      entry[1] = &context->profile->slave[slave][phase];
+   }
+   for (lp = 0; (lp < 2) && entry[lp]; lp++)
+   {
+      entry[lp]->calls++;
+      entry[lp]->time += time;
+      if (time > entry[lp]->maxtime)
+      {
+         entry[lp]->maxtime = time;
+      }
+      entry[lp]->frames += context->port->txcnt - mark->txcnt;
+      entry[lp]->retries += context->port->retrycnt - mark->retrycnt;
+      entry[lp]->datagrams += context->port->dgramcnt - mark->dgramcnt;
+   }
+}
+
+/** Look up text string that belongs to a profiler phase.
+ *
+ * @param[in] phase = startup phase
+ * @return readable string
+ */
+const char* ecx_profilephase2string(ec_profphaset phase)
+{
+   if (phase >= EC_PROF_MAX)
+   {
+      return "unknown";
+   }
+   return ec_profphasenames[phase];
+}
+
+#ifdef EC_VER1
+/** Clear profile report of default context.
+ *
+ * @see ecx_profile_clear
+ */
+void ec_profile_clear(void)
+{
+   ecx_profile_clear(&ecx_context);
+}
+#endif
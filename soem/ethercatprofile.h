@@ -0,0 +1,96 @@
+/*
+ * Licensed under the GNU General Public License version 2 with exceptions. See
+ * LICENSE file in the project root for full license information
+ */
+
+/** \file
+ * \brief
+ * Headerfile for ethercatprofile.c
+ */
+
+#ifndef _EC_PROFILE_H
+#define _EC_PROFILE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** Startup phases recorded by the profiler */
+typedef enum
+{
+   /** ecx_detect_slaves() */
+   EC_PROF_DETECT        = 0,
+   /** complete ecx_config_init() or ecx_config_from_eni() */
+   EC_PROF_CONFIGINIT,
+   /** per slave part of ecx_config_init() */
+   EC_PROF_SLAVEINIT,
+   /** complete mapping search of a group */
+   EC_PROF_MAPPING,
+   /** CoE / SoE mapping read of a slave */
+   EC_PROF_MAPCOE,
+   /** SII mapping of a slave */
+   EC_PROF_MAPSII,
+   /** SM programming of a slave */
+   EC_PROF_MAPSM,
+   /** ecx_configdc() */
+   EC_PROF_DC,
+   /** ecx_statecheck() and ecx_statecheck_multi() waits */
+   EC_PROF_STATECHECK,
+   /** number of phases */
+   EC_PROF_MAX
+} ec_profphaset;
+
+/** Profile record of one phase */
+typedef struct
+{
+   /** number of times the phase was run */
+   uint32 calls;
+   /** accumulated wall time in us */
+   uint32 time;
+   /** longest single run in us */
+   uint32 maxtime;
+   /** frames sent, including resends */
+   uint32 frames;
+   /** datagrams sent */
+   uint32 datagrams;
+   /** frames resent after missing response */
+   uint32 retries;
+} ec_profentryt;
+
+/** Start point of a running measurement, see ecx_profile_start() */
+typedef struct
+{
+   ec_timet start;
+   uint32   txcnt;
+   uint32   retrycnt;
+   uint32   dgramcnt;
+} ec_profmarkt;
+
+/** Startup profile report. Assign to context->profile to enable profiling,
+ * NULL (default) disables it. Frame counts are taken from the port, so
+ * phases that run concurrently (CoE mapping threads) also count frames
+ * of the other threads.
+ */
+struct ec_profile
+{
+   /** totals per phase */
+   ec_profentryt  phase[EC_PROF_MAX];
+   /** per slave and phase, entry 0 is unused */
+   ec_profentryt  slave[EC_MAXSLAVE][EC_PROF_MAX];
+};
+
+#ifdef EC_VER1
+void ec_profile_clear(void);
+#endif
+
+void ecx_profile_clear(ecx_contextt *context);
+void ecx_profile_start(ecx_contextt *context, ec_profmarkt *mark);
+void ecx_profile_stop(ecx_contextt *context, ec_profphaset phase, uint16 slave, ec_profmarkt *mark);
+const char* ecx_profilephase2string(ec_profphaset phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _EC_PROFILE_H */
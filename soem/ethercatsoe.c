@@ -15,10 +15,9 @@
 #include "ethercattype.h"
 #include "ethercatbase.h"
 #include "ethercatmain.h"
+#include "ethercatmbx.h"
 #include "ethercatsoe.h"
 
-#define EC_SOE_MAX_DRIVES 8
-
 /** SoE (Servo over EtherCAT) mailbox structure */
 PACKED_BEGIN
 typedef struct PACKED
@@ -182,10 +181,45 @@ int ecx_SoEread(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elemen
    return wkc;
 }
 
+/* Drop cached mapping of the device type of slave when the AT or MDT
+ * list is written, the slave no longer matches the cached mapping.
+ */
+static void ecx_IDNcache_invalidate(ecx_contextt *context, uint16 slave, uint16 idn)
+{
+   ec_IDNcachet *cache;
+   ec_slavet *csl;
+   int lp;
+
+   cache = context->idncache;
+   if (!cache || ((idn != EC_IDN_ATCONFIG) && (idn != EC_IDN_MDTCONFIG)) ||
+       (slave > *(context->slavecount)))
+   {
+      return;
+   }
+   csl = &(context->slavelist[slave]);
+   for (lp = 0; lp < cache->nentry; lp++)
+   {
+      if ((cache->entry[lp].eep_man == csl->eep_man) &&
+          (cache->entry[lp].eep_id == csl->eep_id) &&
+          (cache->entry[lp].eep_rev == csl->eep_rev))
+      {
+         /* move last entry in the gap */
+         cache->entry[lp] = cache->entry[--cache->nentry];
+         if (cache->next >= cache->nentry)
+         {
+            cache->next = 0;
+         }
+         break;
+      }
+   }
+}
+
 /** SoE write, blocking.
  *
  * The IDN object of the selected slave and DriveNo is written. If a response
  * is larger than the mailbox size then the response is segmented.
+ * Writing the AT or MDT list drops the mapping of the slave from
+ * context->idncache.
  *
  * @param[in]  context        = context struct
  * @param[in]  slave         = Slave number
@@ -209,6 +243,7 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
    uint8 cnt;
    boolean NotLast;
 
+   ecx_IDNcache_invalidate(context, slave, idn);
    ec_clearmbx(&MbxIn);
    /* Empty slave out mailbox if something is in. Timeout set to 0 */
    wkc = ecx_mbxreceive(context, slave, (ec_mbxbuft *)&MbxIn, 0);
@@ -297,11 +332,516 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
    return wkc;
 }
 
+static void ecx_SoEbatch_complete(ecx_contextt *context, ec_mbxtranst *trans);
+static void ecx_SoEbatch_start(ecx_contextt *context, ec_SoEbatcht *entry);
+
+/* Submit mailbox transaction of a batch entry, txmbx NULL = receive only,
+ * rxmbx NULL = send only */
+static boolean ecx_SoEbatch_submit(ecx_contextt *context, ec_SoEbatcht *entry,
+                                   ec_mbxbuft *txmbx, ec_mbxbuft *rxmbx)
+{
+   if (rxmbx)
+   {
+      ec_clearmbx(rxmbx);
+   }
+   entry->trans.slave = entry->slave;
+   entry->trans.txmbx = txmbx;
+   entry->trans.rxmbx = rxmbx;
+   entry->trans.timeout = entry->timeout;
+   entry->trans.complete = ecx_SoEbatch_complete;
+   entry->trans.userdata = entry;
+
+   return (ecx_mbxsubmit(context, &(entry->trans)) > 0);
+}
+
+/* Finish a batch entry and start the next entry of the same slave */
+static void ecx_SoEbatch_finish(ecx_contextt *context, ec_SoEbatcht *entry, int wkc)
+{
+   entry->wkc = wkc;
+   entry->busy = FALSE;
+   if (entry->next)
+   {
+      ecx_SoEbatch_start(context, entry->next);
+   }
+}
+
+/* Build and submit next request of a batch entry, a read request or the
+ * next fragment of a write */
+static void ecx_SoEbatch_start(ecx_contextt *context, ec_SoEbatcht *entry)
+{
+   ec_SoEt *SoEp;
+   int framedatasize, maxdata;
+   boolean NotLast;
+   uint8 cnt;
+
+   ec_clearmbx(&(entry->txmbx));
+   SoEp = (ec_SoEt *)&(entry->txmbx);
+   SoEp->MbxHeader.address = htoes(0x0000);
+   SoEp->MbxHeader.priority = 0x00;
+   SoEp->error = 0;
+   SoEp->driveNo = entry->driveNo;
+   SoEp->elementflags = entry->elementflags;
+   SoEp->idn = htoes(entry->idn);
+   NotLast = FALSE;
+   if (!entry->write)
+   {
+      SoEp->MbxHeader.length = htoes(sizeof(ec_SoEt) - sizeof(ec_mbxheadert));
+      SoEp->opCode = ECT_SOE_READREQ;
+   }
+   else
+   {
+      SoEp->opCode = ECT_SOE_WRITEREQ;
+      maxdata = context->slavelist[entry->slave].mbx_l - sizeof(ec_SoEt);
+      framedatasize = entry->size - entry->done;
+      if (framedatasize > maxdata)
+      {
+         framedatasize = maxdata;  /*  segmented transfer needed  */
+         NotLast = TRUE;
+         SoEp->incomplete = 1;
+         SoEp->fragmentsleft = htoes((uint16)((entry->size - entry->done) / maxdata));
+      }
+      SoEp->MbxHeader.length = htoes((uint16)(sizeof(ec_SoEt) - sizeof(ec_mbxheadert) + framedatasize));
+      /* copy parameter data to mailbox */
+      memcpy((uint8 *)&(entry->txmbx) + sizeof(ec_SoEt), (uint8 *)entry->data + entry->done, framedatasize);
+      entry->done += framedatasize;
+   }
+   /* get new mailbox count value, used as session handle */
+   cnt = ec_nextmbxcnt(context->slavelist[entry->slave].mbx_cnt);
+   context->slavelist[entry->slave].mbx_cnt = cnt;
+   SoEp->MbxHeader.mbxtype = ECT_MBXT_SOE + MBX_HDR_SET_CNT(cnt); /* SoE */
+   /* fragments before the last one are not answered */
+   if (!ecx_SoEbatch_submit(context, entry, &(entry->txmbx), NotLast ? NULL : &(entry->rxmbx)))
+   {
+      ecx_SoEbatch_finish(context, entry, EC_ERROR);
+   }
+}
+
+/* Report unexpected or error response of a batch entry */
+static void ecx_SoEbatch_error(ecx_contextt *context, ec_SoEbatcht *entry, uint8 opCode)
+{
+   ec_SoEt *aSoEp;
+   uint16 *errorcode;
+
+   aSoEp = (ec_SoEt *)&(entry->rxmbx);
+   if (((aSoEp->MbxHeader.mbxtype & 0x0f) == ECT_MBXT_SOE) &&
+       (aSoEp->opCode == opCode) &&
+       (aSoEp->error == 1))
+   {
+      errorcode = (uint16 *)((uint8 *)&(entry->rxmbx) +
+                  (etohs(aSoEp->MbxHeader.length) + sizeof(ec_mbxheadert) - sizeof(uint16)));
+      entry->errorcode = etohs(*errorcode);
+      ecx_SoEerror(context, entry->slave, entry->idn, entry->errorcode);
+   }
+   else
+   {
+      ecx_packeterror(context, entry->slave, entry->idn, 0, 1); /* Unexpected frame returned */
+   }
+}
+
+/* Mailbox engine callback of a batch entry */
+static void ecx_SoEbatch_complete(ecx_contextt *context, ec_mbxtranst *trans)
+{
+   ec_SoEbatcht *entry;
+   ec_SoEt *aSoEp;
+   int framedatasize;
+
+   entry = (ec_SoEbatcht *)trans->userdata;
+   if (trans->state != EC_MBXTRANS_DONE)
+   {
+      ecx_SoEbatch_finish(context, entry, (trans->wkc < 0) ? trans->wkc : EC_ERROR);
+      return;
+   }
+   /* write fragment placed in slave, continue with next fragment */
+   if (!trans->rxmbx)
+   {
+      ecx_SoEbatch_start(context, entry);
+      return;
+   }
+   aSoEp = (ec_SoEt *)&(entry->rxmbx);
+   /* slave response should be SoE, ReadRes or WriteRes */
+   if (((aSoEp->MbxHeader.mbxtype & 0x0f) != ECT_MBXT_SOE) ||
+       (aSoEp->opCode != (entry->write ? ECT_SOE_WRITERES : ECT_SOE_READRES)) ||
+       (aSoEp->error != 0) ||
+       (aSoEp->driveNo != entry->driveNo) ||
+       (aSoEp->elementflags != entry->elementflags))
+   {
+      ecx_SoEbatch_error(context, entry, entry->write ? ECT_SOE_WRITERES : ECT_SOE_READRES);
+      ecx_SoEbatch_finish(context, entry, 0);
+      return;
+   }
+   if (entry->write)
+   {
+      ecx_SoEbatch_finish(context, entry, trans->wkc);
+      return;
+   }
+   framedatasize = etohs(aSoEp->MbxHeader.length) - sizeof(ec_SoEt) + sizeof(ec_mbxheadert);
+   /* copy what fits in parameter buffer */
+   if ((entry->done + framedatasize) > entry->size)
+   {
+      framedatasize = entry->size - entry->done;
+   }
+   if (framedatasize > 0)
+   {
+      memcpy((uint8 *)entry->data + entry->done, (uint8 *)&(entry->rxmbx) + sizeof(ec_SoEt), framedatasize);
+      entry->done += framedatasize;
+   }
+   if (aSoEp->incomplete)
+   {
+      /* next fragment follows without request */
+      if (!ecx_SoEbatch_submit(context, entry, NULL, &(entry->rxmbx)))
+      {
+         ecx_SoEbatch_finish(context, entry, EC_ERROR);
+      }
+      return;
+   }
+   entry->size = entry->done;
+   ecx_SoEbatch_finish(context, entry, trans->wkc);
+}
+
+/* Reset batch entry, without engine transfer it right away */
+static uint16 ecx_SoEbatch_prepare(ecx_contextt *context, void *p, void *arg, int timeout)
+{
+   ec_SoEbatcht *entry;
+   boolean write;
+
+   entry = (ec_SoEbatcht *)p;
+   write = *(boolean *)arg;
+   entry->busy = FALSE;
+   /* disabled entry, result is kept */
+   if (entry->slave == 0)
+   {
+      return 0;
+   }
+   entry->wkc = 0;
+   entry->errorcode = 0;
+   entry->write = write;
+   entry->done = 0;
+   entry->timeout = timeout;
+   entry->next = NULL;
+   entry->trans.state = EC_MBXTRANS_IDLE;
+   if ((entry->slave > *(context->slavecount)) || (entry->slave >= EC_MAXSLAVE))
+   {
+      entry->wkc = EC_ERROR;
+      return 0;
+   }
+   if (write)
+   {
+      ecx_IDNcache_invalidate(context, entry->slave, entry->idn);
+   }
+   /* without engine transfer one by one */
+   if (!context->mbxengine)
+   {
+      if (write)
+      {
+         entry->wkc = ecx_SoEwrite(context, entry->slave, entry->driveNo, entry->elementflags,
+                                   entry->idn, entry->size, entry->data, timeout);
+      }
+      else
+      {
+         entry->wkc = ecx_SoEread(context, entry->slave, entry->driveNo, entry->elementflags,
+                                  entry->idn, &(entry->size), entry->data, timeout);
+      }
+      return 0;
+   }
+   entry->busy = TRUE;
+   return entry->slave;
+}
+
+static void ecx_SoEbatch_chain(void *prev, void *entry)
+{
+   if (prev)
+   {
+      ((ec_SoEbatcht *)prev)->next = (ec_SoEbatcht *)entry;
+   }
+}
+
+static void ecx_SoEbatch_first(ecx_contextt *context, void *entry)
+{
+   ecx_SoEbatch_start(context, (ec_SoEbatcht *)entry);
+}
+
+static boolean ecx_SoEbatch_busy(void *entry)
+{
+   return ((ec_SoEbatcht *)entry)->busy;
+}
+
+/* count only entries of this batch */
+static boolean ecx_SoEbatch_success(void *p)
+{
+   ec_SoEbatcht *entry;
+
+   entry = (ec_SoEbatcht *)p;
+   return ((entry->slave != 0) && (entry->wkc > 0));
+}
+
+static void ecx_SoEbatch_cancel(void *p, int wkc)
+{
+   ec_SoEbatcht *entry;
+
+   entry = (ec_SoEbatcht *)p;
+   entry->wkc = wkc;
+   entry->busy = FALSE;
+}
+
+static const ec_mbxbatchopst ecx_SoEbatch_ops =
+{
+   sizeof(ec_SoEbatcht),
+   ecx_SoEbatch_prepare,
+   ecx_SoEbatch_chain,
+   ecx_SoEbatch_first,
+   ecx_SoEbatch_busy,
+   ecx_SoEbatch_success,
+   ecx_SoEbatch_cancel
+};
+
+/* Run SoE batch on the mailbox engine, one transfer per slave at a time */
+static int ecx_SoEbatch(ecx_contextt *context, int n, ec_SoEbatcht *list, int timeout, boolean write)
+{
+   return ecx_mbxbatch(context, &ecx_SoEbatch_ops, n, list, &write, timeout);
+}
+
+/** SoE read of a list of IDNs, blocking.
+ *
+ * All slaves are served in parallel by the mailbox engine, the entries of
+ * one slave are read one after the other. Segmented responses are
+ * combined. Without mailbox engine the entries are read with
+ * ecx_SoEread().
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries, slave, driveNo, elementflags, idn, size and
+ *                           data must be set, size and result are returned per
+ *                           entry. Entries with slave 0 are skipped.
+ * @param[in]     timeout  = Timeout per mailbox transfer in us, standard is EC_TIMEOUTRXM
+ * @return number of entries read successfully
+ */
+int ecx_SoEread_batch(ecx_contextt *context, int n, ec_SoEbatcht *list, int timeout)
+{
+   return ecx_SoEbatch(context, n, list, timeout, FALSE);
+}
+
+/** SoE write of a list of IDNs, blocking.
+ *
+ * All slaves are served in parallel by the mailbox engine, the entries of
+ * one slave are written one after the other. Data larger than the mailbox
+ * is written in fragments. Without mailbox engine the entries are written
+ * with ecx_SoEwrite(). As with ecx_SoEwrite() the IDN cache entry of a
+ * slave is dropped when its AT or MDT list is written.
+ *
+ * @param[in]     context  = context struct
+ * @param[in]     n        = number of entries
+ * @param[in,out] list     = entries, slave, driveNo, elementflags, idn, size and
+ *                           data must be set, result is returned per entry.
+ *                           Entries with slave 0 are skipped.
+ * @param[in]     timeout  = Timeout per mailbox transfer in us, standard is EC_TIMEOUTRXM
+ * @return number of entries written successfully
+ */
+int ecx_SoEwrite_batch(ecx_contextt *context, int n, ec_SoEbatcht *list, int timeout)
+{
+   return ecx_SoEbatch(context, n, list, timeout, TRUE);
+}
+
+/** Clear IDN map cache.
+ *
+ * @param[out] cache      = IDN map cache
+ */
+void ec_IDNcache_clear(ec_IDNcachet *cache)
+{
+   memset(cache, 0x00, sizeof(ec_IDNcachet));
+}
+
+/** Find mapping of a device type in IDN map cache.
+ *
+ * @param[in]  cache      = IDN map cache
+ * @param[in]  man        = manufacturer from EEprom
+ * @param[in]  id         = ID from EEprom
+ * @param[in]  rev        = revision from EEprom
+ * @return cache entry, NULL if not found
+ */
+const ec_IDNcacheentryt *ec_IDNcache_find(const ec_IDNcachet *cache, uint32 man, uint32 id, uint32 rev)
+{
+   int lp;
+
+   for (lp = 0; lp < cache->nentry; lp++)
+   {
+      if ((cache->entry[lp].eep_man == man) &&
+          (cache->entry[lp].eep_id == id) &&
+          (cache->entry[lp].eep_rev == rev))
+      {
+         return &cache->entry[lp];
+      }
+   }
+   return NULL;
+}
+
+/* Add entry to IDN map cache, replaces the oldest entry when full */
+static void ec_IDNcache_add(ec_IDNcachet *cache, const ec_IDNcacheentryt *entry)
+{
+   if (cache->nentry < EC_MAXIDNCACHE)
+   {
+      cache->entry[cache->nentry++] = *entry;
+   }
+   else
+   {
+      cache->entry[cache->next] = *entry;
+      cache->next = (cache->next + 1) % EC_MAXIDNCACHE;
+   }
+}
+
+/** Store IDN map cache in a compact image, f.e. to write it to a file.
+ * All values are little endian.
+ *
+ * @param[in]  cache      = IDN map cache
+ * @param[out] image      = image buffer
+ * @param[in]  size       = size of image buffer in bytes
+ * @return bytes used in image, 0 if buffer too small
+ */
+int ec_IDNcache_save(const ec_IDNcachet *cache, uint8 *image, int size)
+{
+   const ec_IDNcacheentryt *entry;
+   const ec_IDNmapt *map;
+   int pos, ok, lp, drive, i;
+
+   pos = 0;
+   ok = ec_image_put(image, size, &pos, 4, EC_IDNCMAGIC) &&
+        ec_image_put(image, size, &pos, 2, (uint32)cache->nentry);
+   for (lp = 0; ok && (lp < cache->nentry); lp++)
+   {
+      entry = &cache->entry[lp];
+      ok = ec_image_put(image, size, &pos, 4, entry->eep_man) &&
+           ec_image_put(image, size, &pos, 4, entry->eep_id) &&
+           ec_image_put(image, size, &pos, 4, entry->eep_rev);
+      for (drive = 0; ok && (drive < EC_SOE_MAX_DRIVES); drive++)
+      {
+         map = &entry->drive[drive];
+         ok = ec_image_put(image, size, &pos, 4, map->Osize) &&
+              ec_image_put(image, size, &pos, 4, map->Isize) &&
+              ec_image_put(image, size, &pos, 1, map->nmdt) &&
+              ec_image_put(image, size, &pos, 1, map->nat);
+         for (i = 0; ok && (i < map->nmdt); i++)
+         {
+            ok = ec_image_put(image, size, &pos, 2, map->mdt[i]);
+         }
+         for (i = 0; ok && (i < map->nat); i++)
+         {
+            ok = ec_image_put(image, size, &pos, 2, map->at[i]);
+         }
+      }
+   }
+
+   return ok ? pos : 0;
+}
+
+/** Load IDN map cache from an image made by ec_IDNcache_save().
+ *
+ * @param[out] cache      = IDN map cache
+ * @param[in]  image      = image buffer
+ * @param[in]  size       = size of image in bytes
+ * @return bytes used from image, 0 if image is invalid
+ */
+int ec_IDNcache_load(ec_IDNcachet *cache, const uint8 *image, int size)
+{
+   ec_IDNcacheentryt *entry;
+   ec_IDNmapt *map;
+   uint32 magic, nentry, val[4];
+   int pos, lp, drive, i;
+
+   pos = 0;
+   if (!ec_image_get(image, size, &pos, 4, &magic) || (magic != EC_IDNCMAGIC) ||
+       !ec_image_get(image, size, &pos, 2, &nentry) ||
+       (nentry > EC_MAXIDNCACHE))
+   {
+      return 0;
+   }
+   ec_IDNcache_clear(cache);
+   for (lp = 0; lp < (int)nentry; lp++)
+   {
+      entry = &cache->entry[lp];
+      if (!ec_image_get(image, size, &pos, 4, &entry->eep_man) ||
+          !ec_image_get(image, size, &pos, 4, &entry->eep_id) ||
+          !ec_image_get(image, size, &pos, 4, &entry->eep_rev))
+      {
+         ec_IDNcache_clear(cache);
+         return 0;
+      }
+      for (drive = 0; drive < EC_SOE_MAX_DRIVES; drive++)
+      {
+         map = &entry->drive[drive];
+         if (!ec_image_get(image, size, &pos, 4, &val[0]) ||
+             !ec_image_get(image, size, &pos, 4, &val[1]) ||
+             !ec_image_get(image, size, &pos, 1, &val[2]) ||
+             !ec_image_get(image, size, &pos, 1, &val[3]) ||
+             (val[2] > EC_SOE_MAXMAPPING) || (val[3] > EC_SOE_MAXMAPPING) ||
+             ((pos + (int)(val[2] + val[3]) * 2) > size))
+         {
+            ec_IDNcache_clear(cache);
+            return 0;
+         }
+         map->Osize = val[0];
+         map->Isize = val[1];
+         map->nmdt = (uint8)val[2];
+         map->nat = (uint8)val[3];
+         for (i = 0; i < map->nmdt; i++)
+         {
+            ec_image_get(image, size, &pos, 2, &val[0]);
+            map->mdt[i] = (uint16)val[0];
+         }
+         for (i = 0; i < map->nat; i++)
+         {
+            ec_image_get(image, size, &pos, 2, &val[0]);
+            map->at[i] = (uint16)val[0];
+         }
+      }
+   }
+   cache->nentry = (int)nentry;
+
+   return pos;
+}
+
+/* Read AT or MDT list of a drive and the attributes of the listed IDNs.
+ * Returns size in bits of the mapping, 0 if the list is not available.
+ */
+static uint32 ecx_readIDNlist(ecx_contextt *context, uint16 slave, uint8 driveNr, uint16 idn,
+                              uint16 *list, uint8 *n)
+{
+   int wkc;
+   int psize;
+   uint32 size;
+   uint16 entries, itemcount;
+   ec_SoEmappingt     SoEmapping;
+   ec_SoEattributet   SoEattribute;
+
+   size = 0;
+   *n = 0;
+   psize = sizeof(SoEmapping);
+   wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_VALUE_B, idn, &psize, &SoEmapping, EC_TIMEOUTRXM);
+   if ((wkc > 0) && (psize >= 4) && ((entries = etohs(SoEmapping.currentlength) / 2) > 0) && (entries <= EC_SOE_MAXMAPPING))
+   {
+      /* command / status word (uint16) is always mapped but not in list */
+      size += 16;
+      for (itemcount = 0 ; itemcount < entries ; itemcount++)
+      {
+         list[itemcount] = etohs(SoEmapping.idn[itemcount]);
+         psize = sizeof(SoEattribute);
+         /* read attribute of each IDN in mapping list */
+         wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_ATTRIBUTE_B, list[itemcount], &psize, &SoEattribute, EC_TIMEOUTRXM);
+         if ((wkc > 0) && (!SoEattribute.list))
+         {
+            /* length : 0 = 8bit, 1 = 16bit .... */
+            size += (int)8 << SoEattribute.length;
+         }
+      }
+      *n = (uint8)entries;
+   }
+   return size;
+}
+
 /** SoE read AT and MTD mapping.
  *
  * SoE has standard indexes defined for mapping. This function
  * tries to read them and collect a full input and output mapping size
- * of designated slave.
+ * of designated slave. With context->idncache set the mapping of a
+ * device type is read once and then taken from the cache.
  *
  * @param[in]  context = context struct
  * @param[in]  slave   = Slave number
@@ -312,54 +852,44 @@ int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 eleme
 int ecx_readIDNmap(ecx_contextt *context, uint16 slave, uint32 *Osize, uint32 *Isize)
 {
    int retVal = 0;
-   int   wkc;
-   int psize;
    uint8 driveNr;
-   uint16 entries, itemcount;
-   ec_SoEmappingt     SoEmapping;
-   ec_SoEattributet   SoEattribute;
+   ec_slavet *csl;
+   const ec_IDNcacheentryt *cached;
+   ec_IDNcacheentryt entry;
+   ec_IDNmapt *map;
 
    *Isize = 0;
    *Osize = 0;
-   for(driveNr = 0; driveNr < EC_SOE_MAX_DRIVES; driveNr++)
+   csl = &(context->slavelist[slave]);
+   cached = NULL;
+   if (context->idncache)
+   {
+      cached = ec_IDNcache_find(context->idncache, csl->eep_man, csl->eep_id, csl->eep_rev);
+   }
+   if (cached)
    {
-      psize = sizeof(SoEmapping);
-      /* read output mapping via SoE */
-      wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_VALUE_B, EC_IDN_MDTCONFIG, &psize, &SoEmapping, EC_TIMEOUTRXM);
-      if ((wkc > 0) && (psize >= 4) && ((entries = etohs(SoEmapping.currentlength) / 2) > 0) && (entries <= EC_SOE_MAXMAPPING))
+      context->idncache->hits++;
+      for (driveNr = 0; driveNr < EC_SOE_MAX_DRIVES; driveNr++)
       {
-         /* command word (uint16) is always mapped but not in list */
-         *Osize += 16;
-         for (itemcount = 0 ; itemcount < entries ; itemcount++)
-         {
-            psize = sizeof(SoEattribute);
-            /* read attribute of each IDN in mapping list */
-            wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_ATTRIBUTE_B, SoEmapping.idn[itemcount], &psize, &SoEattribute, EC_TIMEOUTRXM);
-            if ((wkc > 0) && (!SoEattribute.list))
-            {
-               /* length : 0 = 8bit, 1 = 16bit .... */
-               *Osize += (int)8 << SoEattribute.length;
-            }
-         }
+         *Osize += cached->drive[driveNr].Osize;
+         *Isize += cached->drive[driveNr].Isize;
       }
-      psize = sizeof(SoEmapping);
-      /* read input mapping via SoE */
-      wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_VALUE_B, EC_IDN_ATCONFIG, &psize, &SoEmapping, EC_TIMEOUTRXM);
-      if ((wkc > 0) && (psize >= 4) && ((entries = etohs(SoEmapping.currentlength) / 2) > 0) && (entries <= EC_SOE_MAXMAPPING))
+   }
+   else
+   {
+      memset(&entry, 0x00, sizeof(entry));
+      entry.eep_man = csl->eep_man;
+      entry.eep_id = csl->eep_id;
+      entry.eep_rev = csl->eep_rev;
+      for (driveNr = 0; driveNr < EC_SOE_MAX_DRIVES; driveNr++)
       {
-         /* status word (uint16) is always mapped but not in list */
-         *Isize += 16;
-         for (itemcount = 0 ; itemcount < entries ; itemcount++)
-         {
-            psize = sizeof(SoEattribute);
-            /* read attribute of each IDN in mapping list */
-            wkc = ecx_SoEread(context, slave, driveNr, EC_SOE_ATTRIBUTE_B, SoEmapping.idn[itemcount], &psize, &SoEattribute, EC_TIMEOUTRXM);
-            if ((wkc > 0) && (!SoEattribute.list))
-            {
-               /* length : 0 = 8bit, 1 = 16bit .... */
-               *Isize += (int)8 << SoEattribute.length;
-            }
-         }
+         map = &entry.drive[driveNr];
+         /* read output mapping via SoE */
+         map->Osize = ecx_readIDNlist(context, slave, driveNr, EC_IDN_MDTCONFIG, map->mdt, &map->nmdt);
+         /* read input mapping via SoE */
+         map->Isize = ecx_readIDNlist(context, slave, driveNr, EC_IDN_ATCONFIG, map->at, &map->nat);
+         *Osize += map->Osize;
+         *Isize += map->Isize;
       }
    }
 
@@ -367,6 +897,11 @@ int ecx_readIDNmap(ecx_contextt *context, uint16 slave, uint32 *Osize, uint32 *I
    if ((*Isize > 0) || (*Osize > 0))
    {
       retVal = 1;
+      if (context->idncache && !cached)
+      {
+         context->idncache->misses++;
+         ec_IDNcache_add(context->idncache, &entry);
+      }
    }
    return retVal;
 }
@@ -386,4 +921,14 @@ int ec_readIDNmap(uint16 slave, uint32 *Osize, uint32 *Isize)
 {
    return ecx_readIDNmap(&ecx_context, slave, Osize, Isize);
 }
+
+int ec_SoEread_batch(int n, ec_SoEbatcht *list, int timeout)
+{
+   return ecx_SoEread_batch(&ecx_context, n, list, timeout);
+}
+
+int ec_SoEwrite_batch(int n, ec_SoEbatcht *list, int timeout)
+{
+   return ecx_SoEwrite_batch(&ecx_context, n, list, timeout);
+}
 #endif
@@ -31,6 +31,12 @@ extern "C"
 #define EC_IDN_MDTCONFIG     24
 #define EC_IDN_ATCONFIG      16
 
+#define EC_SOE_MAX_DRIVES     8
+/** max. device types in IDN map cache */
+#define EC_MAXIDNCACHE       16
+/** magic of IDN map cache image, "IDN1" */
+#define EC_IDNCMAGIC         0x314e4449
+
 /** SoE name structure */
 PACKED_BEGIN
 typedef struct PACKED
@@ -113,15 +119,114 @@ typedef struct PACKED
 } ec_SoEattributet;
 PACKED_END
 
+typedef struct ec_SoEbatch ec_SoEbatcht;
+
+/** Entry of a SoE batch, see ecx_SoEread_batch() and ecx_SoEwrite_batch() */
+struct ec_SoEbatch
+{
+   /** slave number */
+   uint16          slave;
+   /** drive number in slave */
+   uint8           driveNo;
+   /** flags to select what properties of IDN are transferred */
+   uint8           elementflags;
+   /** IDN */
+   uint16          idn;
+   /** size in bytes of data buffer, on read returns size of data read */
+   int             size;
+   /** data buffer */
+   void            *data;
+   /** result, workcounter >0 is success, 0 = SoE error or unexpected
+    * response, EC_TIMEOUT or EC_ERROR on mailbox failure */
+   int             wkc;
+   /** SoE error code, 0 if no error */
+   uint16          errorcode;
+   /** internal, entry is not finished */
+   boolean         busy;
+   /** internal, TRUE for SoE write */
+   boolean         write;
+   /** internal, bytes transferred */
+   int             done;
+   /** internal, timeout per mailbox transaction in us */
+   int             timeout;
+   /** internal, next entry of the same slave */
+   ec_SoEbatcht    *next;
+   /** internal, mailbox transaction */
+   ec_mbxtranst    trans;
+   /** internal, request */
+   ec_mbxbuft      txmbx;
+   /** internal, response */
+   ec_mbxbuft      rxmbx;
+};
+
+/** AT and MDT mapping of one drive */
+typedef struct
+{
+   /** number of IDNs in MDT list (S-0-0024) */
+   uint8           nmdt;
+   /** number of IDNs in AT list (S-0-0016) */
+   uint8           nat;
+   /** MDT IDNs */
+   uint16          mdt[EC_SOE_MAXMAPPING];
+   /** AT IDNs */
+   uint16          at[EC_SOE_MAXMAPPING];
+   /** size in bits of output mapping, including control word */
+   uint32          Osize;
+   /** size in bits of input mapping, including status word */
+   uint32          Isize;
+} ec_IDNmapt;
+
+/** AT and MDT mapping of one device type, identified by vendor, product
+ * and revision.
+ */
+typedef struct
+{
+   /** manufacturer from EEprom */
+   uint32          eep_man;
+   /** ID from EEprom */
+   uint32          eep_id;
+   /** revision from EEprom */
+   uint32          eep_rev;
+   /** mapping per drive */
+   ec_IDNmapt      drive[EC_SOE_MAX_DRIVES];
+} ec_IDNcacheentryt;
+
+/** Cache of SoE mappings. Assign to context->idncache to let
+ * ecx_readIDNmap() read each device type only once. Keep it between
+ * configurations or store it with ec_IDNcache_save(). Filling is not
+ * thread safe, with EC_MAX_MAPT > 1 load the cache before configuration.
+ */
+struct ec_IDNcache
+{
+   /** number of used entries */
+   int                nentry;
+   /** mappings taken from cache */
+   uint32             hits;
+   /** mappings read from slaves */
+   uint32             misses;
+   /** internal, entry to replace when cache is full */
+   int                next;
+   /** entries */
+   ec_IDNcacheentryt  entry[EC_MAXIDNCACHE];
+};
+
 #ifdef EC_VER1
 int ec_SoEread(uint16 slave, uint8 driveNo, uint8 elementflags, uint16 idn, int *psize, void *p, int timeout);
 int ec_SoEwrite(uint16 slave, uint8 driveNo, uint8 elementflags, uint16 idn, int psize, void *p, int timeout);
 int ec_readIDNmap(uint16 slave, uint32 *Osize, uint32 *Isize);
+int ec_SoEread_batch(int n, ec_SoEbatcht *list, int timeout);
+int ec_SoEwrite_batch(int n, ec_SoEbatcht *list, int timeout);
 #endif
 
 int ecx_SoEread(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elementflags, uint16 idn, int *psize, void *p, int timeout);
 int ecx_SoEwrite(ecx_contextt *context, uint16 slave, uint8 driveNo, uint8 elementflags, uint16 idn, int psize, void *p, int timeout);
 int ecx_readIDNmap(ecx_contextt *context, uint16 slave, uint32 *Osize, uint32 *Isize);
+int ecx_SoEread_batch(ecx_contextt *context, int n, ec_SoEbatcht *list, int timeout);
+int ecx_SoEwrite_batch(ecx_contextt *context, int n, ec_SoEbatcht *list, int timeout);
+void ec_IDNcache_clear(ec_IDNcachet *cache);
+const ec_IDNcacheentryt *ec_IDNcache_find(const ec_IDNcachet *cache, uint32 man, uint32 id, uint32 rev);
+int ec_IDNcache_save(const ec_IDNcachet *cache, uint8 *image, int size);
+int ec_IDNcache_load(ec_IDNcachet *cache, const uint8 *image, int size);
 
 #ifdef __cplusplus
 }
@@ -47,8 +47,12 @@ extern "C"
 #define EC_SLAVECOUNTEXCEEDED -4
 /** return value request timeout */
 #define EC_TIMEOUT            -5
+/** return value write sent but frame lost, write may have been executed */
+#define EC_UNCERTAIN          -6
 /** maximum EtherCAT frame length in bytes */
 #define EC_MAXECATFRAME    1518
+/** maximum Ethernet frame length without FCS */
+#define EC_MAXFRAMELENGTH  (EC_MAXECATFRAME - 4)
 /** maximum EtherCAT LRW frame length in bytes */
 /* MTU - Ethernet header - length - datagram header - WCK - FCS */
 #define EC_MAXLRWDATA      (EC_MAXECATFRAME - 14 - 2 - 10 - 2 - 4)
@@ -471,7 +475,9 @@ typedef enum
    EC_ERR_TYPE_SOE_ERROR            = 8,
    EC_ERR_TYPE_MBX_ERROR            = 9,
    EC_ERR_TYPE_FOE_FILE_NOTFOUND    = 10,
-   EC_ERR_TYPE_EOE_INVALID_RX_DATA  = 11
+   EC_ERR_TYPE_EOE_INVALID_RX_DATA  = 11,
+   EC_ERR_TYPE_AOE_ERROR            = 12,
+   EC_ERR_TYPE_DC_ALARM             = 13
 } ec_err_type;
 
 /** Struct to retrieve errors. */
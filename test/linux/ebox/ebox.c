@@ -68,6 +68,7 @@ int dorun = 0;
 int deltat, tmax=0;
 int64 toff;
 int DCdiff;
+ec_dcmonitort dcmon;
 int os;
 uint32 ob;
 int16 ob2;
@@ -138,6 +139,8 @@ void eboxtest(char *ifname)
 
          /* configure DC options for every DC capable slave found in the list */
          printf("DC capable : %d\n",ec_configdc());
+         /* sample DC difference of up to 4 slaves per cycle, alarm above 1us */
+         ec_dcmonitor_init(&dcmon, 4 * EC_DCMONSAMPLESIZE, 1000, 0);
 
          /* check configuration */
          if (( ec_slavecount >= 1 ) &&
@@ -181,11 +184,10 @@ void eboxtest(char *ifname)
                /* acyclic loop 20ms */
                for(i = 1; i <= 200; i++)
                {
-                  /* read DC difference register for slave 2 */
-   //               ec_FPRD(ec_slave[1].configadr, ECT_REG_DCSYSDIFF, sizeof(DCdiff), &DCdiff, EC_TIMEOUTRET);
-   //               if(DCdiff<0) { DCdiff = - (int32)((uint32)DCdiff & 0x7ffffff); }
-                  printf("PD cycle %5d DCtime %12lld Cnt:%3d Data: %6d %6d %6d %6d %6d %6d %6d %6d \n",
-                        cyclecount, ec_DCtime, in_EBOX->counter, in_EBOX->stream[0], in_EBOX->stream[1],
+                  /* DC difference of slave 1 sampled by the DC monitor */
+                  DCdiff = dcmon.slave[1].deviation;
+                  printf("PD cycle %5d DCtime %12lld DCdiff %5d Cnt:%3d Data: %6d %6d %6d %6d %6d %6d %6d %6d \n",
+                        cyclecount, ec_DCtime, DCdiff, in_EBOX->counter, in_EBOX->stream[0], in_EBOX->stream[1],
                          in_EBOX->stream[2], in_EBOX->stream[3], in_EBOX->stream[4], in_EBOX->stream[5],
                          in_EBOX->stream[98], in_EBOX->stream[99]);
                   usleep(20000);
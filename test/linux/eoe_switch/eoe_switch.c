@@ -0,0 +1,135 @@
+/** \file
+ * \brief Example code for Simple Open EtherCAT master EoE switch
+ *
+ * Bridges EoE port 0 of every EoE slave to a TAP device of the host,
+ * tap0 for the first EoE slave, tap1 for the next and so on. The frames
+ * are carried by the asynchronous mailbox engine while the processdata
+ * runs cyclically. Configure the TAP devices like any other network
+ * interface, f.e. "ip addr add 192.168.9.1/24 dev tap0", and set the IP
+ * of the slave with ecx_EOEsetIp().
+ *
+ * Usage : eoe_switch [ifname1] [seconds]
+ * ifname is NIC interface, f.e. eth0
+ * seconds is the run time, default 60
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ethercat.h"
+#include "oshw.h"
+
+char IOmap[4096];
+ec_EOEswitcht eoeswitch;
+
+void eoeswitch_run(char *ifname, int seconds)
+{
+   int i, cycles;
+   int fd;
+   char tapname[16];
+   ec_EOEportt *eport;
+
+   printf("Starting EoE switch\n");
+
+   /* initialise SOEM, bind socket to ifname */
+   if (ec_init(ifname))
+   {
+      printf("ec_init on %s succeeded.\n", ifname);
+      if (ec_config_init(FALSE) > 0)
+      {
+         printf("%d slaves found and configured.\n", ec_slavecount);
+         ec_config_map(&IOmap);
+         ec_statecheck(0, EC_STATE_SAFE_OP, EC_TIMEOUTSTATE * 4);
+
+         ecx_EOEswitch_init(&eoeswitch, oshw_tap_hostread, oshw_tap_hostwrite, EC_TIMEOUTTXM);
+         for (i = 1; i <= ec_slavecount; i++)
+         {
+            if (!(ec_slave[i].mbx_proto & ECT_MBXPROT_EOE))
+            {
+               continue;
+            }
+            snprintf(tapname, sizeof(tapname), "tap%d", eoeswitch.nport);
+            fd = oshw_tap_open(tapname);
+            if (fd < 0)
+            {
+               printf("Slave %d: cannot open %s, needs CAP_NET_ADMIN\n", i, tapname);
+               continue;
+            }
+            eport = ecx_EOEswitch_add(&ecx_context, &eoeswitch, i, 0, fd);
+            if (!eport)
+            {
+               oshw_tap_close(fd);
+               continue;
+            }
+            printf("Slave %d %s bridged to %s\n", i, ec_slave[i].name, tapname);
+         }
+
+         if (eoeswitch.nport)
+         {
+            ec_slave[0].state = EC_STATE_OPERATIONAL;
+            ec_send_processdata();
+            ec_receive_processdata(EC_TIMEOUTRET);
+            ec_writestate(0);
+            /* processdata and EoE switch run in the same 1 ms cycle */
+            cycles = seconds * 1000;
+            for (i = 0; i < cycles; i++)
+            {
+               ec_send_processdata();
+               ec_receive_processdata(EC_TIMEOUTRET);
+               ecx_EOEswitch_poll(&ecx_context, &eoeswitch);
+               osal_usleep(1000);
+            }
+            for (i = 0; i < eoeswitch.nport; i++)
+            {
+               eport = &eoeswitch.port[i];
+               printf("Slave %d tx %u frames %u bytes %u drops, rx %u frames %u bytes %u errors\n",
+                  eport->slave, eport->txframes, eport->txbytes, eport->txdrops,
+                  eport->rxframes, eport->rxbytes, eport->rxerrors);
+               printf("          latency tx avg %u max %u us, rx avg %u max %u us\n",
+                  eport->txlatency, eport->txlatencymax, eport->rxlatency, eport->rxlatencymax);
+               printf("          rate tx %u rx %u bytes/s\n", eport->txrate, eport->rxrate);
+               oshw_tap_close(eport->hosthandle);
+            }
+         }
+         else
+         {
+            printf("No EoE slaves bridged.\n");
+         }
+         if (eoeswitch.other)
+         {
+            printf("%u other mailbox messages read by the switch\n", eoeswitch.other);
+         }
+         printf("Request init state for all slaves\n");
+         ec_slave[0].state = EC_STATE_INIT;
+         ec_writestate(0);
+      }
+      else
+      {
+         printf("No slaves found!\n");
+      }
+      printf("End EoE switch, close socket\n");
+      ec_close();
+   }
+   else
+   {
+      printf("No socket connection on %s\nExecute as root\n", ifname);
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   printf("SOEM (Simple Open EtherCAT Master)\nEoE switch\n");
+
+   if (argc > 1)
+   {
+      eoeswitch_run(argv[1], (argc > 2) ? atoi(argv[2]) : 60);
+   }
+   else
+   {
+      printf("Usage: eoe_switch ifname1 [seconds]\nifname = eth0 for example\n");
+   }
+
+   printf("End program\n");
+   return (0);
+}
@@ -39,43 +39,31 @@ OSAL_THREAD_HANDLE thread1;
 OSAL_THREAD_HANDLE thread2;
 uint8 txbuf[1024];
 
-/** Current RX fragment number */
-uint8_t rxfragmentno = 0;
-/** Complete RX frame size of current frame */
-uint16_t rxframesize = 0;
-/** Current RX data offset in frame */
-uint16_t rxframeoffset = 0;
-/** Current RX frame number */
-uint16_t rxframeno = 0;
-uint8 rxbuf[1024];
-int size_of_rx = sizeof(rxbuf);
+/** RX reassembly of slave 1 port 0 */
+ec_EOErxt eoerx;
 
 /** registered EoE hook */
 int eoe_hook(ecx_contextt * context, uint16 slave, void * eoembx)
 {
    int wkc;
-   /* Pass received Mbx data to EoE recevive fragment function that
-   * that will start/continue fill an Ethernet frame buffer
+   int size_of_rx;
+   uint8 *rxbuf;
+   ec_EOErxframet *frame;
+   /* Pass received Mbx data to EoE reassembly that will start/continue
+   * fill an Ethernet frame buffer of the pool
    */
-   size_of_rx = sizeof(rxbuf);
-   wkc = ecx_EOEreadfragment(eoembx,
-      &rxfragmentno,
-      &rxframesize,
-      &rxframeoffset,
-      &rxframeno,
-      &size_of_rx,
-      rxbuf);
-
-   printf("Read frameno %d, fragmentno %d\n", rxframeno, rxfragmentno);
+   wkc = ecx_EOErx_fragment(&eoerx, eoembx, &frame);
 
    /* wkc == 1 would mean a frame is complete , last fragment flag have been set and all
    * other checks must have past
    */
    if (wkc > 0)
    {
+      rxbuf = frame->data;
+      size_of_rx = frame->size;
       ec_etherheadert *bp = (ec_etherheadert *)rxbuf;
       uint16 type = ntohs(bp->etype);
-      printf("Frameno %d, type 0x%x complete\n", rxframeno, type);
+      printf("Frameno %d, type 0x%x complete\n", frame->frameno, type);
       if (type == ETH_P_ECAT)
       {
          /* Sanity check that received buffer still is OK */
@@ -109,6 +97,7 @@ int eoe_hook(ecx_contextt * context, uint16 slave, void * eoembx)
       {
          printf("Skip type 0x%x\n", type);
       }
+      ecx_EOErx_release(&eoerx, frame);
    }
    /* No point in returning as unhandled */
    return 1;
@@ -148,6 +137,7 @@ OSAL_THREAD_FUNC mailbox_reader(void *lpParam)
 void test_eoe(ecx_contextt * context)
 {
    /* Set the HOOK */
+   ecx_EOErx_init(&eoerx, 1, 0);
    ecx_EOEdefinehook(context, eoe_hook);
 
    eoe_param_t ipsettings, re_ipsettings;
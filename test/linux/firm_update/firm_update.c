@@ -16,37 +16,60 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 
 #include "ethercat.h"
 
-#define FWBUFSIZE (8 * 1024 * 1024)
-
 uint8 ob;
 uint16 ow;
 uint32 data;
 char filename[256];
-char filebuffer[FWBUFSIZE]; // 8MB buffer
+uint8 *filemap;
 int filesize;
+int filepos;
 int j;
 uint16 argslave;
+ec_FOEstreamt foestream;
 
+/* map file in memory, segments are copied from the map while they are sent */
 int input_bin(char *fname, int *length)
 {
-    FILE *fp;
-
-	int cc = 0, c;
+	struct stat st;
+	int fd;
 
-    fp = fopen(fname, "rb");
-    if(fp == NULL)
-        return 0;
-	while (((c = fgetc(fp)) != EOF) && (cc < FWBUFSIZE))
-		filebuffer[cc++] = (uint8)c;
-	*length = cc;
-	fclose(fp);
+	fd = open(fname, O_RDONLY);
+	if (fd < 0)
+		return 0;
+	if ((fstat(fd, &st) < 0) || (st.st_size == 0))
+	{
+		close(fd);
+		return 0;
+	}
+	filemap = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (filemap == MAP_FAILED)
+		return 0;
+	*length = (int)st.st_size;
+	filepos = 0;
 	return 1;
 }
 
+/* FoE stream callback, fill next segment from the file map */
+int foe_chunk(ecx_contextt *context, uint16 slave, ec_FOEstreamt *stream, uint8 *data, int length)
+{
+	(void)context;
+	(void)slave;
+	(void)stream;
+	if (length > filesize - filepos)
+		length = filesize - filepos;
+	memcpy(data, filemap + filepos, length);
+	filepos += length;
+	return length;
+}
+
 
 void boottest(char *ifname, uint16 slave, char *filename)
 {
@@ -74,32 +97,15 @@ void boottest(char *ifname, uint16 slave, char *filename)
 			ec_statecheck(slave, EC_STATE_INIT,  EC_TIMEOUTSTATE * 4);
 			printf("Slave %d state to INIT.\n", slave);
 
-			/* read BOOT mailbox data, master -> slave */
-			data = ec_readeeprom(slave, ECT_SII_BOOTRXMBX, EC_TIMEOUTEEP);
-			ec_slave[slave].SM[0].StartAddr = (uint16)LO_WORD(data);
-            		ec_slave[slave].SM[0].SMlength = (uint16)HI_WORD(data);
-			/* store boot write mailbox address */
-			ec_slave[slave].mbx_wo = (uint16)LO_WORD(data);
-			/* store boot write mailbox size */
-			ec_slave[slave].mbx_l = (uint16)HI_WORD(data);
-
-			/* read BOOT mailbox data, slave -> master */
-			data = ec_readeeprom(slave, ECT_SII_BOOTTXMBX, EC_TIMEOUTEEP);
-			ec_slave[slave].SM[1].StartAddr = (uint16)LO_WORD(data);
-                        ec_slave[slave].SM[1].SMlength = (uint16)HI_WORD(data);
-			/* store boot read mailbox address */
-			ec_slave[slave].mbx_ro = (uint16)LO_WORD(data);
-			/* store boot read mailbox size */
-			ec_slave[slave].mbx_rl = (uint16)HI_WORD(data);
-
+			/* switch to BOOT mailbox, FoE uses its size for the segments */
+			if (!ec_config_bootmbx(slave, TRUE))
+			{
+				printf("Slave %d boot mailbox not usable, EC_MAXMBX %d.\n", slave, EC_MAXMBX);
+			}
 			printf(" SM0 A:%4.4x L:%4d F:%8.8x\n", ec_slave[slave].SM[0].StartAddr, ec_slave[slave].SM[0].SMlength,
 			    (int)ec_slave[slave].SM[0].SMflags);
 			printf(" SM1 A:%4.4x L:%4d F:%8.8x\n", ec_slave[slave].SM[1].StartAddr, ec_slave[slave].SM[1].SMlength,
 			    (int)ec_slave[slave].SM[1].SMflags);
-			/* program SM0 mailbox in for slave */
-			ec_FPWR (ec_slave[slave].configadr, ECT_REG_SM0, sizeof(ec_smt), &ec_slave[slave].SM[0], EC_TIMEOUTRET);
-			/* program SM1 mailbox out for slave */
-			ec_FPWR (ec_slave[slave].configadr, ECT_REG_SM1, sizeof(ec_smt), &ec_slave[slave].SM[1], EC_TIMEOUTRET);
 
 			printf("Request BOOT state for slave %d\n", slave);
 			ec_slave[slave].state = EC_STATE_BOOT;
@@ -114,11 +120,16 @@ void boottest(char *ifname, uint16 slave, char *filename)
 				{
 					printf("File read OK, %d bytes.\n",filesize);
 					printf("FoE write....");
-					j = ec_FOEwrite(slave, filename, 0, filesize , &filebuffer, EC_TIMEOUTSTATE);
+					foestream.chunk = foe_chunk;
+					foestream.size = filesize;
+					j = ec_FOEwrite_stream(slave, filename, 0, &foestream, EC_TIMEOUTSTATE);
 					printf("result %d.\n",j);
+					munmap(filemap, filesize);
 					printf("Request init state for slave %d\n", slave);
 					ec_slave[slave].state = EC_STATE_INIT;
 					ec_writestate(slave);
+					ec_statecheck(slave, EC_STATE_INIT,  EC_TIMEOUTSTATE * 4);
+					ec_config_bootmbx(slave, FALSE);
 				}
 				else
 				    printf("File not read OK.\n");
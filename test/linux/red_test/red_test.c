@@ -33,7 +33,7 @@ pthread_t thread1, thread2;
 struct timeval tv, t1, t2;
 int dorun = 0;
 int deltat, tmax = 0;
-int64 toff, gl_delta;
+int64 gl_delta;
 int DCdiff;
 int os;
 uint8 ob;
@@ -157,60 +157,29 @@ void redtest(char *ifname, char *ifname2)
    }
 }
 
-/* add ns to timespec */
-void add_timespec(struct timespec *ts, int64 addtime)
-{
-   int64 sec, nsec;
-
-   nsec = addtime % NSEC_PER_SEC;
-   sec = (addtime - nsec) / NSEC_PER_SEC;
-   ts->tv_sec += sec;
-   ts->tv_nsec += nsec;
-   if ( ts->tv_nsec >= NSEC_PER_SEC )
-   {
-      nsec = ts->tv_nsec % NSEC_PER_SEC;
-      ts->tv_sec += (ts->tv_nsec - nsec) / NSEC_PER_SEC;
-      ts->tv_nsec = nsec;
-   }
-}
-
-/* PI calculation to get linux time synced to DC time */
-void ec_sync(int64 reftime, int64 cycletime , int64 *offsettime)
-{
-   static int64 integral = 0;
-   int64 delta;
-   /* set linux sync point 50us later than DC sync, just as example */
-   delta = (reftime - 50000) % cycletime;
-   if(delta> (cycletime / 2)) { delta= delta - cycletime; }
-   if(delta>0){ integral++; }
-   if(delta<0){ integral--; }
-   *offsettime = -(delta / 100) - (integral / 20);
-   gl_delta = delta;
-}
-
 /* RT EtherCAT thread */
 OSAL_THREAD_FUNC_RT ecatthread(void *ptr)
 {
    struct timespec   ts, tleft;
    int ht;
-   int64 cycletime;
+   int64 cycletime, wakeup, sendtime;
+   ec_dcsynct dcsync;
 
    clock_gettime(CLOCK_MONOTONIC, &ts);
    ht = (ts.tv_nsec / 1000000) + 1; /* round to nearest ms */
-   ts.tv_nsec = ht * 1000000;
-   if (ts.tv_nsec >= NSEC_PER_SEC) {
-      ts.tv_sec++;
-      ts.tv_nsec -= NSEC_PER_SEC;
-   }
+   wakeup = (int64)ts.tv_sec * NSEC_PER_SEC + (int64)ht * 1000000;
    cycletime = *(int*)ptr * 1000; /* cycletime in ns */
-   toff = 0;
+   /* frame at reference clock 50us later than DC sync, just as example */
+   ec_dcsync_init(&dcsync, cycletime, 50000, wakeup);
    dorun = 0;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   sendtime = (int64)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
    ec_send_processdata();
    while(1)
    {
-      /* calculate next cycle start */
-      add_timespec(&ts, cycletime + toff);
       /* wait to cycle start */
+      ts.tv_sec = wakeup / NSEC_PER_SEC;
+      ts.tv_nsec = wakeup % NSEC_PER_SEC;
       clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, &tleft);
       if (dorun>0)
       {
@@ -219,12 +188,14 @@ OSAL_THREAD_FUNC_RT ecatthread(void *ptr)
          dorun++;
          /* if we have some digital output, cycle */
          if( digout ) *digout = (uint8) ((dorun / 16) & 0xff);
-
-         if (ec_slave[0].hasdc)
-         {
-            /* calulate toff to get linux time and DC synced */
-            ec_sync(ec_DCtime, cycletime, &toff);
-         }
+      }
+      /* calculate next cycle start to get linux time and DC synced */
+      wakeup = ec_dcsync_cycle(&dcsync, sendtime);
+      gl_delta = dcsync.offset;
+      if (dorun>0)
+      {
+         clock_gettime(CLOCK_MONOTONIC, &ts);
+         sendtime = (int64)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
          ec_send_processdata();
       }
    }